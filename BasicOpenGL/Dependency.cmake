@@ -76,7 +76,10 @@ ExternalProject_Add(
     TEST_COMMAND ""
     INSTALL_COMMAND ${CMAKE_COMMAND} -E copy
         ${PROJECT_BINARY_DIR}/dep_stb-prefix/src/dep_stb/stb_image.h
-        ${DEP_INSTALL_DIR}/include/stb/stb_image.h)
+        ${DEP_INSTALL_DIR}/include/stb/stb_image.h
+    COMMAND ${CMAKE_COMMAND} -E copy
+        ${PROJECT_BINARY_DIR}/dep_stb-prefix/src/dep_stb/stb_image_write.h
+        ${DEP_INSTALL_DIR}/include/stb/stb_image_write.h)
 set(DEP_LIST ${DEP_LIST} dep_stb)
 
 # assimp
@@ -99,4 +102,23 @@ set(DEP_LIST ${DEP_LIST} dep_assimp)
 set(DEP_LIBS ${DEP_LIBS}
     assimp-vc142-mt$<$<CONFIG:Debug>:d>
     zlibstatic$<$<CONFIG:Debug>:d>
-    IrrXML$<$<CONFIG:Debug>:d>)
\ No newline at end of file
+    IrrXML$<$<CONFIG:Debug>:d>)
+
+# lz4 (optional): compressed asset pack entries
+if(ENGINE_LZ4)
+ExternalProject_Add(
+    dep_lz4
+    GIT_REPOSITORY "https://github.com/lz4/lz4"
+    GIT_TAG "v1.9.4"
+    GIT_SHALLOW 1
+    SOURCE_SUBDIR build/cmake
+    UPDATE_COMMAND "" PATCH_COMMAND "" TEST_COMMAND ""
+    CMAKE_ARGS
+        -DCMAKE_INSTALL_PREFIX=${DEP_INSTALL_DIR}
+        -DBUILD_SHARED_LIBS=OFF
+        -DBUILD_STATIC_LIBS=ON
+        -DLZ4_BUILD_CLI=OFF
+        -DLZ4_BUILD_LEGACY_LZ4C=OFF)
+set(DEP_LIST ${DEP_LIST} dep_lz4)
+set(DEP_LIBS ${DEP_LIBS} $<IF:$<CXX_COMPILER_ID:MSVC>,lz4_static,lz4>)
+endif()
@@ -0,0 +1,198 @@
+#ifndef _ANIMATION_
+#define _ANIMATION_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// glm
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// include
+#include <Log.hpp>
+#include <JobSystem.hpp>
+#include <Simd.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ==== pose ====
+//
+// local transforms of every skeleton node in structure-of-arrays layout:
+// one stream per component, each padded to a multiple of 4 nodes so SSE can process 4 nodes at a time
+
+struct Pose
+{
+    enum STREAM
+    {
+        TX, TY, TZ,     // translation
+        QX, QY, QZ, QW, // rotation
+        SX, SY, SZ,     // scale
+        NUM_STREAMS
+    };
+
+    size_t numNodes;
+    size_t stride; // numNodes rounded up to 4
+    std::vector<float> data;
+
+    Pose() : numNodes(0), stride(0) {};
+    void resize(size_t);
+    float* stream(int s) { return &data[s * stride]; };
+    const float* stream(int s) const { return &data[s * stride]; };
+
+    static void blend(const Pose&, const Pose&, float, Pose&);
+    void normalizeRotations();
+};
+
+// ==== skeleton class ====
+//
+// nodes in depth-first preorder (a parent always comes before its children) with their bind pose,
+// and the bones: nodes that deform vertices, with their offset (inverse bind) matrices
+
+class Skeleton
+{
+    private:
+    std::vector<std::string> m_nodeNames;
+    std::vector<int> m_parents; // -1 for the root
+    Pose m_bindPose;
+    std::vector<int> m_boneNodes;
+    std::vector<glm::mat4> m_boneOffsets;
+    std::unordered_map<std::string, int> m_nodeIndices, m_boneIndices;
+    glm::mat4 m_globalInverse;
+    inline void nullify();
+
+    public:
+    Skeleton() { nullify(); };
+
+    public:
+    size_t getNumNodes() const { return m_parents.size(); };
+    size_t getNumBones() const { return m_boneNodes.size(); };
+    const Pose& getBindPose() const { return m_bindPose; };
+    int findNode(const std::string&) const;
+    int findBone(const std::string&) const;
+
+    void clear() { nullify(); };
+    int addNode(const std::string&, int, const glm::vec3&, const glm::quat&, const glm::vec3&);
+    int addBone(const std::string&, const glm::mat4&);
+    void setGlobalInverse(const glm::mat4& globalInverse) { m_globalInverse = globalInverse; };
+    void computePalette(const Pose&, std::vector<glm::mat4>&, std::vector<glm::mat4>&) const;
+};
+
+// ==== animation clip class ====
+//
+// keyframes resampled at a fixed rate when imported, so every node has a key on every frame:
+// sampling needs no per-channel key search and interpolates all nodes of two frames with SSE
+// frame f is a Pose-layout block (NUM_STREAMS * stride floats) at m_frames[f * NUM_STREAMS * stride]
+
+class AnimationClip
+{
+    private:
+    std::string m_name;
+    float m_duration;   // seconds
+    float m_sampleRate; // frames per second
+    size_t m_numFrames;
+    size_t m_numNodes, m_stride;
+    std::vector<float> m_frames;
+    inline void nullify();
+
+    public:
+    AnimationClip() { nullify(); };
+
+    public:
+    const std::string& getName() const { return m_name; };
+    float getDuration() const { return m_duration; };
+    size_t getNumFrames() const { return m_numFrames; };
+
+    void init(const std::string&, float, float, const Skeleton&);
+    void setKey(size_t, int, const glm::vec3&, const glm::quat&, const glm::vec3&);
+    void finalize();
+    void sample(float, bool, Pose&) const;
+};
+
+// ==== animator class ====
+//
+// per-character state: up to two clips blended by weight, and the resulting matrix palette
+
+class Animator
+{
+    private:
+    const Skeleton* m_skeleton;
+    const AnimationClip* m_clips[2];
+    float m_times[2];
+    float m_blend; // 0: clip 0 only, 1: clip 1 only
+    Pose m_poses[2], m_pose;
+    std::vector<glm::mat4> m_globals, m_palette;
+    inline void nullify();
+
+    public:
+    Animator() { nullify(); };
+    Animator(const Skeleton&);
+
+    public:
+    const std::vector<glm::mat4>& getPalette() const { return m_palette; };
+    void setSkeleton(const Skeleton&);
+    void play(int, const AnimationClip*, float = 0.0f);
+    void setBlend(float blend) { m_blend = blend; };
+    void update(float);
+};
+
+// ==== animation system class ====
+//
+// evaluates many animators in parallel on the JobSystem
+
+class AnimationSystem
+{
+    public:
+    struct Stats
+    {
+        size_t numCharacters;
+        double ms;
+    };
+
+    public:
+    static Stats update(std::vector<Animator*>&, float);
+    static void benchmark(const Skeleton&, const AnimationClip&, size_t, int);
+};
+
+// ---- skeleton ----
+
+inline void Skeleton::nullify()
+{
+    std::vector<std::string>().swap(m_nodeNames);
+    std::vector<int>().swap(m_parents);
+    m_bindPose = Pose();
+    std::vector<int>().swap(m_boneNodes);
+    std::vector<glm::mat4>().swap(m_boneOffsets);
+    std::unordered_map<std::string, int>().swap(m_nodeIndices);
+    std::unordered_map<std::string, int>().swap(m_boneIndices);
+    m_globalInverse = glm::mat4(1.0f);
+}
+
+// ---- animation clip ----
+
+inline void AnimationClip::nullify()
+{
+    m_name = "";
+    m_duration = 0.0f;
+    m_sampleRate = 30.0f;
+    m_numFrames = 0;
+    m_numNodes = m_stride = 0;
+    std::vector<float>().swap(m_frames);
+}
+
+// ---- animator ----
+
+inline void Animator::nullify()
+{
+    m_skeleton = nullptr;
+    m_clips[0] = m_clips[1] = nullptr;
+    m_times[0] = m_times[1] = 0.0f;
+    m_blend = 0.0f;
+}
+
+#endif
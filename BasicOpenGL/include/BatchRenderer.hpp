@@ -0,0 +1,100 @@
+#ifndef _BATCH_RENDERER_
+#define _BATCH_RENDERER_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// opengl
+#include <glad/glad.h>
+
+// include
+#include <Log.hpp>
+#include <GLState.hpp>
+#include <JobSystem.hpp>
+
+// std
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ==== batch renderer class ====
+//
+// renders images into an offscreen FBO and writes them as PNG files, without stalling on readback:
+// 1. endImage() starts an asynchronous glReadPixels() into the next PBO of a ring and puts a fence after it
+// 2. a PBO is mapped only once its fence has signaled, normally several images later
+//    (only a full ring waits for the oldest fence: counted as a stall)
+// 3. the mapped pixels are copied out and encoded to PNG on a JobSystem worker
+//
+// GL thread only (except the encoding, which never touches GL)
+// e.g.)
+// BatchRenderer batch;
+// batch.init(512, 512);
+// for(...) { batch.beginImage(); ... draw ...; batch.endImage("out/0001.png"); }
+// batch.finish(); // waits for the last readbacks and PNG files
+
+class BatchRenderer
+{
+    public:
+    struct Stats
+    {
+        size_t numImages;
+        size_t numStalls;  // endImage() had to wait for the oldest readback
+        double waitMs;     // time spent in those waits
+        double seconds;    // init() to finish()
+        double imagesPerSecond;
+    };
+
+    private:
+    struct Slot
+    {
+        GLuint PBO;
+        GLsync fence;
+        std::string path;
+    };
+
+    GLuint m_FBO, m_colorRBO, m_depthRBO;
+    int m_width, m_height;
+    std::vector<Slot> m_ring;
+    size_t m_head, m_numPending; // oldest readback in flight, number in flight
+    std::deque<std::future<void>> m_encoders;
+    std::chrono::steady_clock::time_point m_start;
+    Stats m_stats;
+    inline void nullify();
+
+    public:
+    BatchRenderer() { nullify(); };
+    ~BatchRenderer();
+
+    public:
+    int getWidth() { return m_width; };
+    int getHeight() { return m_height; };
+    const Stats& getStats() { return m_stats; };
+
+    bool init(int, int, size_t = 3);
+    void beginImage();
+    void endImage(const std::string&);
+    void finish();
+
+    private:
+    void retire(bool);
+    void release();
+
+    private:
+    BatchRenderer(const BatchRenderer&) {};
+    BatchRenderer& operator=(const BatchRenderer&) { return *this; };
+};
+
+inline void BatchRenderer::nullify()
+{
+    m_FBO = m_colorRBO = m_depthRBO = 0;
+    m_width = m_height = 0;
+    std::vector<Slot>().swap(m_ring);
+    m_head = m_numPending = 0;
+    m_stats = Stats();
+}
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef _CLUSTERED_LIGHTING_
+#define _CLUSTERED_LIGHTING_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// glm
+#include <glm/glm.hpp>
+
+// opengl
+#include <glad/glad.h>
+
+// include
+#include <Log.hpp>
+#include <Shader.hpp>
+#include <JobSystem.hpp>
+#include <Simd.hpp>
+#include <GLState.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// ==== light ====
+
+struct Light
+{
+    enum TYPE
+    {
+        POINT,
+        SPOT
+    };
+
+    glm::vec3 position;  // world space
+    float radius;        // influence radius, the light contributes nothing beyond it
+    glm::vec3 color;
+    float intensity;
+    glm::vec3 direction; // world space, spot lights only
+    float spotCosOuter;  // cos(outer cone angle), spot lights only
+    float spotCosInner;  // cos(inner cone angle), spot lights only
+    int type;
+};
+
+// ==== clustered lighting class ====
+//
+// forward+ lighting for thousands of point/spot lights
+// the view frustum is split into dimX * dimY screen tiles times dimZ exponential depth slices;
+// every cluster gets a compact list of the lights whose bounding sphere touches it,
+// so the fragment shader (the CLUSTERED_LIGHTING variants of mesh.fs) only loops over the lights of its own cluster
+//
+// per frame:
+// 1. update(lights, view): CPU assignment, one job per depth slice, 4 lights per SSE test
+// 2. upload(): light data, cluster table and light index list -> texture buffers (GL thread)
+// 3. bind(shaderProgram, firstUnit, width, height): texture units and uniforms of a CLUSTERED_LIGHTING variant (in use)
+//
+// texture buffers (GL 3.1 core, fine for the 3.3 context):
+// lightData    RGBA32F, 4 texels per light: (viewPos, radius) (color * intensity, type) (viewDir, cosOuter) (cosInner, 0, 0, 0)
+// clusterTable RG32UI, per cluster: (offset into lightIndices, count)
+// lightIndices R32UI
+
+class ClusteredLighting
+{
+    public:
+    struct Stats
+    {
+        size_t numLights;
+        size_t numLightIndices; // sum of all cluster light counts
+        size_t maxLightsPerCluster;
+        double assignMs;
+    };
+
+    private:
+    struct ClusterBounds
+    {
+        glm::vec3 boundsMin, boundsMax; // view space
+    };
+
+    int m_dimX, m_dimY, m_dimZ;
+    float m_near, m_far;
+    std::vector<ClusterBounds> m_clusterBounds;
+    // view-space light spheres, structure of arrays for the SIMD test
+    std::vector<float> m_lightX, m_lightY, m_lightZ, m_lightRadius;
+    std::vector<glm::vec4> m_lightData;
+    std::vector<uint32_t> m_clusterTable; // 2 per cluster
+    std::vector<uint32_t> m_lightIndices;
+    std::vector<std::vector<uint32_t>> m_sliceIndices; // per depth slice, merged into m_lightIndices
+    GLuint m_buffers[3], m_textures[3];
+    Stats m_stats;
+    inline void nullify();
+
+    public:
+    ClusteredLighting();
+    ClusteredLighting(int, int, int);
+    ~ClusteredLighting();
+
+    public:
+    Stats getStats() { return m_stats; };
+    int getNumClusters() { return m_dimX * m_dimY * m_dimZ; };
+
+    public:
+    void setProjection(float, float, float, float);
+    void update(const std::vector<Light>&, const glm::mat4&);
+    void upload();
+    void bind(ShaderProgram&, int, int, int);
+
+    private:
+    void assignSlice(int);
+    void destroyBuffers();
+
+    private:
+    ClusteredLighting(const ClusteredLighting&) {};
+    ClusteredLighting& operator=(const ClusteredLighting&) { return *this; };
+};
+
+inline void ClusteredLighting::nullify()
+{
+    m_dimX = m_dimY = m_dimZ = 0;
+    m_near = m_far = 0.0f;
+    std::vector<ClusterBounds>().swap(m_clusterBounds);
+    m_lightX.clear(); m_lightY.clear(); m_lightZ.clear(); m_lightRadius.clear();
+    std::vector<glm::vec4>().swap(m_lightData);
+    std::vector<uint32_t>().swap(m_clusterTable);
+    std::vector<uint32_t>().swap(m_lightIndices);
+    std::vector<std::vector<uint32_t>>().swap(m_sliceIndices);
+    m_buffers[0] = m_buffers[1] = m_buffers[2] = 0;
+    m_textures[0] = m_textures[1] = m_textures[2] = 0;
+    memset(&m_stats, 0, sizeof(Stats));
+}
+
+#endif
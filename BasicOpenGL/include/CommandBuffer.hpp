@@ -0,0 +1,110 @@
+#ifndef _COMMAND_BUFFER_
+#define _COMMAND_BUFFER_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// glm
+#include <glm/glm.hpp>
+
+// opengl
+#include <glad/glad.h>
+
+// include
+#include <Log.hpp>
+#include <GLState.hpp>
+
+// std
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// ==== render command ====
+//
+// compact POD record of one state change or draw
+// handles are plain integers and enums are our own, so recording never touches the graphics API
+
+struct RenderCommand
+{
+    enum TYPE : uint8_t
+    {
+        BIND_PROGRAM,
+        BIND_VERTEX_ARRAY,
+        BIND_TEXTURE,
+        SET_UNIFORM,
+        DRAW_INDEXED
+    };
+
+    enum UNIFORM_TYPE : uint8_t
+    {
+        UNIFORM_INT,
+        UNIFORM_FLOAT,
+        UNIFORM_VEC2,
+        UNIFORM_VEC3,
+        UNIFORM_VEC4,
+        UNIFORM_MAT3,
+        UNIFORM_MAT4
+    };
+
+    enum TEXTURE_TARGET : uint8_t
+    {
+        TEXTURE_2D,
+        TEXTURE_CUBE_MAP,
+        TEXTURE_BUFFER
+    };
+
+    uint8_t type;
+    union
+    {
+        struct { uint32_t program; } bindProgram;
+        struct { uint32_t vertexArray; } bindVertexArray;
+        struct { uint32_t texture; uint16_t unit; uint8_t target; } bindTexture;
+        struct { int32_t location; uint32_t payloadOffset; uint8_t uniformType; } setUniform; // value is stored in the payload
+        struct { uint32_t numIndices; uint32_t firstIndex; int32_t baseVertex; } drawIndexed;  // triangles, 32-bit indices
+    };
+};
+
+static_assert(std::is_trivially_copyable<RenderCommand>::value, "RenderCommand must be POD");
+
+// ==== command buffer class ====
+//
+// filled by one thread (e.g. a JobSystem worker), replayed on the GL thread with execute()
+// give every worker its own CommandBuffer and execute them in a fixed order
+
+class CommandBuffer
+{
+    private:
+    std::vector<RenderCommand> m_commands;
+    std::vector<uint32_t> m_payload; // uniform values, 4-byte words
+
+    public:
+    CommandBuffer() {};
+
+    public:
+    size_t getNumCommands() const { return m_commands.size(); };
+    bool isEmpty() const { return m_commands.empty(); };
+    void clear();
+    void append(const CommandBuffer&);
+
+    // recording
+    void bindProgram(uint32_t);
+    void bindVertexArray(uint32_t);
+    void bindTexture(uint16_t, uint32_t, uint8_t = RenderCommand::TEXTURE_2D);
+    void setInt(int32_t, int);
+    void setFloat(int32_t, float);
+    void setVec2(int32_t, const glm::vec2&);
+    void setVec3(int32_t, const glm::vec3&);
+    void setVec4(int32_t, const glm::vec4&);
+    void setMat3(int32_t, const glm::mat3&);
+    void setMat4(int32_t, const glm::mat4&);
+    void drawIndexed(uint32_t, uint32_t = 0, int32_t = 0);
+
+    // replay (GL backend)
+    void execute() const;
+
+    private:
+    void setUniform(int32_t, uint8_t, const void*, size_t);
+};
+
+#endif
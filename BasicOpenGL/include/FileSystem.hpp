@@ -0,0 +1,184 @@
+#ifndef _FILE_SYSTEM_
+#define _FILE_SYSTEM_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// lz4
+#ifdef ENGINE_LZ4
+#include <lz4.h>
+#endif
+
+// include
+#include <Log.hpp>
+#include <MappedFile.hpp>
+
+// std
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ==== virtual file class ====
+//
+// read-only byte span of one asset: zero-copy into a mounted pack, a decompressed copy (LZ4 entries),
+// or a mapped loose file when no pack has it
+// e.g.) VirtualFile file; if(file.open("../../shader/mesh.vs")) { parse(file.getData(), file.getSize()); }
+
+class VirtualFile
+{
+    private:
+    const char* m_data;
+    size_t m_size;
+    bool m_packed;
+    std::vector<char> m_buffer; // decompressed entry
+    MappedFile m_file;          // loose file
+    inline void nullify();
+
+    public:
+    VirtualFile() { nullify(); };
+    VirtualFile(const char*);
+    ~VirtualFile() { close(); };
+
+    public:
+    const char* getData() const { return m_data; };
+    size_t getSize() const { return m_size; };
+    bool isOpen() const { return m_data != nullptr; };
+    bool isPacked() const { return m_packed; };
+
+    public:
+    bool open(const char*);
+    void close();
+
+    friend class FileSystem;
+
+    private:
+    VirtualFile(const VirtualFile&) {};
+    VirtualFile& operator=(const VirtualFile&) { return *this; };
+};
+
+inline void VirtualFile::nullify()
+{
+    m_data = nullptr;
+    m_size = 0;
+    m_packed = false;
+    std::vector<char>().swap(m_buffer);
+}
+
+// ==== file system class ====
+//
+// asset packs (built by basic_OpenGL_pack) are mapped once by mount(); open() then serves every asset
+// from the mapping, so a cold start costs one open() and sequential page faults instead of a file open per asset
+// anything not in a pack falls back to the loose file, so assets can be added without rebuilding the pack
+//
+// paths are relative to the directory the pack was built from; lookups drop "." and leading ".." components,
+// so the relative paths used by the applications find their entries
+// e.g.) "../../shader/mesh.vs" -> "shader/mesh.vs", "..\\..\\resource\\model\\model.obj" -> "resource/model/model.obj"
+//
+// pack layout (little-endian):
+// PackHeader | entry data, each at a multiple of alignment | PackEntry[numEntries], sorted by hash | paths
+//
+// mount() before loading anything; open() and exists() are thread-safe
+// e.g.) FileSystem::instance().mount("assets.pak");
+
+class FileSystem
+{
+    public:
+    static const uint32_t VERSION = 1;
+    static const uint32_t DEFAULT_ALIGNMENT = 64;
+
+    enum COMPRESSION
+    {
+        NONE,
+        LZ4
+    };
+
+    struct PackHeader
+    {
+        char magic[8];          // "BOGLPAK1"
+        uint32_t version;
+        uint32_t alignment;     // of every entry offset
+        uint32_t numEntries;
+        uint32_t reserved;
+        uint64_t tocOffset;     // PackEntry[numEntries]
+        uint64_t stringsOffset; // paths, not null-terminated
+        uint64_t stringsSize;
+    };
+
+    struct PackEntry
+    {
+        uint64_t hash;          // hashPath() of the normalized path
+        uint64_t offset;
+        uint64_t storedSize;    // bytes in the pack
+        uint64_t size;          // bytes after decompression
+        uint32_t pathOffset;    // into the paths
+        uint32_t pathLength;
+        uint32_t compression;   // COMPRESSION
+        uint32_t reserved;
+    };
+
+    struct Stats
+    {
+        size_t numPacks;
+        size_t numEntries;
+        size_t numPackedReads;
+        size_t numLooseReads;
+        size_t packedBytes;
+        size_t looseBytes;
+        size_t decompressedBytes;
+        double decompressMs;
+    };
+
+    private:
+    struct Pack
+    {
+        MappedFile file;
+        const PackHeader* header;
+        const PackEntry* entries;
+        const char* strings;
+    };
+
+    std::vector<std::unique_ptr<Pack>> m_packs; // later mounts first
+    std::atomic<size_t> m_numPackedReads, m_numLooseReads;
+    std::atomic<size_t> m_packedBytes, m_looseBytes, m_decompressedBytes;
+    std::atomic<int64_t> m_decompressNs;
+    inline void nullify();
+
+    public:
+    FileSystem() { nullify(); };
+
+    public:
+    static FileSystem& instance();
+    Stats getStats();
+
+    bool mount(const char*);
+    void unmountAll();
+    bool open(const char*, VirtualFile&);
+    bool exists(const char*);
+
+    static std::string normalizePath(const char*);
+    static uint64_t hashPath(const std::string&);
+
+    private:
+    const PackEntry* find(const std::string&, Pack*&) const;
+    bool validate(Pack&) const;
+
+    private:
+    FileSystem(const FileSystem&) {};
+    FileSystem& operator=(const FileSystem&) { return *this; };
+};
+
+inline void FileSystem::nullify()
+{
+    std::vector<std::unique_ptr<Pack>>().swap(m_packs);
+    m_numPackedReads = m_numLooseReads = 0;
+    m_packedBytes = m_looseBytes = m_decompressedBytes = 0;
+    m_decompressNs = 0;
+}
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef _FRAME_GRAPH_
+#define _FRAME_GRAPH_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// opengl
+#include <glad/glad.h>
+
+// include
+#include <Log.hpp>
+#include <GLState.hpp>
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// ==== frame graph class ====
+//
+// passes declare the resources they read and write; compile() then
+// 1. culls passes whose results nothing uses (passes writing an imported resource are always kept)
+// 2. orders the remaining passes by their dependencies (declaration order where there is none)
+// 3. finds the lifetime of every transient resource and assigns it a physical texture or buffer from the pool:
+//    resources whose lifetimes do not overlap share one (same size and format for textures)
+// 4. plans the glMemoryBarrier() each pass needs and one framebuffer per pass (its ATTACHMENT resources)
+// execute() runs the passes in that order, with the framebuffer bound and the viewport set
+//
+// transient resources are undefined before their first write (another resource may have used the memory),
+// so the first pass writing one clears or overwrites all of it
+// imported resources (e.g. the default framebuffer, texture 0) belong to the caller and are never aliased
+//
+// GL thread only (execute() and compile(); declaring passes has no GL call)
+// e.g.)
+// FrameGraph graph;
+// int backbuffer = graph.importTexture("backbuffer", 0, FrameGraph::TextureDesc(width, height, GL_RGBA8));
+// int depth = graph.createTexture("depth", FrameGraph::TextureDesc(width, height, GL_DEPTH_COMPONENT24));
+// int color = graph.createTexture("color", FrameGraph::TextureDesc(width, height, GL_RGBA16F));
+// int scene = graph.addPass("scene", [&](const FrameGraph&) { glClear(...); ... draw ... });
+// graph.write(scene, depth);
+// graph.write(scene, color);
+// int post = graph.addPass("post", [&](const FrameGraph& g) { ... sample g.getTexture(color) ... });
+// graph.read(post, color);
+// graph.write(post, backbuffer);
+// graph.compile();                        // after declaring, again after any change
+// LOG_INFO(RENDER, "{}", graph.dumpLifetimes());
+// while(running) { graph.execute(); }
+
+class FrameGraph
+{
+    public:
+    // how a pass uses a resource (decides the framebuffer and the barriers)
+    enum ACCESS
+    {
+        ATTACHMENT, // texture: color or depth attachment of the pass's framebuffer
+        SAMPLED,    // texture: sampler
+        STORAGE,    // image load/store, shader storage buffer
+        UNIFORM,    // buffer: uniform block
+        VERTEX,     // buffer: vertex or index data
+        INDIRECT,   // buffer: indirect draw/dispatch parameters
+        TRANSFER    // glBlitFramebuffer(), glCopy*(), glReadPixels(), glGetBufferSubData()
+    };
+
+    struct TextureDesc
+    {
+        int width, height;
+        GLenum internalFormat; // e.g. GL_RGBA8, GL_RGBA16F, GL_DEPTH_COMPONENT24, GL_DEPTH24_STENCIL8
+
+        TextureDesc() : width(0), height(0), internalFormat(GL_RGBA8) {};
+        TextureDesc(int w, int h, GLenum format) : width(w), height(h), internalFormat(format) {};
+    };
+
+    struct Stats
+    {
+        size_t numPasses;
+        size_t numCulled;
+        size_t numResources;     // transient
+        size_t numTextures;      // physical, after aliasing
+        size_t numBuffers;
+        size_t bytes;            // physical
+        size_t unaliasedBytes;   // one physical resource per transient resource
+    };
+
+    typedef std::function<void(const FrameGraph&)> ExecuteFunction;
+
+    private:
+    struct Access
+    {
+        int resource;
+        int access;
+        bool write;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        ExecuteFunction execute;
+        std::vector<Access> accesses;
+        std::vector<int> dependencies; // earlier passes writing what it accesses (keep them alive)
+        std::vector<int> after;        // earlier passes reading what it writes (order only)
+        bool culled;
+        GLbitfield barriers;  // glMemoryBarrier() before the pass
+        int framebuffer;      // index into m_framebuffers, -1: unchanged, -2: default framebuffer
+    };
+
+    struct Resource
+    {
+        std::string name;
+        bool isBuffer;
+        bool imported;
+        TextureDesc desc;
+        GLsizeiptr size;      // buffers
+        GLuint object;        // texture or buffer name (imported, or the physical one after compile())
+        int physical;         // index into m_physical, -1 if imported or unused
+        int firstUse, lastUse; // positions in m_order
+    };
+
+    struct Physical
+    {
+        bool isBuffer;
+        TextureDesc desc;
+        GLsizeiptr size;
+        GLuint object;
+        int busyUntil; // last position in m_order using it, during compile()
+        bool used;
+    };
+
+    struct Framebuffer
+    {
+        GLuint FBO;
+        int width, height;
+    };
+
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<int> m_order;             // pass indices in execution order, culled passes left out
+    std::vector<Physical> m_physical;     // pool, kept across compile()
+    std::vector<Framebuffer> m_framebuffers;
+    int m_defaultWidth, m_defaultHeight;  // desc of the imported default framebuffer
+    bool m_compiled;
+    Stats m_stats;
+    inline void nullify();
+
+    public:
+    FrameGraph() { nullify(); };
+    ~FrameGraph();
+
+    public:
+    const Stats& getStats() const { return m_stats; };
+    bool isCompiled() const { return m_compiled; };
+    GLuint getTexture(int resource) const { return m_resources[resource].object; };
+    GLuint getBuffer(int resource) const { return m_resources[resource].object; };
+    GLuint getFramebuffer(int) const;
+
+    int createTexture(const char*, const TextureDesc&);
+    int createBuffer(const char*, GLsizeiptr);
+    int importTexture(const char*, GLuint, const TextureDesc&);
+    int importBuffer(const char*, GLuint, GLsizeiptr);
+    int addPass(const char*, ExecuteFunction);
+    void read(int, int, int = SAMPLED);
+    void write(int, int, int = ATTACHMENT);
+    void reset();
+
+    bool compile();
+    void execute();
+    std::string dumpLifetimes() const;
+
+    private:
+    int addResource(const char*, bool, bool, const TextureDesc&, GLsizeiptr, GLuint);
+    void cullPasses();
+    void sortPasses();
+    void assignPhysical();
+    void planBarriers();
+    bool createFramebuffers();
+    void releaseFramebuffers();
+    void releasePool();
+    static GLuint allocate(bool, const TextureDesc&, GLsizeiptr);
+    static GLbitfield getBarrierBits(int, bool);
+    static void getPixelFormat(GLenum, GLenum&, GLenum&);
+    static size_t getTextureBytes(const TextureDesc&);
+    static bool isDepthFormat(GLenum);
+
+    private:
+    FrameGraph(const FrameGraph&) {};
+    FrameGraph& operator=(const FrameGraph&) { return *this; };
+};
+
+inline void FrameGraph::nullify()
+{
+    std::vector<Pass>().swap(m_passes);
+    std::vector<Resource>().swap(m_resources);
+    std::vector<int>().swap(m_order);
+    std::vector<Physical>().swap(m_physical);
+    std::vector<Framebuffer>().swap(m_framebuffers);
+    m_defaultWidth = m_defaultHeight = 0;
+    m_compiled = false;
+    m_stats = Stats();
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef _FRAME_PIPELINE_
+#define _FRAME_PIPELINE_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// include
+#include <Log.hpp>
+#include <CommandBuffer.hpp>
+#include <JobSystem.hpp>
+#include <Residency.hpp>
+
+// std
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <vector>
+
+// ==== render frame ====
+//
+// everything recorded for one frame; buffers[i] is owned by whoever records slice i
+
+struct RenderFrame
+{
+    uint64_t frameIndex;
+    std::vector<CommandBuffer> buffers;
+};
+
+// ==== frame pipeline class ====
+//
+// two frames in flight on the CPU:
+// while the GL thread submits frame N, a worker simulates and records frame N+1
+//
+// e.g.)
+// FramePipeline pipeline(numSlices, [&](RenderFrame& frame) {
+//     JobSystem::instance().parallelFor(objects.size(), 64, [&](size_t begin, size_t end) { ... record into frame.buffers[...] ... });
+// });
+// while(running) { pipeline.submitFrame(); swapBuffers(); }
+//
+// the record function runs off the GL thread: it must not call GL, and it must not touch
+// data the GL thread is using for the frame being submitted
+//
+// submitFrame() also begins the ResidencyManager frame, between the end of a recording and its replay:
+// nothing a recorded frame touched can be evicted before it is drawn (do not call beginFrame() elsewhere)
+
+class FramePipeline
+{
+    public:
+    typedef std::function<void(RenderFrame&)> RecordFunction;
+
+    private:
+    RenderFrame m_frames[2];
+    std::future<void> m_pending;  // recording of m_frames[m_recordIndex]
+    RecordFunction m_record;
+    int m_recordIndex;
+    uint64_t m_frameCounter;
+    inline void nullify();
+
+    public:
+    FramePipeline();
+    FramePipeline(size_t, RecordFunction);
+    ~FramePipeline();
+
+    public:
+    uint64_t getFrameCounter() { return m_frameCounter; };
+    bool isStarted() const { return m_pending.valid(); };
+
+    void start(size_t, RecordFunction);
+    void submitFrame();
+    void stop();
+
+    private:
+    void kick(int);
+
+    private:
+    FramePipeline(const FramePipeline&) {};
+    FramePipeline& operator=(const FramePipeline&) { return *this; };
+};
+
+inline void FramePipeline::nullify()
+{
+    m_record = nullptr;
+    m_recordIndex = 0;
+    m_frameCounter = 0;
+}
+
+#endif
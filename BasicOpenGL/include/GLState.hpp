@@ -0,0 +1,161 @@
+#ifndef _GL_STATE_
+#define _GL_STATE_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// opengl
+#include <glad/glad.h>
+
+// include
+#include <Log.hpp>
+
+// std
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// ==== GL state cache class ====
+//
+// shadows the bindings of the current context and drops calls that would not change them
+// every class in include/ binds through this class instead of calling glUseProgram(), glBindVertexArray(),
+// glActiveTexture(), glBindTexture() and glBindBuffer() directly, so the shadow stays in sync
+// code that changes bindings behind its back (e.g. a third-party renderer) must call invalidate() afterwards
+//
+// textures are created and modified with editTexture() (on EDIT_UNIT), so an upload in the middle of a draw's bindings
+// (e.g. a reload stall in Mesh::draw()) does not replace a texture the draw has already bound
+// GL_ELEMENT_ARRAY_BUFFER is part of the bound VAO: it is always passed through, never cached
+// deleting a bound object unbinds it in GL, so objects are deleted through deleteTextures(), deleteBuffers(), ...
+//
+// the calls of every type are counted per frame (getFrameStats())
+// tracing (off by default) also keeps a log of them, written to the trace file (or the spdlog sink) by endFrame()
+//
+// GL thread only
+// e.g.)
+// GLState& gl = GLState::instance();
+// gl.setTracing(true, "gl_trace.log");
+// ...
+// gl.useProgram(program);                        // skipped if program is already in use
+// gl.bindTexture(0, GL_TEXTURE_2D, texture);
+// ...
+// gl.endFrame();                                 // once per frame, after the last draw
+
+class GLState
+{
+    public:
+    enum CALL : uint8_t
+    {
+        USE_PROGRAM,
+        BIND_VERTEX_ARRAY,
+        ACTIVE_TEXTURE,
+        BIND_TEXTURE,
+        BIND_BUFFER,
+        BIND_BUFFER_RANGE,
+        UNIFORM,   // traced only
+        DRAW,      // traced only
+        DISPATCH,  // traced only
+        NUM_CALLS
+    };
+
+    struct Stats
+    {
+        uint64_t frame;
+        size_t numCalls[NUM_CALLS];   // reached the driver
+        size_t numSkipped[NUM_CALLS]; // dropped as redundant
+    };
+
+    static const GLuint MAX_TEXTURE_UNITS = 32;  // higher units are passed through
+    static const GLuint MAX_BUFFER_INDICES = 16; // indexed uniform and shader storage buffer bindings
+    static const GLuint EDIT_UNIT = MAX_TEXTURE_UNITS - 1; // uploads and residency changes, never used by draws
+
+    private:
+    enum TEXTURE_TARGET { TEX_2D, TEX_CUBE_MAP, TEX_BUFFER, TEX_2D_ARRAY, TEX_3D, NUM_TEXTURE_TARGETS };
+    enum BUFFER_TARGET
+    {
+        BUF_ARRAY, BUF_UNIFORM, BUF_TEXTURE, BUF_COPY_READ, BUF_COPY_WRITE, BUF_PIXEL_PACK, BUF_PIXEL_UNPACK,
+        BUF_SHADER_STORAGE, BUF_DRAW_INDIRECT, BUF_PARAMETER,
+        NUM_BUFFER_TARGETS
+    };
+    static const GLuint UNKNOWN = 0xFFFFFFFF; // forces the next call through
+
+    struct BufferRange
+    {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
+    struct TraceRecord
+    {
+        uint8_t call;
+        bool skipped;
+        GLenum target;
+        GLuint unit; // texture unit, binding index
+        GLuint name;
+    };
+
+    GLuint m_program;
+    GLuint m_vertexArray;
+    GLuint m_activeUnit;
+    GLuint m_textures[MAX_TEXTURE_UNITS][NUM_TEXTURE_TARGETS];
+    GLuint m_buffers[NUM_BUFFER_TARGETS];
+    BufferRange m_uniformRanges[MAX_BUFFER_INDICES];
+    BufferRange m_storageRanges[MAX_BUFFER_INDICES];
+
+    bool m_tracing;
+    FILE* m_traceFile;
+    std::vector<TraceRecord> m_trace;
+    Stats m_stats, m_lastStats;
+    inline void nullify();
+
+    public:
+    GLState();
+    ~GLState();
+
+    public:
+    static GLState& instance();
+    const Stats& getFrameStats() { return m_lastStats; }; // the frame before the last endFrame()
+    bool isTracing() { return m_tracing; };
+    void setTracing(bool, const char* = nullptr);
+
+    void invalidate();
+    void useProgram(GLuint);
+    void bindVertexArray(GLuint);
+    void bindTexture(GLuint, GLenum, GLuint);
+    void editTexture(GLenum, GLuint);
+    void bindBuffer(GLenum, GLuint);
+    void bindBufferRange(GLenum, GLuint, GLuint, GLintptr, GLsizeiptr);
+    void deletePrograms(GLsizei, const GLuint*);
+    void deleteVertexArrays(GLsizei, const GLuint*);
+    void deleteTextures(GLsizei, const GLuint*);
+    void deleteBuffers(GLsizei, const GLuint*);
+
+    // calls that are not cached but show up in the counts and the trace
+    void traceUniform(GLint location) { record(UNIFORM, false, 0, 0, static_cast<GLuint>(location)); };
+    void traceDraw(GLenum mode, GLuint count) { record(DRAW, false, mode, 0, count); };
+    void traceDispatch(GLuint numGroups) { record(DISPATCH, false, 0, 0, numGroups); };
+
+    void endFrame();
+
+    private:
+    void activeTexture(GLuint);
+    void record(uint8_t, bool, GLenum, GLuint, GLuint);
+    static int getTextureTarget(GLenum);
+    static int getBufferTarget(GLenum);
+
+    private:
+    GLState(const GLState&) {};
+    GLState& operator=(const GLState&) { return *this; };
+};
+
+inline void GLState::nullify()
+{
+    m_tracing = false;
+    m_traceFile = nullptr;
+    std::vector<TraceRecord>().swap(m_trace);
+    m_stats = m_lastStats = Stats();
+    invalidate();
+}
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef _GPU_SCENE_
+#define _GPU_SCENE_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// glm
+#include <glm/glm.hpp>
+
+// opengl
+#include <glad/glad.h>
+
+// include
+#include <Log.hpp>
+#include <GLState.hpp>
+#include <Shader.hpp>
+#include <ShaderVariants.hpp>
+#include <Mesh.hpp>
+#include <OcclusionCuller.hpp>
+#include <Residency.hpp>
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// ==== GPU scene class ====
+//
+// GPU-driven rendering: the CPU cost of a frame does not depend on the number of instances
+// - the geometry of every mesh is copied into one vertex buffer and one index buffer (mega buffer),
+//   a mesh is a range of it (firstIndex, baseVertex) with up to MAX_LODS levels of detail
+// - mesh ranges and instances (world matrix, mesh) live in shader storage buffers
+// - cull(): one compute invocation per instance (shader/cull.comp) tests the bounding box against the frustum
+//   and, optionally, the max-depth pyramid of an OcclusionCuller (Hi-Z), picks the LOD by distance
+//   and writes a DrawElementsIndirectCommand for the instance
+// - draw(): one glMultiDrawElementsIndirect() per batch (instances whose meshes share textures and shader features)
+//
+// OpenGL 4.6 or ARB_indirect_parameters: visible commands are compacted and the GPU reads the draw count
+// (glMultiDrawElementsIndirectCount()); otherwise every instance keeps its slot and a culled one has instanceCount = 0
+//
+// the vertex shader finds its instance through attribute INSTANCE_ATTRIBUTE (divisor 1, an identity buffer):
+// a command with baseInstance = i fetches element i, so gl_BaseInstance (ARB_shader_draw_parameters) is not needed
+// e.g.) shader/indirect.vs
+//
+// requires OpenGL 4.3 (compute shaders, shader storage buffers, multi-draw indirect), see isSupported()
+// skinned meshes are skipped: their bone palette is per model (use SceneGraph::record() for them)
+//
+// GL thread only
+// e.g.)
+// GpuScene scene;
+// scene.init("cull.comp");
+// int mesh = scene.addMesh(*model.getMeshes()[0]);
+// scene.addLod(mesh, *lowPolyMesh, 50.0f);    // optional: farther than 50 units
+// int instance = scene.addInstance(mesh, world);
+// scene.build();                              // after the last addMesh()/addLod()/addInstance()
+// ...
+// scene.setWorld(instance, world);            // moving instances
+// scene.cull(viewProj, cameraPosition, &culler);
+// scene.draw(variants);
+
+class GpuScene
+{
+    public:
+    static const int MAX_LODS = 4;
+    static const int MAX_HIZ_LEVELS = 16;     // hizLevels[] in cull.comp
+    static const GLuint GROUP_SIZE = 64;      // local_size_x in cull.comp
+    static const GLuint INSTANCE_ATTRIBUTE = 7;
+
+    // layout(binding = n) of the shader storage blocks in cull.comp and indirect.vs
+    enum BINDING
+    {
+        MESH_BINDING,
+        INSTANCE_BINDING,
+        BATCH_BINDING,
+        COMMAND_BINDING,
+        COUNT_BINDING,
+        HIZ_BINDING
+    };
+
+    // record read by glMultiDrawElementsIndirect()
+    struct DrawCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    struct Stats
+    {
+        size_t numMeshes;
+        size_t numInstances;
+        size_t numBatches;  // multi-draw calls per frame
+        size_t numVisible;  // last readNumVisible()
+        bool compact;       // draw count read by the GPU
+        double cullMs;      // CPU time of the last cull()
+        double drawMs;      // CPU time of the last draw()
+    };
+
+    private:
+    // std430 layouts, mirrored in cull.comp and indirect.vs
+    struct Lod
+    {
+        GLuint firstIndex;
+        GLuint count;
+        GLint baseVertex;
+        float distance; // the next level is used beyond this distance
+    };
+
+    struct MeshRange
+    {
+        glm::vec4 boundsMin, boundsMax; // model space (LOD 0), w unused
+        Lod lods[MAX_LODS];
+        GLuint numLods;
+        GLuint batch;
+        GLuint pad[2];
+    };
+
+    struct Instance
+    {
+        glm::mat4 world;
+        GLuint mesh;
+        GLuint pad[3];
+    };
+
+    struct Batch
+    {
+        uint32_t features;
+        std::vector<Texture> textures;
+        GLuint firstCommand, numCommands; // its instances, contiguous after build()
+    };
+
+    ShaderProgram m_cullProgram;
+    bool m_compact;
+    PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC m_multiDrawCount; // core or ARB entry point
+
+    std::vector<const Mesh*> m_sources;               // one per LOD, copied into the mega buffer by build()
+    std::vector<MeshRange> m_meshes;                  // lods[].firstIndex holds the source index until build()
+    std::vector<Instance> m_instances;                // sorted by batch in build()
+    std::vector<int> m_handleToIndex;
+    std::vector<Batch> m_batches;
+    size_t m_dirtyBegin, m_dirtyEnd;                  // instances changed since the last upload
+
+    GLuint m_VAO, m_VBO, m_EBO, m_instanceIndexVBO;
+    GLuint m_meshSSBO, m_instanceSSBO, m_batchSSBO, m_commandBuffer, m_countBuffer, m_hizSSBO;
+    GLsizeiptr m_hizBytes;
+    glm::mat4 m_viewProj;
+    Stats m_stats;
+    inline void nullify();
+
+    public:
+    GpuScene() { nullify(); };
+    ~GpuScene() { release(); };
+
+    public:
+    static bool isSupported() { return GLAD_GL_VERSION_4_3 != 0; };
+    const Stats& getStats() const { return m_stats; };
+    bool isBuilt() const { return m_VAO != 0; };
+
+    bool init(const char*);
+    int addMesh(const Mesh&);
+    void addLod(int, const Mesh&, float);
+    int addInstance(int, const glm::mat4&);
+    void setWorld(int, const glm::mat4&);
+    bool build();
+
+    void cull(const glm::mat4&, const glm::vec3&, const OcclusionCuller* = nullptr);
+    void draw(ShaderVariants&);
+    size_t readNumVisible();
+
+    private:
+    int findBatch(const Mesh&);
+    void uploadHiZ(const OcclusionCuller&);
+    static GLuint createBuffer(GLenum, GLsizeiptr, const void*, GLenum);
+    void releaseBuffers();
+    void release();
+
+    private:
+    GpuScene(const GpuScene&) {};
+    GpuScene& operator=(const GpuScene&) { return *this; };
+};
+
+inline void GpuScene::nullify()
+{
+    m_compact = false;
+    m_multiDrawCount = nullptr;
+    std::vector<const Mesh*>().swap(m_sources);
+    std::vector<MeshRange>().swap(m_meshes);
+    std::vector<Instance>().swap(m_instances);
+    std::vector<int>().swap(m_handleToIndex);
+    std::vector<Batch>().swap(m_batches);
+    m_dirtyBegin = m_dirtyEnd = 0;
+    m_VAO = m_VBO = m_EBO = m_instanceIndexVBO = 0;
+    m_meshSSBO = m_instanceSSBO = m_batchSSBO = m_commandBuffer = m_countBuffer = m_hizSSBO = 0;
+    m_hizBytes = 0;
+    m_viewProj = glm::mat4(1.0f);
+    m_stats = Stats();
+}
+
+#endif
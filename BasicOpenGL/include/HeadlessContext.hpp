@@ -0,0 +1,61 @@
+#ifndef _HEADLESS_CONTEXT_
+#define _HEADLESS_CONTEXT_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// opengl
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+// include
+#include <Log.hpp>
+
+// std
+#include <cstring>
+
+// ==== headless context class ====
+//
+// OpenGL 3.3 core context without a window or a display server (EGL)
+// 1. EGL_MESA_platform_surfaceless if the EGL client supports it (Mesa: llvmpipe or a render node), default display otherwise
+// 2. no surface at all with EGL_KHR_surfaceless_context, a 1x1 pbuffer otherwise
+// render into an FBO; the default framebuffer is not usable
+//
+// e.g.)
+// HeadlessContext context;
+// if(!context.create()) { return -1; }
+// ... GL calls ...
+
+class HeadlessContext
+{
+    private:
+    EGLDisplay m_display;
+    EGLContext m_context;
+    EGLSurface m_surface;
+    inline void nullify();
+
+    public:
+    HeadlessContext() { nullify(); };
+    ~HeadlessContext() { destroy(); };
+
+    public:
+    bool create();
+    void destroy();
+
+    private:
+    static bool hasExtension(const char*, const char*);
+
+    private:
+    HeadlessContext(const HeadlessContext&) {};
+    HeadlessContext& operator=(const HeadlessContext&) { return *this; };
+};
+
+inline void HeadlessContext::nullify()
+{
+    m_display = EGL_NO_DISPLAY;
+    m_context = EGL_NO_CONTEXT;
+    m_surface = EGL_NO_SURFACE;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef _JOB_SYSTEM_
+#define _JOB_SYSTEM_
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ==== job system class ====
+//
+// a fixed pool of worker threads shared by every CPU-side stage (welding, loading, culling, ...)
+// the thread calling parallelFor() also executes chunks, so nested parallelFor() never deadlocks
+
+class JobSystem
+{
+    private:
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_quit;
+
+    public:
+    JobSystem(unsigned int);
+    ~JobSystem();
+
+    public:
+    static JobSystem& instance();
+    unsigned int getNumWorkers() { return static_cast<unsigned int>(m_workers.size()); };
+
+    void parallelFor(size_t, size_t, const std::function<void(size_t, size_t)>&);
+    std::future<void> async(std::function<void()>);
+
+    private:
+    void push(std::function<void()>);
+    void workerLoop();
+
+    private:
+    JobSystem(const JobSystem&) {};
+    JobSystem& operator=(const JobSystem&) { return *this; };
+};
+
+#endif
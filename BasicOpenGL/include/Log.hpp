@@ -0,0 +1,73 @@
+#ifndef _LOG_
+#define _LOG_
+
+// spdlog
+#include <spdlog/spdlog.h>
+#include <spdlog/async.h>
+
+// std
+#include <memory>
+#include <string>
+
+// ==== log class ====
+//
+// one logger per subsystem, all of them asynchronous: the calling thread only formats the message
+// and pushes it into a ring buffer, a background thread writes it to the console
+// a full ring drops the oldest messages instead of blocking the caller
+//
+// levels:
+// - compile time: LOG_<LEVEL>() below SPDLOG_ACTIVE_LEVEL compiles to nothing, arguments included
+//   (CMake: TRACE in Debug builds, INFO otherwise), so per-object messages are LOG_DEBUG()/LOG_TRACE()
+// - run time: per subsystem, setLevel() or setLevels("asset=debug,render=warn")
+//
+// application code (src/) logs through LOG_<LEVEL>() too; plain SPDLOG_<LEVEL>() goes to the default logger,
+// which is the CORE logger once Log is used
+//
+// e.g.)
+// Log::setLevels("asset=off");                 // measure load time without logging
+// LOG_DEBUG(ASSET, "Mesh.VAO = {}", m_VAO);
+
+#define LOG_TRACE(subsystem, ...) SPDLOG_LOGGER_TRACE(Log::get(Log::subsystem), __VA_ARGS__)
+#define LOG_DEBUG(subsystem, ...) SPDLOG_LOGGER_DEBUG(Log::get(Log::subsystem), __VA_ARGS__)
+#define LOG_INFO(subsystem, ...) SPDLOG_LOGGER_INFO(Log::get(Log::subsystem), __VA_ARGS__)
+#define LOG_WARN(subsystem, ...) SPDLOG_LOGGER_WARN(Log::get(Log::subsystem), __VA_ARGS__)
+#define LOG_ERROR(subsystem, ...) SPDLOG_LOGGER_ERROR(Log::get(Log::subsystem), __VA_ARGS__)
+
+class Log
+{
+    public:
+    enum SUBSYSTEM
+    {
+        CORE,      // default logger: application code
+        GL,        // shaders, GL state, contexts
+        ASSET,     // models, meshes, images, file loading, residency
+        RENDER,    // command buffers, scene graph, culling, lighting
+        ANIMATION,
+        NUM_SUBSYSTEMS
+    };
+
+    static const size_t QUEUE_SIZE = 8192; // messages
+
+    private:
+    std::shared_ptr<spdlog::logger> m_loggers[NUM_SUBSYSTEMS];
+    spdlog::logger* m_rawLoggers[NUM_SUBSYSTEMS]; // get() without touching the shared_ptr
+    static const char* s_names[NUM_SUBSYSTEMS];
+
+    public:
+    Log();
+    ~Log();
+
+    public:
+    static Log& instance();
+    static spdlog::logger* get(int subsystem) { return instance().m_rawLoggers[subsystem]; };
+    static void setLevel(int, spdlog::level::level_enum);
+    static void setLevels(const char*);
+    static void flush();
+    static size_t getNumDropped() { instance(); return spdlog::thread_pool()->overrun_counter(); }; // overwritten by a full ring
+
+    private:
+    Log(const Log&) {};
+    Log& operator=(const Log&) { return *this; };
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef _MAPPED_FILE_
+#define _MAPPED_FILE_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// os
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// include
+#include <Log.hpp>
+
+// std
+#include <string>
+
+// ==== memory-mapped file class ====
+//
+// read-only view of a whole file
+
+class MappedFile
+{
+    private:
+    std::string m_filePath;
+    const char* m_data;
+    size_t m_size;
+#ifdef _WIN32
+    HANDLE m_file, m_mapping;
+#else
+    int m_fd;
+#endif
+    inline void nullify();
+
+    public:
+    MappedFile();
+    MappedFile(const char*);
+    ~MappedFile();
+
+    public:
+    std::string getFilePath() { return m_filePath; };
+    const char* getData() { return m_data; };
+    size_t getSize() { return m_size; };
+    bool isOpen() { return m_data != nullptr; };
+
+    public:
+    bool open(const char*);
+    void close();
+
+    private:
+    MappedFile(const MappedFile&) {};
+    MappedFile& operator=(const MappedFile&) { return *this; };
+};
+
+inline void MappedFile::nullify()
+{
+    m_filePath = "";
+    m_data = nullptr;
+    m_size = 0;
+#ifdef _WIN32
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+#else
+    m_fd = -1;
+#endif
+}
+
+#endif
@@ -12,7 +12,12 @@
 #include <GLFW/glfw3.h>
 
 // include
+#include <Log.hpp>
 #include <Shader.hpp>
+#include <CommandBuffer.hpp>
+#include <Residency.hpp>
+#include <ShaderVariants.hpp>
+#include <GLState.hpp>
 
 // std
 #include <vector>
@@ -26,6 +31,13 @@ struct Vertex
     glm::vec3 bitangent;
 };
 
+// up to 4 bone influences per vertex, in a separate VBO (attribute locations 5 and 6)
+struct VertexBoneData
+{
+    GLint boneIDs[4];
+    GLfloat weights[4]; // sum to 1, unused slots are 0
+};
+
 struct Texture
 {
     // texture type
@@ -39,14 +51,23 @@ struct Texture
 
     GLuint textureID; // Image.m_imageID
     int type;
+    ResidencyEntry* residency; // Image.m_residency (nullable)
 };
 
 class Mesh
 {
     private:
     GLuint m_VAO, m_VBO, m_EBO;
+    GLuint m_boneVBO; // skinned meshes only
     GLsizei m_numIndices;
+    GLsizeiptr m_vertexBytes, m_indexBytes, m_boneBytes;
+    ResidencyEntry* m_residency;
+    std::vector<unsigned char> m_evictedVertices, m_evictedIndices, m_evictedBones; // VBO/EBO/bone VBO contents while evicted
     std::vector<Texture> m_textures;
+    uint32_t m_features; // ShaderVariants feature mask this mesh needs
+    glm::vec3 m_boundsMin, m_boundsMax; // model-space AABB
+    std::vector<glm::vec3> m_occluderPositions; // CPU copy for OcclusionCuller (occluder meshes only)
+    std::vector<unsigned int> m_occluderIndices;
     inline void nullify();
 
     public:
@@ -54,161 +75,36 @@ class Mesh
     Mesh(std::vector<Vertex>&, std::vector<unsigned int>&, std::vector<Texture>&);
     ~Mesh();
 
+    public:
+    uint32_t getFeatures() const { return m_features; };
+    GLuint getVBO() const { return m_VBO; };
+    GLuint getEBO() const { return m_EBO; };
+    GLsizeiptr getVertexBytes() const { return m_vertexBytes; };
+    GLsizei getNumIndices() const { return m_numIndices; };
+    bool isSkinned() const { return m_boneVBO != 0; };
+    const std::vector<Texture>& getTextures() const { return m_textures; };
+    ResidencyEntry* getResidency() const { return m_residency; };
+    const glm::vec3& getBoundsMin() const { return m_boundsMin; };
+    const glm::vec3& getBoundsMax() const { return m_boundsMax; };
+    bool isOccluder() const { return !m_occluderIndices.empty(); };
+    const std::vector<glm::vec3>& getOccluderPositions() const { return m_occluderPositions; };
+    const std::vector<unsigned int>& getOccluderIndices() const { return m_occluderIndices; };
+
     public:
     void load(std::vector<Vertex>&, std::vector<unsigned int>&, std::vector<Texture>&);
+    void setOccluderGeometry(std::vector<Vertex>&, std::vector<unsigned int>&);
+    void setBoneData(std::vector<VertexBoneData>&);
     void draw(ShaderProgram&);
+    void record(CommandBuffer&, const ShaderProgram&) const;
+
+    private:
+    void release();
+    size_t evict();
+    size_t restore();
 
     private:
     Mesh(const Mesh& m) {};
     Mesh& operator=(const Mesh& m) {};
 };
 
-void Mesh::nullify()
-{
-    m_VAO = m_VBO = m_EBO = 0;
-    std::vector<Texture>().swap(m_textures); // anonymous object
-}
-
-Mesh::Mesh() { nullify(); }
-
-Mesh::Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Texture>& textures)
-{
-    nullify();
-    load(vertices, indices, textures);
-}
-
-Mesh::~Mesh()
-{
-    if(m_VAO)
-    {
-        glDeleteVertexArrays(1, &m_VAO);
-        if(m_VBO) { glDeleteBuffers(1, &m_VBO); }
-        if(m_EBO) { glDeleteBuffers(1, &m_EBO); }
-        nullify();
-    }
-}
-
-void Mesh::load(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Texture>& textures)
-{
-    SPDLOG_INFO("Mesh::load()");
-
-    // delete existing mesh
-    if(m_VAO)
-    {
-        SPDLOG_WARN("delete existing Mesh (VAO={})", m_VAO);
-        glDeleteVertexArrays(1, &m_VAO);
-        if(m_VBO) { glDeleteBuffers(1, &m_VBO); }
-        if(m_EBO) { glDeleteBuffers(1, &m_EBO); }
-        nullify();
-    }
-
-    // generate VAO, EBO, and EBO
-    glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-    glGenBuffers(1, &m_EBO);
-    if(!(m_VAO && m_VBO && m_EBO))
-    {
-        SPDLOG_ERROR("failed to generate VAO, VBO, or EBO");
-        if(m_VAO) { glDeleteVertexArrays(1, &m_VAO); }
-        if(m_VBO) { glDeleteBuffers(1, &m_VBO); }
-        if(m_EBO) { glDeleteBuffers(1, &m_EBO); }
-        nullify();
-        return;
-    }
-
-    // bind VAO
-    glBindVertexArray(m_VAO);
-
-    // bind and buffer VBO
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, bitangent));
-    glEnableVertexAttribArray(4);
-
-    // bind and buffer EBO
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-    m_numIndices = static_cast<GLuint>(indices.size());
-
-    // store textures (ID and type)
-    m_textures = textures;
-
-    // unbind VAO
-    glBindVertexArray(0);
-
-    SPDLOG_INFO("Mesh.VAO = {}", m_VAO);
-}
-
-// call this method after calling shaderProgram.use()
-//
-// uniform sampler2D in shaderProgram:
-// diffuseMap<n>, specularMap<n>, normalMap<n>, heightMap<n> (n = 0, 1, 2, ...)
-//
-// TODO: better solution?
-// uniform sampler2D diffuseMap[MAX_SIZE];
-// uniform numDiffuse;
-void Mesh::draw(ShaderProgram& shaderProgram)
-{
-    // local vars
-    int numBoundedTexture, numDiffuse, numSpecular, numNormal, numHeight;
-    numBoundedTexture = numDiffuse = numSpecular = numNormal = numHeight = 0;
-
-    // bind textures
-    for(int i = 0; i < m_textures.size(); i++)
-    {
-        std::string uniformName;
-        switch (m_textures[i].type)
-        {
-        case Texture::TYPE::DIFFUSE:
-            uniformName = "diffuseMap";
-            uniformName += std::to_string(numDiffuse++);
-            break;
-        case Texture::TYPE::SPECULAR:
-            uniformName = "specularMap";
-            uniformName += std::to_string(numSpecular++);
-            break;
-        case Texture::TYPE::NORMAL:
-            uniformName = "normalMap";
-            uniformName += std::to_string(numNormal++);
-            break;
-        case Texture::TYPE::HEIGHT:
-            uniformName = "heightMap";
-            uniformName += std::to_string(numHeight++);
-            break;
-        default:
-            SPDLOG_WARN("wrong or unimplemented texture type");
-            continue;
-        }
-        
-        // select texture unit and bind texture
-        glActiveTexture(GL_TEXTURE0 + i);
-        glBindTexture(GL_TEXTURE_2D, m_textures[i].textureID);
-        numBoundedTexture++;
-
-        // assign the number of texture unit to uniform
-        shaderProgram.setSampler(uniformName.c_str(), i);
-    }
-
-    // draw mesh
-    glBindVertexArray(m_VAO);
-    glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0); // unbind VAO
-
-    // unbind all textures
-    for(int i = 0; i < numBoundedTexture; i++)
-    {
-        glActiveTexture(GL_TEXTURE0 + i);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
-}
-
-#endif
\ No newline at end of file
+#endif
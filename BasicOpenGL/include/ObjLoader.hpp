@@ -0,0 +1,144 @@
+#ifndef _OBJ_LOADER_
+#define _OBJ_LOADER_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// glm
+#include <glm/glm.hpp>
+
+// include
+#include <Log.hpp>
+#include <Mesh.hpp>
+#include <FileSystem.hpp>
+#include <JobSystem.hpp>
+
+// std
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ==== Wavefront OBJ/MTL loader class ====
+//
+// a dedicated replacement for the assimp importer on .obj files
+// 1. map the file (FileSystem: asset pack or loose file) and split it into line-aligned chunks
+// 2. parse the chunks in parallel (std::from_chars), triangulating polygons as fans
+// 3. resolve relative indices and material switches across chunk boundaries
+// 4. per material (in parallel): deduplicate v/vt/vn tuples into Vertex/index arrays
+//
+// the output matches what Model expects from assimp with aiProcess_Triangulate | aiProcess_FlipUVs
+// corners without vn get a vertex of their own with a zero normal, flagged in MeshData::missingNormals;
+// tangents and bitangents are left at zero: Model generates both with TangentSpace (crease angle, in parallel)
+
+class ObjLoader
+{
+    public:
+    struct Material
+    {
+        std::string name;
+        std::vector<std::string> texturePaths[4]; // indexed by Texture::TYPE, relative to the model directory
+    };
+
+    struct MeshData
+    {
+        int materialIndex; // index into getMaterials(), -1 if none
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<uint8_t> missingNormals; // per vertex: 1 if the file had no vn (empty if every corner had one)
+    };
+
+    struct Stats
+    {
+        size_t numBytes;
+        size_t numTriangles;
+        size_t numVertices;
+        double seconds;
+    };
+
+    private:
+    static const int32_t MISSING = INT32_MIN;
+
+    // one corner of a triangle: 0-based v/vt/vn indices (MISSING if absent)
+    struct Corner
+    {
+        int32_t v, vt, vn;
+    };
+
+    struct MaterialSwitch
+    {
+        size_t firstTriangle;
+        std::string name;
+    };
+
+    struct Chunk
+    {
+        const char* begin;
+        const char* end;
+        std::vector<float> positions, texCoords, normals; // 3, 2, 3 floats per element
+        std::vector<Corner> corners;                      // 3 per triangle
+        std::vector<uint8_t> relative;                    // per corner: bit 0/1/2 = v/vt/vn is relative to this chunk
+        std::vector<MaterialSwitch> switches;
+        std::vector<std::string> mtllibs;
+        size_t positionBase, texCoordBase, normalBase;
+        bool error;
+    };
+
+    // a run of triangles of one chunk that share a material
+    struct Segment
+    {
+        size_t chunk;
+        size_t firstTriangle, lastTriangle; // [first, last)
+    };
+
+    std::vector<MeshData> m_meshes;
+    std::vector<Material> m_materials;
+    std::vector<float> m_positions, m_texCoords, m_normals;
+    Stats m_stats;
+    bool m_flipUVs;
+    inline void nullify();
+
+    public:
+    ObjLoader();
+    ObjLoader(const char*);
+
+    public:
+    std::vector<MeshData>& getMeshes() { return m_meshes; };
+    std::vector<Material>& getMaterials() { return m_materials; };
+    Stats getStats() { return m_stats; };
+    void setFlipUVs(bool flag) { m_flipUVs = flag; };
+
+    public:
+    bool loadFromFile(const char*);
+    private:
+    void parseChunk(Chunk&);
+    bool loadMaterials(const std::string&);
+    bool buildMesh(std::vector<Chunk>&, std::vector<Segment>&, MeshData&);
+
+    static const char* skipSpace(const char*, const char*);
+    static const char* skipToken(const char*, const char*);
+    static const char* parseFloat(const char*, const char*, float&);
+    static const char* parseIndex(const char*, const char*, int32_t&);
+    static std::string readName(const char*, const char*);
+    static bool isKeyword(const char*, const char*, const char*);
+
+    private:
+    ObjLoader(const ObjLoader&) {};
+    ObjLoader& operator=(const ObjLoader&) { return *this; };
+};
+
+inline void ObjLoader::nullify()
+{
+    std::vector<MeshData>().swap(m_meshes);
+    std::vector<Material>().swap(m_materials);
+    std::vector<float>().swap(m_positions);
+    std::vector<float>().swap(m_texCoords);
+    std::vector<float>().swap(m_normals);
+    memset(&m_stats, 0, sizeof(Stats));
+}
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef _OCCLUSION_CULLER_
+#define _OCCLUSION_CULLER_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// glm
+#include <glm/glm.hpp>
+
+// include
+#include <JobSystem.hpp>
+#include <Simd.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// ==== occlusion culler class ====
+//
+// CPU-only (no GL), so it can run and be tested headless
+//
+// per frame:
+// 1. beginFrame(viewProj), then addOccluder() for every designated occluder mesh
+// 2. rasterize(): occluder triangles -> low-resolution depth buffer (SSE, one band of rows per job)
+//                 -> min/max depth pyramid (each level halves the resolution)
+// 3. isVisible(): project a bounding box, start at the pyramid level where it covers at most 2x2 texels,
+//                 and compare its nearest depth against the min/max occluder depth there, refining while undecided
+//
+// depth is NDC z remapped to [0, 1], 0 = near plane; empty pixels are 1 (far)
+// isVisible() is const and may be called from several threads at once
+
+class OcclusionCuller
+{
+    public:
+    struct Stats
+    {
+        size_t numOccluderTriangles;
+        size_t numTested;
+        size_t numCulled;     // hidden behind occluders
+        size_t numOffscreen;  // outside the view frustum
+        double rasterMs;      // rasterize(), including the pyramid
+    };
+
+    private:
+    struct ScreenVertex
+    {
+        float x, y, z; // pixels, pixels, [0, 1]
+        bool valid;    // in front of the near plane
+    };
+
+    struct Level
+    {
+        int width, height;
+        std::vector<float> minDepth, maxDepth;
+    };
+
+    int m_width, m_height;
+    glm::mat4 m_viewProj;
+    std::vector<float> m_depth;
+    std::vector<Level> m_levels;
+    std::vector<ScreenVertex> m_vertices;  // transformed occluder vertices
+    std::vector<uint32_t> m_indices;       // into m_vertices
+    size_t m_numOccluderTriangles;
+    double m_rasterMs;
+    mutable std::atomic<size_t> m_numTested, m_numCulled, m_numOffscreen;
+    inline void nullify();
+
+    public:
+    OcclusionCuller();
+    OcclusionCuller(int, int);
+
+    public:
+    int getWidth() { return m_width; };
+    int getHeight() { return m_height; };
+    const std::vector<float>& getDepthBuffer() { return m_depth; };
+    const glm::mat4& getViewProj() const { return m_viewProj; };
+    int getNumLevels() const { return static_cast<int>(m_levels.size()); };
+    int getLevelWidth(int level) const { return m_levels[level].width; };
+    int getLevelHeight(int level) const { return m_levels[level].height; };
+    const std::vector<float>& getMaxDepth(int level) const { return m_levels[level].maxDepth; }; // farthest occluder per texel
+    Stats getStats() const;
+
+    public:
+    void setResolution(int, int);
+    void beginFrame(const glm::mat4&);
+    void addOccluder(const glm::vec3*, size_t, const unsigned int*, size_t, const glm::mat4&);
+    void rasterize();
+    bool isVisible(const glm::vec3&, const glm::vec3&, const glm::mat4&) const;
+
+    private:
+    void rasterizeRows(int, int);
+    void buildPyramid();
+
+    private:
+    OcclusionCuller(const OcclusionCuller&) {};
+    OcclusionCuller& operator=(const OcclusionCuller&) { return *this; };
+};
+
+inline void OcclusionCuller::nullify()
+{
+    m_width = m_height = 0;
+    m_viewProj = glm::mat4(1.0f);
+    std::vector<float>().swap(m_depth);
+    std::vector<Level>().swap(m_levels);
+    std::vector<ScreenVertex>().swap(m_vertices);
+    std::vector<uint32_t>().swap(m_indices);
+    m_numOccluderTriangles = 0;
+    m_rasterMs = 0.0;
+    m_numTested = m_numCulled = m_numOffscreen = 0;
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _PACK_IO_SYSTEM_
+#define _PACK_IO_SYSTEM_
+
+// assimp
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+
+// include
+#include <FileSystem.hpp>
+
+// std
+#include <cstring>
+
+// ==== assimp io classes ====
+//
+// assimp reads models (and the files they reference, e.g. .mtl) through FileSystem instead of fopen()
+// e.g.) Assimp::Importer importer; importer.SetIOHandler(new PackIOSystem()); // the importer deletes it
+
+class PackIOStream : public Assimp::IOStream
+{
+    private:
+    VirtualFile m_file;
+    size_t m_position;
+
+    public:
+    PackIOStream() : m_position(0) {};
+
+    public:
+    bool open(const char* filePath) { return m_file.open(filePath); };
+
+    size_t Read(void*, size_t, size_t) override;
+    size_t Write(const void*, size_t, size_t) override { return 0; };
+    aiReturn Seek(size_t, aiOrigin) override;
+    size_t Tell() const override { return m_position; };
+    size_t FileSize() const override { return m_file.getSize(); };
+    void Flush() override {};
+
+    private:
+    PackIOStream(const PackIOStream&) {};
+    PackIOStream& operator=(const PackIOStream&) { return *this; };
+};
+
+class PackIOSystem : public Assimp::IOSystem
+{
+    public:
+    PackIOSystem() {};
+
+    public:
+    bool Exists(const char*) const override;
+    char getOsSeparator() const override { return '/'; };
+    Assimp::IOStream* Open(const char*, const char* = "rb") override;
+    void Close(Assimp::IOStream*) override;
+
+    private:
+    PackIOSystem(const PackIOSystem&) {};
+    PackIOSystem& operator=(const PackIOSystem&) { return *this; };
+};
+
+#endif
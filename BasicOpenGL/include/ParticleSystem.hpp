@@ -0,0 +1,151 @@
+#ifndef _PARTICLE_SYSTEM_
+#define _PARTICLE_SYSTEM_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// glm
+#include <glm/glm.hpp>
+
+// opengl
+#include <glad/glad.h>
+
+// include
+#include <Log.hpp>
+#include <GLState.hpp>
+#include <Shader.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// ==== particle system class ====
+//
+// particles live on the GPU only, in a ring of capacity slots; the CPU cost of a frame does not depend on their number
+// - update(): one transform feedback pass (shader/particle_sim.vs, rasterizer discarded) reads every slot
+//   from one buffer and writes it to the other (ping-pong); the buffers swap roles every frame
+// - emission: emit() adds a record (position, velocity, spread, count, ...) to a small spawn buffer, uploaded once per frame
+//   as a buffer texture; the count of every record is summed, and that many slots after the ring head
+//   are overwritten with new particles (the oldest spawns, dead if lifetimes are shorter than capacity / spawn rate)
+// - draw(): one instanced draw (shader/particle.vs, particle.fs), a camera-facing quad per slot; dead slots are collapsed
+//
+// no readback: the number of live particles is never known on the CPU
+// OpenGL 3.3 core; the simulate time (Stats::gpuMs) is measured with a timer query, read one or two frames late
+//
+// GL thread only
+// e.g.)
+// ParticleSystem particles;
+// particles.init(1 << 20, "particle_sim.vs", "particle.vs", "particle.fs");
+// particles.setGravity(glm::vec3(0.0f, -9.8f, 0.0f));
+// ...
+// particles.emit(glm::vec3(0.0f), glm::vec3(0.0f, 5.0f, 0.0f), 1.0f, 0.1f, 2000, 1.0f, 3.0f); // every frame
+// particles.update(deltaTime);
+// particles.draw(view, projection);   // in the scene pass, after the opaque geometry
+
+class ParticleSystem
+{
+    public:
+    static const size_t MAX_CAPACITY = size_t(1) << 24; // spawn indices are exact in the float texels
+    static const size_t MAX_EMITS = 256;                 // records per frame
+    static const GLuint EMIT_UNIT = 0;                   // texture unit of the spawn buffer during update()
+    static const int NUM_QUERIES = 3;
+
+    // interleaved transform feedback output, mirrored in particle_sim.vs and particle.vs
+    struct Particle
+    {
+        glm::vec4 positionAge;  // w: age in seconds
+        glm::vec4 velocityLife; // w: lifetime in seconds, dead when age >= lifetime
+    };
+
+    struct Stats
+    {
+        size_t capacity;        // slots simulated and drawn every frame
+        size_t numEmits;        // last update()
+        size_t numSpawned;      // last update()
+        size_t numFrames;
+        double cpuMs;           // last update()
+        double gpuMs;           // simulate pass, latest timer query result
+        double particlesPerMs;  // slots simulated per GPU millisecond
+    };
+
+    private:
+    // 3 texels of GL_RGBA32F
+    struct Emit
+    {
+        glm::vec4 positionFirst;  // w: index of its first particle among this frame's spawns
+        glm::vec4 velocitySpread; // w: random velocity added, up to this length
+        glm::vec4 radiusLife;     // x: random position offset, up to this length, y: min lifetime, z: max lifetime
+    };
+
+    ShaderProgram m_simProgram;
+    ShaderProgram m_drawProgram;
+    GLuint m_buffers[2];        // Particle[capacity], ping-pong
+    GLuint m_simVAOs[2];        // reads m_buffers[i] per vertex
+    GLuint m_drawVAOs[2];       // reads m_buffers[i] per instance
+    GLuint m_emitBuffer, m_emitTexture;
+    GLuint m_queries[NUM_QUERIES];
+    bool m_queryPending[NUM_QUERIES];
+    int m_current;              // buffer holding the latest state
+    size_t m_capacity, m_head, m_numSpawns;
+    bool m_initialized;         // the buffers hold particles (not garbage)
+    uint32_t m_seed;
+    std::vector<Emit> m_emits;  // this frame's, uploaded by update()
+    glm::vec3 m_gravity;
+    float m_drag;
+    glm::vec2 m_size;
+    glm::vec4 m_startColor, m_endColor;
+    Stats m_stats;
+    inline void nullify();
+
+    public:
+    ParticleSystem() { nullify(); };
+    ~ParticleSystem() { release(); };
+
+    public:
+    const Stats& getStats() const { return m_stats; };
+    size_t getCapacity() const { return m_capacity; };
+    GLuint getBuffer() const { return m_buffers[m_current]; }; // latest Particle[capacity]
+
+    void setGravity(const glm::vec3& gravity) { m_gravity = gravity; };
+    void setDrag(float drag) { m_drag = drag; };
+    void setSize(float startSize, float endSize) { m_size = glm::vec2(startSize, endSize); };
+    void setColors(const glm::vec4& startColor, const glm::vec4& endColor) { m_startColor = startColor; m_endColor = endColor; };
+
+    bool init(size_t, const char*, const char*, const char*);
+    void emit(const glm::vec3&, const glm::vec3&, float, float, size_t, float, float);
+    void update(float);
+    void draw(const glm::mat4&, const glm::mat4&);
+
+    private:
+    void readQueries();
+    void releaseBuffers();
+    void release();
+
+    private:
+    ParticleSystem(const ParticleSystem&) {};
+    ParticleSystem& operator=(const ParticleSystem&) { return *this; };
+};
+
+inline void ParticleSystem::nullify()
+{
+    m_buffers[0] = m_buffers[1] = 0;
+    m_simVAOs[0] = m_simVAOs[1] = 0;
+    m_drawVAOs[0] = m_drawVAOs[1] = 0;
+    m_emitBuffer = m_emitTexture = 0;
+    for(int i = 0; i < NUM_QUERIES; i++) { m_queries[i] = 0; m_queryPending[i] = false; }
+    m_current = 0;
+    m_capacity = m_head = m_numSpawns = 0;
+    m_initialized = false;
+    m_seed = 0;
+    std::vector<Emit>().swap(m_emits);
+    m_gravity = glm::vec3(0.0f, -9.8f, 0.0f);
+    m_drag = 0.0f;
+    m_size = glm::vec2(0.05f, 0.02f);
+    m_startColor = glm::vec4(1.0f, 0.8f, 0.4f, 1.0f);
+    m_endColor = glm::vec4(1.0f, 0.2f, 0.1f, 0.0f);
+    m_stats = Stats();
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef _RESIDENCY_
+#define _RESIDENCY_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// include
+#include <Log.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// ==== residency entry ====
+//
+// one GPU allocation (texture or buffer) tracked by ResidencyManager
+// the owner (Image, Mesh) provides the callbacks; every callback runs on the GL thread
+// and returns the number of bytes the resource occupies on the GPU afterwards
+// the GL object names never change, so copies of them (e.g. Texture::textureID) stay valid
+
+struct ResidencyEntry
+{
+    enum KIND
+    {
+        TEXTURE,
+        BUFFER
+    };
+
+    enum STATE
+    {
+        RESIDENT,
+        DEMOTED, // lower mips only
+        EVICTED
+    };
+
+    int kind;
+    size_t bytes;                          // current GPU size, owned by the GL thread
+    std::atomic<uint64_t> lastUsedFrame;
+    std::atomic<int> state;
+    std::atomic<bool> requested;           // restore requested by touch()
+    std::function<size_t()> evict;
+    std::function<size_t()> demote;        // optional
+    std::function<size_t()> restore;
+};
+
+// ==== residency manager class ====
+//
+// keeps the bytes of all tracked textures and buffers under a budget
+// beginFrame() (GL thread, once per frame):
+// 1. restores resources requested by touch() since the last frame
+// 2. while over budget: demotes (textures) or evicts the least-recently-drawn resources
+//    resources used in the current or previous frame are never evicted
+//
+// draw paths call makeResident() (GL thread, restores immediately: a "reload stall")
+// record paths call touch() (any thread, never calls GL) and skip non-resident buffers for a frame;
+// with a FramePipeline, beginFrame() is called by submitFrame(), while no frame is being recorded
+
+class ResidencyManager
+{
+    public:
+    struct Stats
+    {
+        size_t budgetBytes;
+        size_t residentBytes;
+        size_t numResources;
+        size_t numEvictions;
+        size_t numDemotions;
+        size_t numReloads;      // restored in beginFrame()
+        size_t numReloadStalls; // restored synchronously in makeResident()
+        double reloadMs;
+    };
+
+    private:
+    std::vector<ResidencyEntry*> m_entries;
+    std::vector<ResidencyEntry*> m_requests;
+    std::mutex m_requestMutex;
+    std::atomic<uint64_t> m_frame;
+    size_t m_budgetBytes;
+    Stats m_stats;
+    inline void nullify();
+
+    public:
+    ResidencyManager();
+    ~ResidencyManager();
+
+    public:
+    static ResidencyManager& instance();
+    Stats getStats();
+    uint64_t getFrame() { return m_frame; };
+
+    public:
+    void setBudget(size_t);
+    ResidencyEntry* add(int, size_t, std::function<size_t()>, std::function<size_t()>, std::function<size_t()>);
+    void remove(ResidencyEntry*);
+    void resize(ResidencyEntry*, size_t);
+
+    void touch(ResidencyEntry*);
+    bool makeResident(ResidencyEntry*);
+    void beginFrame();
+
+    private:
+    void restore(ResidencyEntry*);
+    void enforceBudget();
+
+    private:
+    ResidencyManager(const ResidencyManager&) {};
+    ResidencyManager& operator=(const ResidencyManager&) { return *this; };
+};
+
+inline void ResidencyManager::nullify()
+{
+    std::vector<ResidencyEntry*>().swap(m_entries);
+    std::vector<ResidencyEntry*>().swap(m_requests);
+    m_frame = 0;
+    m_budgetBytes = SIZE_MAX;
+    m_stats = Stats();
+}
+
+#endif
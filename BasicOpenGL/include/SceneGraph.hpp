@@ -0,0 +1,117 @@
+#ifndef _SCENE_GRAPH_
+#define _SCENE_GRAPH_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// glm
+#include <glm/glm.hpp>
+
+// include
+#include <Log.hpp>
+#include <Model.hpp>
+#include <Mesh.hpp>
+#include <ShaderVariants.hpp>
+#include <OcclusionCuller.hpp>
+#include <CommandBuffer.hpp>
+#include <JobSystem.hpp>
+#include <Simd.hpp>
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// ==== scene graph class ====
+//
+// transform hierarchy stored as flat arrays in depth-first preorder:
+// a node's subtree is the index range [i, m_subtreeEnd[i]), and parents come before their children
+//
+// update() recomputes world matrices only for dirty subtrees:
+// 1. scan the dirty flags; a dirty node covers its whole subtree, so the scan skips over it
+// 2. split the dirty roots until there are enough independent subtrees for the JobSystem
+// 3. each job walks its range in order: world = world[parent] * local (SSE)
+//
+// nodes are addressed by stable handles; indices change when nodes are inserted or removed
+// structural edits cost O(n) and are meant for loading, not for every frame
+//
+// e.g.)
+// SceneGraph graph;
+// int character = graph.addModel(model, -1, glm::mat4(1.0f));
+// graph.setLocal(character, transform);              // per frame, for moving objects
+// graph.update();
+// graph.record(cb, variants, culler, 0, graph.getNumDrawItems());
+
+class SceneGraph
+{
+    public:
+    // one mesh attached to one node
+    struct DrawItem
+    {
+        const Mesh* mesh;
+        int node; // handle
+    };
+
+    struct Stats
+    {
+        size_t numNodes;
+        size_t numDirtyRoots;
+        size_t numUpdated; // world matrices recomputed by the last update()
+        double ms;
+    };
+
+    private:
+    std::vector<glm::mat4> m_local, m_world;
+    std::vector<int> m_parent;     // index, -1 for roots
+    std::vector<int> m_subtreeEnd; // index one past the last descendant
+    std::vector<uint8_t> m_dirty;
+    std::vector<int> m_indexToHandle, m_handleToIndex; // removed handles map to -1
+    std::vector<DrawItem> m_drawItems;
+    uint32_t m_features; // ShaderVariants feature bits added to every draw item (e.g. CLUSTERED_LIGHTING)
+    Stats m_stats;
+    inline void nullify();
+
+    public:
+    SceneGraph() { nullify(); };
+
+    public:
+    size_t getNumNodes() const { return m_parent.size(); };
+    size_t getNumDrawItems() const { return m_drawItems.size(); };
+    const DrawItem& getDrawItem(size_t i) const { return m_drawItems[i]; };
+    const Stats& getStats() const { return m_stats; };
+    uint32_t getFeatures() const { return m_features; };
+    void setFeatures(uint32_t features) { m_features = features; };
+    const glm::mat4& getLocal(int handle) const { return m_local[m_handleToIndex[handle]]; };
+    const glm::mat4& getWorld(int handle) const { return m_world[m_handleToIndex[handle]]; };
+
+    int createNode(int, const glm::mat4&);
+    int addModel(const Model&, int, const glm::mat4&);
+    void removeNode(int);
+    void setLocal(int, const glm::mat4&);
+    void addDrawItem(const Mesh*, int);
+
+    void update();
+    void record(CommandBuffer&, const ShaderVariants&, const OcclusionCuller&, size_t, size_t) const;
+    static void benchmark(size_t, float);
+
+    private:
+    int insertNodes(int, size_t);
+    void updateRange(int, int);
+};
+
+inline void SceneGraph::nullify()
+{
+    std::vector<glm::mat4>().swap(m_local);
+    std::vector<glm::mat4>().swap(m_world);
+    std::vector<int>().swap(m_parent);
+    std::vector<int>().swap(m_subtreeEnd);
+    std::vector<uint8_t>().swap(m_dirty);
+    std::vector<int>().swap(m_indexToHandle);
+    std::vector<int>().swap(m_handleToIndex);
+    std::vector<DrawItem>().swap(m_drawItems);
+    m_features = 0;
+    m_stats = Stats();
+}
+
+#endif
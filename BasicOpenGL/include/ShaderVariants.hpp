@@ -0,0 +1,105 @@
+#ifndef _SHADER_VARIANTS_
+#define _SHADER_VARIANTS_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// opengl
+#include <glad/glad.h>
+
+// include
+#include <Log.hpp>
+#include <Shader.hpp>
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ==== shader variants class ====
+//
+// one set of GLSL files, compiled into one ShaderProgram per feature combination
+// a source declares the keywords it reacts to, anywhere in any stage:
+//
+// #pragma feature NORMAL_MAP
+// ...
+// #ifdef NORMAL_MAP
+//     N = TBN * (texture(normalMap0, TexCoord).rgb * 2.0 - 1.0);
+// #endif
+//
+// the variant for a feature mask gets "#define <keyword>" after #version for every bit that is set
+// bits the sources do not declare are ignored, so two masks that differ only in those share a variant
+// (e.g. a mesh with a specular map drawn with a shader that has no SPECULAR_MAP keyword)
+//
+// feature bits are global: the engine's keywords (enum FEATURE) come first,
+// other keywords get the next free bit the first time a source declares them
+//
+// e.g.)
+// ShaderVariants variants("mesh.vs", "mesh.fs", nullptr);
+// variants.precompileFromManifest("mesh.variants"); // optional, otherwise compiled on first use
+// variants.get(mesh.getFeatures()).use();
+
+class ShaderVariants
+{
+    public:
+    enum FEATURE
+    {
+        DIFFUSE_MAP,
+        SPECULAR_MAP,
+        NORMAL_MAP,
+        HEIGHT_MAP,
+        INSTANCED,
+        SKINNED,
+        CLUSTERED_LIGHTING,
+        NUM_FEATURES
+    };
+
+    private:
+    std::string m_vertShaderCode, m_fragShaderCode, m_geomShaderCode;
+    uint32_t m_declaredMask; // union of the keywords declared in the sources
+    std::unordered_map<uint32_t, ShaderProgram*> m_variants;
+    static std::vector<std::string> s_featureNames;
+    inline void nullify();
+
+    public:
+    ShaderVariants();
+    ShaderVariants(const char*, const char*, const char*);
+    ~ShaderVariants();
+
+    public:
+    static uint32_t getFeatureBit(const std::string&);
+    static uint32_t getFeatureMask(const std::string&);
+    uint32_t getDeclaredMask() const { return m_declaredMask; };
+    uint32_t getVariantKey(uint32_t mask) const { return mask & m_declaredMask; };
+    size_t getNumVariants() const { return m_variants.size(); };
+
+    void loadFromFile(const char*, const char*, const char*);
+    ShaderProgram& get(uint32_t);
+    const ShaderProgram* find(uint32_t) const;
+    void precompile(const std::vector<uint32_t>&);
+    void precompileFromManifest(const char*);
+
+    private:
+    void parseFeatures(const std::string&);
+    std::string getDefines(uint32_t) const;
+    ShaderProgram* compile(uint32_t, bool);
+    void clear();
+
+    private:
+    ShaderVariants(const ShaderVariants&) {};
+    ShaderVariants& operator=(const ShaderVariants&) { return *this; };
+};
+
+inline void ShaderVariants::nullify()
+{
+    m_vertShaderCode = m_fragShaderCode = m_geomShaderCode = "";
+    m_declaredMask = 0;
+    std::unordered_map<uint32_t, ShaderProgram*>().swap(m_variants);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _SIMD_
+#define _SIMD_
+
+// SIMD_SSE is defined when SSE2 intrinsics are available (every x86-64 build)
+// code using it must keep a scalar fallback for other targets
+// small helpers shared by several modules live here too
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE
+#include <emmintrin.h>
+#endif
+
+// out = a * b for column-major 4x4 float matrices (glm::mat4 layout)
+// out may alias b but not a
+inline void simdMulMat4(const float* a, const float* b, float* out)
+{
+#ifdef SIMD_SSE
+    __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+    for(int j = 0; j < 4; j++)
+    {
+        __m128 column = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b[j * 4])), _mm_mul_ps(a1, _mm_set1_ps(b[j * 4 + 1]))),
+            _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(b[j * 4 + 2])), _mm_mul_ps(a3, _mm_set1_ps(b[j * 4 + 3]))));
+        _mm_storeu_ps(out + j * 4, column);
+    }
+#else
+    for(int j = 0; j < 4; j++)
+    {
+        float b0 = b[j * 4], b1 = b[j * 4 + 1], b2 = b[j * 4 + 2], b3 = b[j * 4 + 3];
+        for(int i = 0; i < 4; i++) { out[j * 4 + i] = a[i] * b0 + a[4 + i] * b1 + a[8 + i] * b2 + a[12 + i] * b3; }
+    }
+#endif
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _SKINNING_BUFFER_
+#define _SKINNING_BUFFER_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// glm
+#include <glm/glm.hpp>
+
+// opengl
+#include <glad/glad.h>
+
+// include
+#include <Log.hpp>
+#include <Animation.hpp>
+#include <GLState.hpp>
+
+// std
+#include <cstring>
+#include <vector>
+
+// ==== skinning buffer class ====
+//
+// matrix palettes of many animators in one uniform buffer, one aligned slot per animator
+// the vertex shader reads the slot bound with bind():
+//
+// layout (std140) uniform Bones { mat4 bones[MAX_BONES]; };
+//
+// GLSL 3.30 has no layout(binding): register the block before the programs are linked
+// e.g.)
+// ShaderProgram::setUniformBlockBinding("Bones", SkinningBuffer::BINDING);
+// ...
+// skinning.upload(animators);                     // once per frame, after AnimationSystem::update()
+// skinning.bind(i); model.draw(shaderVariants);   // per character
+
+class SkinningBuffer
+{
+    public:
+    static const GLuint BINDING = 0;
+    static const int MAX_BONES = 128; // 8 KB per slot, the minimum GL_MAX_UNIFORM_BLOCK_SIZE is 16 KB
+
+    private:
+    GLuint m_UBO;
+    GLsizeiptr m_slotSize; // MAX_BONES * mat4 rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    GLsizeiptr m_capacity;
+    size_t m_numSlots;
+    std::vector<unsigned char> m_staging;
+    inline void nullify();
+
+    public:
+    SkinningBuffer() { nullify(); };
+    ~SkinningBuffer();
+
+    public:
+    size_t getNumSlots() { return m_numSlots; };
+    void upload(const std::vector<Animator*>&);
+    void bind(size_t);
+
+    private:
+    SkinningBuffer(const SkinningBuffer&) {};
+    SkinningBuffer& operator=(const SkinningBuffer&) { return *this; };
+};
+
+inline void SkinningBuffer::nullify()
+{
+    m_UBO = 0;
+    m_slotSize = m_capacity = 0;
+    m_numSlots = 0;
+    std::vector<unsigned char>().swap(m_staging);
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef _TANGENT_SPACE_
+#define _TANGENT_SPACE_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// glm
+#include <glm/glm.hpp>
+
+// include
+#include <Log.hpp>
+#include <Mesh.hpp>
+#include <JobSystem.hpp>
+
+// std
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+// ==== tangent space class ====
+//
+// replaces aiProcess_GenSmoothNormals and aiProcess_CalcTangentSpace; the heavy steps run on the JobSystem
+//
+// generateNormals(): smooth normals, area-weighted over the triangles around a position
+//   whose face normals are within the crease angle of the vertex's own triangle (assimp: AI_CONFIG_PP_GSN_MAX_SMOOTHING_ANGLE)
+// generateTangents(): MikkTSpace-compatible tangent frames
+//   - face tangents are projected onto the plane of the vertex normal and weighted by the corner angle
+//   - corners with the same position, normal and texCoord and the same texCoord handedness share one tangent
+//   - a vertex used with both handedness signs is split (vertices appended, indices remapped)
+//   - Vertex keeps its layout: tangent is the unit tangent, bitangent = sign * cross(normal, tangent),
+//     so a shader reconstructing the bitangent from the sign gets the same frame as a MikkTSpace baker
+//
+// both expect triangle lists (aiProcess_Triangulate) and are meant for meshes before VertexWelder::weld()
+// e.g.)
+// TangentSpace tangentSpace(175.0f);
+// if(!hasNormals) { tangentSpace.generateNormals(vertices, indices); }
+// if(hasNormalMap) { tangentSpace.generateTangents(vertices, indices); }
+
+class TangentSpace
+{
+    public:
+    struct Stats
+    {
+        size_t numVertices;      // input
+        size_t numTriangles;
+        size_t numSplitVertices; // appended by generateTangents()
+        double normalSeconds;
+        double tangentSeconds;
+    };
+
+    private:
+    static const size_t GRAIN = 4096;
+    static const uint32_t EMPTY = 0xFFFFFFFFu;
+
+    float m_cosCrease;
+    std::vector<glm::vec3> m_faceNormals;   // unit, per triangle
+    std::vector<glm::vec4> m_faceTangents;  // unit tangent, w: handedness (+1, -1), 0 for degenerate texCoords
+    std::vector<uint32_t> m_groups;         // per vertex or per corner
+    std::vector<uint32_t> m_offsets;        // CSR: group -> m_members
+    std::vector<uint32_t> m_members;
+    inline void nullify();
+
+    public:
+    TangentSpace();
+    TangentSpace(float);
+
+    public:
+    float getCreaseAngle() { return std::acos(m_cosCrease) * 57.2957795f; };
+    void setCreaseAngle(float);
+
+    Stats generateNormals(std::vector<Vertex>&, const std::vector<unsigned int>&, const std::vector<uint8_t>* = nullptr);
+    Stats generateTangents(std::vector<Vertex>&, std::vector<unsigned int>&, std::vector<unsigned int>* = nullptr);
+    static bool needsTangents(const std::vector<Texture>&);
+
+    private:
+    void computeFaceNormals(const std::vector<Vertex>&, const std::vector<unsigned int>&);
+    void computeFaceTangents(const std::vector<Vertex>&, const std::vector<unsigned int>&);
+    size_t groupBy(size_t, size_t, const std::function<void(size_t, uint32_t*)>&);
+    void buildMembers(size_t, const std::vector<uint32_t>&);
+
+    private:
+    TangentSpace(const TangentSpace&) {};
+    TangentSpace& operator=(const TangentSpace&) { return *this; };
+};
+
+inline void TangentSpace::nullify()
+{
+    m_cosCrease = -1.0f;
+    std::vector<glm::vec3>().swap(m_faceNormals);
+    std::vector<glm::vec4>().swap(m_faceTangents);
+    std::vector<uint32_t>().swap(m_groups);
+    std::vector<uint32_t>().swap(m_offsets);
+    std::vector<uint32_t>().swap(m_members);
+}
+
+#endif
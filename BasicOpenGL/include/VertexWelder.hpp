@@ -0,0 +1,77 @@
+#ifndef _VERTEX_WELDER_
+#define _VERTEX_WELDER_
+
+// spdlog
+#include <spdlog/spdlog.h>
+
+// include
+#include <Log.hpp>
+#include <Mesh.hpp>
+#include <JobSystem.hpp>
+
+// std
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// ==== vertex welder class ====
+//
+// merges duplicated Vertex records (e.g. one vertex per face corner from OBJ files) and remaps the index buffer
+// epsilon == 0: bitwise comparison of the whole Vertex
+// epsilon > 0: every attribute (position, normal, texCoord, tangent, bitangent) is snapped to a grid of size epsilon first
+
+class VertexWelder
+{
+    public:
+    struct Stats
+    {
+        size_t numVerticesIn;
+        size_t numVerticesOut;
+        double seconds;
+    };
+
+    private:
+    static const size_t NUM_WORDS = sizeof(Vertex) / sizeof(uint32_t);
+    static const uint32_t EMPTY = 0xFFFFFFFFu;
+    static const size_t GRAIN = 4096;
+
+    float m_epsilon;
+    std::vector<uint32_t> m_keys;   // NUM_WORDS words per vertex
+    std::vector<uint32_t> m_hashes;
+    std::vector<uint32_t> m_rep;    // representative (smallest equal) vertex index
+    inline void nullify();
+
+    public:
+    VertexWelder();
+    VertexWelder(float);
+
+    public:
+    float getEpsilon() { return m_epsilon; };
+    void setEpsilon(float epsilon) { m_epsilon = epsilon < 0.0f ? 0.0f : epsilon; };
+
+    Stats weld(std::vector<Vertex>&, std::vector<unsigned int>&);
+
+    private:
+    void makeKey(const Vertex&, uint32_t*);
+    bool equalKeys(uint32_t, uint32_t);
+
+    private:
+    VertexWelder(const VertexWelder&) {};
+    VertexWelder& operator=(const VertexWelder&) { return *this; };
+};
+
+static_assert(sizeof(Vertex) % sizeof(uint32_t) == 0, "Vertex must consist of 32-bit words");
+
+inline void VertexWelder::nullify()
+{
+    m_epsilon = 0.0f;
+    std::vector<uint32_t>().swap(m_keys);
+    std::vector<uint32_t>().swap(m_hashes);
+    std::vector<uint32_t>().swap(m_rep);
+}
+
+#endif
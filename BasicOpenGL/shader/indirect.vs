@@ -0,0 +1,29 @@
+#version 430 core
+/*
+struct Vertex, see mesh.vs
+GpuScene::draw(): one DrawElementsIndirectCommand per instance, baseInstance = instance index
+*/
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec3 aTangent;
+layout (location = 4) in vec3 aBitangent;
+layout (location = 7) in uint aInstance; // GpuScene::INSTANCE_ATTRIBUTE (divisor 1, reads element baseInstance)
+
+struct Instance
+{
+    mat4 world;
+    uint mesh;
+    uint pad0, pad1, pad2;
+};
+layout (std430, binding = 1) readonly buffer Instances { Instance instances[]; };
+
+out vec2 TexCoord;
+
+uniform mat4 viewProj = mat4(1.0);
+
+void main()
+{
+    gl_Position = viewProj * instances[aInstance].world * vec4(aPos, 1.0);
+    TexCoord = aTexCoord;
+}
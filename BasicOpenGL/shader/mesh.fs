@@ -1,12 +1,95 @@
 #version 330 core
+#pragma feature DIFFUSE_MAP
+#pragma feature CLUSTERED_LIGHTING
 
 in vec2 TexCoord;
 
 out vec4 FragColor;
 
+#ifdef DIFFUSE_MAP
 uniform sampler2D diffuseMap0;
+#endif
+
+#ifdef CLUSTERED_LIGHTING
+// clustered forward lighting, see ClusteredLighting.hpp
+in vec3 ViewPos;
+in vec3 ViewNormal;
+
+// lightData: 4 texels per light
+// (viewPos, radius) (color * intensity, type) (viewDir, cosOuter) (cosInner, 0, 0, 0)
+uniform samplerBuffer lightData;
+uniform usamplerBuffer clusterTable; // (offset, count) per cluster
+uniform usamplerBuffer lightIndices;
+
+uniform vec3 clusterDim;
+uniform vec2 clusterTileSize;
+uniform float clusterSliceScale;
+uniform float clusterSliceBias;
+
+uniform vec3 ambient = vec3(0.05);
+
+const float SPOT = 1.0;
+
+int clusterIndex()
+{
+    ivec3 dim = ivec3(clusterDim);
+    int x = clamp(int(gl_FragCoord.x / clusterTileSize.x), 0, dim.x - 1);
+    int y = clamp(int(gl_FragCoord.y / clusterTileSize.y), 0, dim.y - 1);
+    int z = clamp(int(log(-ViewPos.z) * clusterSliceScale + clusterSliceBias), 0, dim.z - 1);
+    return (z * dim.y + y) * dim.x + x;
+}
+
+vec3 shadeClustered(vec3 albedo)
+{
+    vec3 N = normalize(ViewNormal);
+    vec3 V = normalize(-ViewPos);
+    vec3 color = ambient * albedo;
+
+    // only the lights of this fragment's cluster
+    uvec2 cluster = texelFetch(clusterTable, clusterIndex()).xy;
+    for(uint i = 0u; i < cluster.y; i++)
+    {
+        int light = int(texelFetch(lightIndices, int(cluster.x + i)).x) * 4;
+        vec4 posRadius = texelFetch(lightData, light);
+        vec4 colorType = texelFetch(lightData, light + 1);
+
+        vec3 L = posRadius.xyz - ViewPos;
+        float dist = length(L);
+        if(dist >= posRadius.w) { continue; }
+        L /= dist;
+
+        // smooth window: 1 at the light, 0 at its radius
+        float falloff = clamp(1.0 - pow(dist / posRadius.w, 4.0), 0.0, 1.0);
+        float attenuation = falloff * falloff / (dist * dist + 1.0);
+
+        if(colorType.w == SPOT)
+        {
+            vec4 dirCosOuter = texelFetch(lightData, light + 2);
+            float cosInner = texelFetch(lightData, light + 3).x;
+            float cosAngle = dot(-L, normalize(dirCosOuter.xyz));
+            attenuation *= smoothstep(dirCosOuter.w, cosInner, cosAngle);
+        }
+
+        // Blinn-Phong
+        vec3 H = normalize(L + V);
+        float diffuse = max(dot(N, L), 0.0);
+        float specular = pow(max(dot(N, H), 0.0), 32.0) * 0.25;
+        color += (diffuse * albedo + specular) * colorType.rgb * attenuation;
+    }
+    return color;
+}
+#endif
 
 void main()
 {
-    FragColor = texture(diffuseMap0, TexCoord);
+#ifdef DIFFUSE_MAP
+    vec4 albedo = texture(diffuseMap0, TexCoord);
+#else
+    vec4 albedo = vec4(1.0);
+#endif
+#ifdef CLUSTERED_LIGHTING
+    FragColor = vec4(shadeClustered(albedo.rgb), albedo.a);
+#else
+    FragColor = albedo;
+#endif
 }
\ No newline at end of file
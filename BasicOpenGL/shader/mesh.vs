@@ -1,4 +1,6 @@
 #version 330 core
+#pragma feature SKINNED
+#pragma feature CLUSTERED_LIGHTING
 /*
 struct Vertex
 {
@@ -15,10 +17,46 @@ layout (location = 2) in vec2 aTexCoord;
 layout (location = 3) in vec3 aTangent;
 layout (location = 4) in vec3 aBitangent;
 
+#ifdef SKINNED
+// struct VertexBoneData, see SkinningBuffer.hpp
+layout (location = 5) in ivec4 aBoneIDs;
+layout (location = 6) in vec4 aBoneWeights;
+
+const int MAX_BONES = 128;
+layout (std140) uniform Bones { mat4 bones[MAX_BONES]; };
+#endif
+
 out vec2 TexCoord;
 
+uniform mat4 model = mat4(1.0); // SceneGraph world matrix
+
+#ifdef CLUSTERED_LIGHTING
+// lit in view space (see ClusteredLighting.hpp); without it there is no camera and model is the clip-space transform
+out vec3 ViewPos;
+out vec3 ViewNormal;
+
+uniform mat4 view = mat4(1.0);
+uniform mat4 projection = mat4(1.0);
+#endif
+
 void main()
 {
-    gl_Position = vec4(aPos, 1.0);
+    vec4 position = vec4(aPos, 1.0);
+    vec3 normal = aNormal;
+#ifdef SKINNED
+    mat4 skin = aBoneWeights.x * bones[aBoneIDs.x] + aBoneWeights.y * bones[aBoneIDs.y]
+              + aBoneWeights.z * bones[aBoneIDs.z] + aBoneWeights.w * bones[aBoneIDs.w];
+    position = skin * position;
+    normal = mat3(skin) * normal;
+#endif
+#ifdef CLUSTERED_LIGHTING
+    mat4 modelView = view * model;
+    vec4 viewPos = modelView * position;
+    gl_Position = projection * viewPos;
+    ViewPos = viewPos.xyz;
+    ViewNormal = mat3(transpose(inverse(modelView))) * normal;
+#else
+    gl_Position = model * position;
+#endif
     TexCoord = aTexCoord;
 }
\ No newline at end of file
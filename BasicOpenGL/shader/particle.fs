@@ -0,0 +1,13 @@
+#version 330 core
+in vec2 Corner;
+in vec4 Color;
+
+out vec4 FragColor;
+
+void main()
+{
+    // round, soft-edged sprite
+    float falloff = 1.0 - smoothstep(0.5, 1.0, length(Corner));
+    if(falloff <= 0.0) { discard; }
+    FragColor = vec4(Color.rgb, Color.a * falloff);
+}
@@ -0,0 +1,37 @@
+#version 330 core
+// ParticleSystem::draw(): one instance per particle slot, a camera-facing quad of 4 vertices (triangle strip)
+// dead slots collapse to a point outside the clip volume
+
+// ParticleSystem::Particle, per instance
+layout (location = 0) in vec4 aPositionAge;
+layout (location = 1) in vec4 aVelocityLife;
+
+out vec2 Corner;
+out vec4 Color;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec2 size;       // start, end (world units)
+uniform vec4 startColor;
+uniform vec4 endColor;
+
+void main()
+{
+    if(aPositionAge.w >= aVelocityLife.w)
+    {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        Corner = vec2(0.0);
+        Color = vec4(0.0);
+        return;
+    }
+
+    float t = aPositionAge.w / aVelocityLife.w;
+    Corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    Color = mix(startColor, endColor, t);
+
+    // camera right and up: rows of the view rotation
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    vec3 position = aPositionAge.xyz + (right * Corner.x + up * Corner.y) * (0.5 * mix(size.x, size.y, t));
+    gl_Position = projection * view * vec4(position, 1.0);
+}
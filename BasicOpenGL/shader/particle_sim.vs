@@ -0,0 +1,87 @@
+#version 330 core
+// ParticleSystem::update(): one invocation per particle slot, captured by transform feedback (no rasterization)
+// slots [head, head + numSpawned) (wrapping around capacity) are overwritten by this frame's emits,
+// every other slot is integrated; a slot with age >= life is dead and stays as it is
+
+// ParticleSystem::Particle
+layout (location = 0) in vec4 aPositionAge;  // xyz: position, w: age in seconds
+layout (location = 1) in vec4 aVelocityLife; // xyz: velocity, w: lifetime in seconds
+
+out vec4 outPositionAge;
+out vec4 outVelocityLife;
+
+// ParticleSystem::Emit, 3 texels per emit: (position, first), (velocity, spread), (radius, minLife, maxLife, 0)
+// first: index of the emit's first particle among this frame's spawns, ascending
+uniform samplerBuffer emits;
+uniform int numEmits;
+uniform int numSpawned;
+uniform int head;
+uniform int capacity;
+uniform uint seed;      // changes every frame
+uniform bool initialize; // first frame: the buffers hold garbage, every slot starts dead
+
+uniform float deltaTime;
+uniform vec3 gravity;
+uniform float drag;
+
+uint hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float random(inout uint state)
+{
+    state = hash(state);
+    return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+// uniform in the unit ball
+vec3 randomInSphere(inout uint state)
+{
+    float z = random(state) * 2.0 - 1.0;
+    float phi = random(state) * 6.2831853;
+    float r = pow(random(state), 1.0 / 3.0);
+    return r * vec3(sqrt(1.0 - z * z) * vec2(cos(phi), sin(phi)), z);
+}
+
+void main()
+{
+    int spawn = gl_VertexID - head;
+    if(spawn < 0) { spawn += capacity; }
+
+    if(spawn < numSpawned)
+    {
+        // last emit with first <= spawn
+        int low = 0, high = numEmits - 1;
+        while(low < high)
+        {
+            int middle = (low + high + 1) / 2;
+            if(int(texelFetch(emits, middle * 3).w) <= spawn) { low = middle; }
+            else { high = middle - 1; }
+        }
+        vec4 positionFirst = texelFetch(emits, low * 3);
+        vec4 velocitySpread = texelFetch(emits, low * 3 + 1);
+        vec4 radiusLife = texelFetch(emits, low * 3 + 2);
+
+        uint state = hash(uint(gl_VertexID) ^ seed);
+        outPositionAge = vec4(positionFirst.xyz + randomInSphere(state) * radiusLife.x, 0.0);
+        outVelocityLife = vec4(velocitySpread.xyz + randomInSphere(state) * velocitySpread.w, mix(radiusLife.y, radiusLife.z, random(state)));
+        return;
+    }
+
+    if(initialize || aPositionAge.w >= aVelocityLife.w)
+    {
+        outPositionAge = initialize ? vec4(0.0, 0.0, 0.0, 1.0) : aPositionAge;
+        outVelocityLife = initialize ? vec4(0.0) : aVelocityLife;
+        return;
+    }
+
+    vec3 velocity = (aVelocityLife.xyz + gravity * deltaTime) / (1.0 + drag * deltaTime);
+    outPositionAge = vec4(aPositionAge.xyz + velocity * deltaTime, aPositionAge.w + deltaTime);
+    outVelocityLife = vec4(velocity, aVelocityLife.w);
+}
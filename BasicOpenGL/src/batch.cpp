@@ -0,0 +1,163 @@
+#include <HeadlessContext.hpp>
+#include <BatchRenderer.hpp>
+#include <Shader.hpp>
+#include <Image.hpp>
+#include <Mesh.hpp>
+#include <Model.hpp>
+#include <SceneGraph.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+//headless batch mode: thumbnails and turntables of a list of models, no window or display needed
+//e.g.) ./basic_OpenGL_batch jobs.txt out 512 512
+//
+//jobs.txt, one model per line ('#' starts a comment):
+//<model path> [number of views around the model = 1] [camera elevation in degrees = 20]
+//../../resource/model/model.obj 36
+//
+//images are written to <out>/<job>_<model name>_<view>.png (job: line order, so the same model listed twice does not collide);
+//the output directory is created if missing
+
+struct BatchJob
+{
+	std::string modelPath;
+	int numViews;
+	float elevation;
+};
+
+static bool readJobs(const char* jobsPath, std::vector<BatchJob>& jobs)
+{
+	std::ifstream jobsFile(jobsPath);
+	std::string line;
+	if(!jobsFile.is_open()) { LOG_ERROR(ASSET, "no such job file \"{}\"", jobsPath); return false; }
+
+	while(std::getline(jobsFile, line))
+	{
+		size_t comment = line.find('#');
+		if(comment != std::string::npos) { line.erase(comment); }
+
+		std::istringstream lineSS(line);
+		BatchJob job;
+		job.numViews = 1;
+		job.elevation = 20.0f;
+		if(!(lineSS >> job.modelPath)) { continue; }
+		lineSS >> job.numViews >> job.elevation;
+		if(job.numViews < 1) { job.numViews = 1; }
+		jobs.push_back(job);
+	}
+	return true;
+}
+
+//e.g.) "../../resource/model/model.obj" -> "model"
+static std::string getModelName(const std::string& modelPath)
+{
+	size_t begin = modelPath.find_last_of("/\\");
+	begin = begin == std::string::npos ? 0 : begin + 1;
+	size_t end = modelPath.find_last_of('.');
+	return modelPath.substr(begin, end == std::string::npos || end < begin ? std::string::npos : end - begin);
+}
+
+int main(int argc, char** argv)
+{
+	Log::setLevels(getenv("LOG_LEVELS"));
+	if(argc < 3)
+	{
+		LOG_ERROR(CORE, "usage: {} <jobs file> <output directory> [width = 512] [height = width]", argv[0]);
+		return -1;
+	}
+	int width = argc > 3 ? atoi(argv[3]) : 512;
+	int height = argc > 4 ? atoi(argv[4]) : width;
+
+	std::vector<BatchJob> jobs;
+	if(!readJobs(argv[1], jobs)) { return -1; }
+
+	std::error_code error;
+	std::filesystem::create_directories(argv[2], error);
+	if(error) { LOG_ERROR(ASSET, "failed to create the output directory \"{}\": {}", argv[2], error.message()); return -1; }
+
+	HeadlessContext context;
+	if(!context.create()) { return -1; }
+
+	BatchRenderer batch;
+	if(!batch.init(width, height)) { return -1; }
+
+	//e.g.) ASSET_PACK=assets.pak ./basic_OpenGL_batch jobs.txt out
+	if(getenv("ASSET_PACK")) { FileSystem::instance().mount(getenv("ASSET_PACK")); }
+	ShaderProgram::setUniformBlockBinding("Bones", SkinningBuffer::BINDING);
+	ShaderVariants meshShaders("../../shader/mesh.vs", "../../shader/mesh.fs", nullptr);
+	meshShaders.precompileFromManifest("../../shader/mesh.variants");
+	Image::setFlipVerticallyOnLoad(true);
+	glEnable(GL_DEPTH_TEST);
+
+	//no occluders: the culler only rejects meshes outside the view
+	OcclusionCuller culler;
+	CommandBuffer commandBuffer;
+	SkinningBuffer skinning;
+	glm::mat4 identity(1.0f);
+	culler.beginFrame(identity);
+	culler.rasterize();
+
+	for(size_t i = 0; i < jobs.size(); i++)
+	{
+		Model model(jobs[i].modelPath.c_str());
+		if(model.getMeshes().empty()) { LOG_ERROR(ASSET, "skip \"{}\": no meshes", jobs[i].modelPath); continue; }
+		meshShaders.precompile(model.getFeatureMasks());
+
+		//orbit camera around the bounding sphere of the meshes
+		glm::vec3 boundsMin = model.getMeshes()[0]->getBoundsMin(), boundsMax = model.getMeshes()[0]->getBoundsMax();
+		for(size_t j = 1; j < model.getMeshes().size(); j++)
+		{
+			boundsMin = glm::min(boundsMin, model.getMeshes()[j]->getBoundsMin());
+			boundsMax = glm::max(boundsMax, model.getMeshes()[j]->getBoundsMax());
+		}
+		glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+		float radius = std::max(glm::length(boundsMax - boundsMin) * 0.5f, 1e-3f);
+		float distance = radius / std::sin(glm::radians(22.5f)) * 1.1f; //fits the 45 degree field of view
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(width) / height, distance - radius * 1.5f, distance + radius * 1.5f);
+
+		//the shaders have no camera uniform: the instance root carries viewProj, so world = viewProj * model
+		SceneGraph graph;
+		int root = graph.addModel(model, -1, identity);
+		char prefix[16];
+		snprintf(prefix, sizeof(prefix), "%03zu_", i);
+		std::string name = prefix + getModelName(jobs[i].modelPath);
+
+		//skinned meshes: first frame of the first clip, bind pose without clips
+		if(model.getSkeleton().getNumBones())
+		{
+			Animator animator(model.getSkeleton());
+			if(model.getClips().size()) { animator.play(0, &model.getClips()[0]); }
+			animator.update(0.0f);
+			skinning.upload(std::vector<Animator*>(1, &animator));
+			skinning.bind(0);
+		}
+
+		for(int view = 0; view < jobs[i].numViews; view++)
+		{
+			float azimuth = glm::radians(360.0f * view / jobs[i].numViews), elevation = glm::radians(jobs[i].elevation);
+			glm::vec3 eye = center + distance * glm::vec3(std::cos(elevation) * std::sin(azimuth), std::sin(elevation), std::cos(elevation) * std::cos(azimuth));
+			graph.setLocal(root, projection * glm::lookAt(eye, center, glm::vec3(0.0f, 1.0f, 0.0f)));
+			graph.update();
+
+			commandBuffer.clear();
+			graph.record(commandBuffer, meshShaders, culler, 0, graph.getNumDrawItems());
+
+			ResidencyManager::instance().beginFrame();
+			batch.beginImage();
+			commandBuffer.execute();
+			GLState::instance().endFrame();
+
+			char suffix[16];
+			snprintf(suffix, sizeof(suffix), "_%03d.png", view);
+			batch.endImage(std::string(argv[2]) + "/" + name + suffix);
+		}
+		//the model can go while its last readbacks are in flight: GL deletes objects only once pending commands are done
+	}
+
+	batch.finish();
+	return 0;
+}
@@ -0,0 +1,378 @@
+// include
+#include <Animation.hpp>
+
+// ---- pose ----
+
+void Pose::resize(size_t n)
+{
+    numNodes = n;
+    stride = (n + 3) & ~static_cast<size_t>(3);
+    data.assign(NUM_STREAMS * stride, 0.0f);
+    for(size_t i = 0; i < stride; i++) { stream(QW)[i] = stream(SX)[i] = stream(SY)[i] = stream(SZ)[i] = 1.0f; } // identity in the padding too
+}
+
+// out = lerp(a, b, weight), rotations take the shortest path and are renormalized (nlerp)
+// out may alias a or b
+void Pose::blend(const Pose& a, const Pose& b, float weight, Pose& out)
+{
+    if(out.stride != a.stride) { out.resize(a.numNodes); }
+
+    for(size_t i = 0; i < a.stride; i += 4)
+    {
+#ifdef SIMD_SSE
+        __m128 w = _mm_set1_ps(weight);
+        __m128 dot = _mm_setzero_ps();
+        for(int s = QX; s <= QW; s++) { dot = _mm_add_ps(dot, _mm_mul_ps(_mm_loadu_ps(a.stream(s) + i), _mm_loadu_ps(b.stream(s) + i))); }
+        __m128 signMask = _mm_and_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()), _mm_set1_ps(-0.0f)); // flip b where dot < 0
+
+        for(int s = 0; s < NUM_STREAMS; s++)
+        {
+            __m128 va = _mm_loadu_ps(a.stream(s) + i);
+            __m128 vb = _mm_loadu_ps(b.stream(s) + i);
+            if(s >= QX && s <= QW) { vb = _mm_xor_ps(vb, signMask); }
+            _mm_storeu_ps(out.stream(s) + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), w)));
+        }
+#else
+        for(size_t j = i; j < i + 4; j++)
+        {
+            float dot = 0.0f;
+            for(int s = QX; s <= QW; s++) { dot += a.stream(s)[j] * b.stream(s)[j]; }
+            for(int s = 0; s < NUM_STREAMS; s++)
+            {
+                float vb = (s >= QX && s <= QW && dot < 0.0f) ? -b.stream(s)[j] : b.stream(s)[j];
+                out.stream(s)[j] = a.stream(s)[j] + (vb - a.stream(s)[j]) * weight;
+            }
+        }
+#endif
+    }
+    out.normalizeRotations();
+}
+
+void Pose::normalizeRotations()
+{
+    if(!stride) { return; }
+
+    float* qx = stream(QX);
+    float* qy = stream(QY);
+    float* qz = stream(QZ);
+    float* qw = stream(QW);
+
+    for(size_t i = 0; i < stride; i += 4)
+    {
+#ifdef SIMD_SSE
+        __m128 x = _mm_loadu_ps(qx + i), y = _mm_loadu_ps(qy + i), z = _mm_loadu_ps(qz + i), w = _mm_loadu_ps(qw + i);
+        __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+        __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(lengthSq, _mm_set1_ps(1e-12f))));
+        _mm_storeu_ps(qx + i, _mm_mul_ps(x, invLength));
+        _mm_storeu_ps(qy + i, _mm_mul_ps(y, invLength));
+        _mm_storeu_ps(qz + i, _mm_mul_ps(z, invLength));
+        _mm_storeu_ps(qw + i, _mm_mul_ps(w, invLength));
+#else
+        for(size_t j = i; j < i + 4; j++)
+        {
+            float invLength = 1.0f / std::sqrt(std::max(qx[j] * qx[j] + qy[j] * qy[j] + qz[j] * qz[j] + qw[j] * qw[j], 1e-12f));
+            qx[j] *= invLength; qy[j] *= invLength; qz[j] *= invLength; qw[j] *= invLength;
+        }
+#endif
+    }
+}
+
+// return: -1 if there is no such node
+int Skeleton::findNode(const std::string& name) const
+{
+    std::unordered_map<std::string, int>::const_iterator it = m_nodeIndices.find(name);
+    return it == m_nodeIndices.end() ? -1 : it->second;
+}
+
+// return: -1 if there is no such bone
+int Skeleton::findBone(const std::string& name) const
+{
+    std::unordered_map<std::string, int>::const_iterator it = m_boneIndices.find(name);
+    return it == m_boneIndices.end() ? -1 : it->second;
+}
+
+// nodes must be added in depth-first preorder (parent < index)
+// return: node index
+int Skeleton::addNode(const std::string& name, int parent, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+{
+    int index = static_cast<int>(m_parents.size());
+    Pose bindPose = m_bindPose;
+
+    m_nodeNames.push_back(name);
+    m_parents.push_back(parent);
+    m_nodeIndices[name] = index;
+
+    m_bindPose.resize(m_parents.size());
+    for(int s = 0; s < Pose::NUM_STREAMS; s++)
+    {
+        for(size_t i = 0; i < bindPose.numNodes; i++) { m_bindPose.stream(s)[i] = bindPose.stream(s)[i]; }
+    }
+    m_bindPose.stream(Pose::TX)[index] = translation.x;
+    m_bindPose.stream(Pose::TY)[index] = translation.y;
+    m_bindPose.stream(Pose::TZ)[index] = translation.z;
+    m_bindPose.stream(Pose::QX)[index] = rotation.x;
+    m_bindPose.stream(Pose::QY)[index] = rotation.y;
+    m_bindPose.stream(Pose::QZ)[index] = rotation.z;
+    m_bindPose.stream(Pose::QW)[index] = rotation.w;
+    m_bindPose.stream(Pose::SX)[index] = scale.x;
+    m_bindPose.stream(Pose::SY)[index] = scale.y;
+    m_bindPose.stream(Pose::SZ)[index] = scale.z;
+    return index;
+}
+
+// bones are shared by name across meshes; the first offset matrix wins
+// return: bone index (palette index), -1 if the node does not exist
+int Skeleton::addBone(const std::string& name, const glm::mat4& offset)
+{
+    int bone = findBone(name);
+    if(bone >= 0) { return bone; }
+
+    int node = findNode(name);
+    if(node < 0) { LOG_WARN(ANIMATION, "bone \"{}\" has no node", name); return -1; }
+
+    bone = static_cast<int>(m_boneNodes.size());
+    m_boneNodes.push_back(node);
+    m_boneOffsets.push_back(offset);
+    m_boneIndices[name] = bone;
+    return bone;
+}
+
+// pose -> local matrices (SSE, 4 nodes at a time) -> global matrices (preorder walk) -> palette
+// globals: scratch, one matrix per node
+void Skeleton::computePalette(const Pose& pose, std::vector<glm::mat4>& globals, std::vector<glm::mat4>& palette) const
+{
+    size_t numNodes = m_parents.size();
+
+    globals.resize(pose.stride);
+    palette.resize(m_boneNodes.size());
+
+    // local TRS -> matrix: M = T * R * S
+    for(size_t i = 0; i < pose.stride; i += 4)
+    {
+        float r[9][4], t[3][4];
+#ifdef SIMD_SSE
+        __m128 x = _mm_loadu_ps(pose.stream(Pose::QX) + i), y = _mm_loadu_ps(pose.stream(Pose::QY) + i);
+        __m128 z = _mm_loadu_ps(pose.stream(Pose::QZ) + i), w = _mm_loadu_ps(pose.stream(Pose::QW) + i);
+        __m128 sx = _mm_loadu_ps(pose.stream(Pose::SX) + i), sy = _mm_loadu_ps(pose.stream(Pose::SY) + i), sz = _mm_loadu_ps(pose.stream(Pose::SZ) + i);
+        __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+        __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+        __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+        __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+        // r[column * 3 + row], columns scaled by s
+        _mm_storeu_ps(r[0], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx));
+        _mm_storeu_ps(r[1], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx));
+        _mm_storeu_ps(r[2], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx));
+        _mm_storeu_ps(r[3], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy));
+        _mm_storeu_ps(r[4], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy));
+        _mm_storeu_ps(r[5], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy));
+        _mm_storeu_ps(r[6], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz));
+        _mm_storeu_ps(r[7], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz));
+        _mm_storeu_ps(r[8], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz));
+        _mm_storeu_ps(t[0], _mm_loadu_ps(pose.stream(Pose::TX) + i));
+        _mm_storeu_ps(t[1], _mm_loadu_ps(pose.stream(Pose::TY) + i));
+        _mm_storeu_ps(t[2], _mm_loadu_ps(pose.stream(Pose::TZ) + i));
+#else
+        for(int k = 0; k < 4; k++)
+        {
+            float x = pose.stream(Pose::QX)[i + k], y = pose.stream(Pose::QY)[i + k], z = pose.stream(Pose::QZ)[i + k], w = pose.stream(Pose::QW)[i + k];
+            float sx = pose.stream(Pose::SX)[i + k], sy = pose.stream(Pose::SY)[i + k], sz = pose.stream(Pose::SZ)[i + k];
+            r[0][k] = (1.0f - 2.0f * (y * y + z * z)) * sx;
+            r[1][k] = 2.0f * (x * y + w * z) * sx;
+            r[2][k] = 2.0f * (x * z - w * y) * sx;
+            r[3][k] = 2.0f * (x * y - w * z) * sy;
+            r[4][k] = (1.0f - 2.0f * (x * x + z * z)) * sy;
+            r[5][k] = 2.0f * (y * z + w * x) * sy;
+            r[6][k] = 2.0f * (x * z + w * y) * sz;
+            r[7][k] = 2.0f * (y * z - w * x) * sz;
+            r[8][k] = (1.0f - 2.0f * (x * x + y * y)) * sz;
+            t[0][k] = pose.stream(Pose::TX)[i + k];
+            t[1][k] = pose.stream(Pose::TY)[i + k];
+            t[2][k] = pose.stream(Pose::TZ)[i + k];
+        }
+#endif
+        for(int k = 0; k < 4; k++)
+        {
+            glm::mat4& m = globals[i + k];
+            m[0][0] = r[0][k]; m[0][1] = r[1][k]; m[0][2] = r[2][k]; m[0][3] = 0.0f;
+            m[1][0] = r[3][k]; m[1][1] = r[4][k]; m[1][2] = r[5][k]; m[1][3] = 0.0f;
+            m[2][0] = r[6][k]; m[2][1] = r[7][k]; m[2][2] = r[8][k]; m[2][3] = 0.0f;
+            m[3][0] = t[0][k]; m[3][1] = t[1][k]; m[3][2] = t[2][k]; m[3][3] = 1.0f;
+        }
+    }
+
+    // local -> global in place: parents come first
+    for(size_t i = 0; i < numNodes; i++)
+    {
+        if(m_parents[i] >= 0) { simdMulMat4(&globals[m_parents[i]][0][0], &globals[i][0][0], &globals[i][0][0]); }
+    }
+
+    for(size_t i = 0; i < m_boneNodes.size(); i++) { palette[i] = m_globalInverse * globals[m_boneNodes[i]] * m_boneOffsets[i]; }
+}
+
+// every frame starts as the bind pose (nodes without a channel keep it)
+// frames cover [0, duration] inclusive
+void AnimationClip::init(const std::string& name, float duration, float sampleRate, const Skeleton& skeleton)
+{
+    const Pose& bindPose = skeleton.getBindPose();
+
+    nullify();
+    m_name = name;
+    m_duration = duration;
+    m_sampleRate = sampleRate;
+    m_numFrames = static_cast<size_t>(std::ceil(duration * sampleRate)) + 1;
+    m_numNodes = bindPose.numNodes;
+    m_stride = bindPose.stride;
+
+    m_frames.resize(m_numFrames * Pose::NUM_STREAMS * m_stride);
+    for(size_t f = 0; f < m_numFrames; f++) { std::copy(bindPose.data.begin(), bindPose.data.end(), m_frames.begin() + f * Pose::NUM_STREAMS * m_stride); }
+}
+
+void AnimationClip::setKey(size_t frame, int node, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+{
+    float* base = &m_frames[frame * Pose::NUM_STREAMS * m_stride + node];
+    base[Pose::TX * m_stride] = translation.x;
+    base[Pose::TY * m_stride] = translation.y;
+    base[Pose::TZ * m_stride] = translation.z;
+    base[Pose::QX * m_stride] = rotation.x;
+    base[Pose::QY * m_stride] = rotation.y;
+    base[Pose::QZ * m_stride] = rotation.z;
+    base[Pose::QW * m_stride] = rotation.w;
+    base[Pose::SX * m_stride] = scale.x;
+    base[Pose::SY * m_stride] = scale.y;
+    base[Pose::SZ * m_stride] = scale.z;
+}
+
+// keep consecutive rotations in the same hemisphere, so sample() can lerp without a sign test
+void AnimationClip::finalize()
+{
+    size_t frameSize = Pose::NUM_STREAMS * m_stride;
+    for(size_t f = 1; f < m_numFrames; f++)
+    {
+        const float* prev = &m_frames[(f - 1) * frameSize];
+        float* curr = &m_frames[f * frameSize];
+        for(size_t n = 0; n < m_stride; n++)
+        {
+            float dot = 0.0f;
+            for(int s = Pose::QX; s <= Pose::QW; s++) { dot += prev[s * m_stride + n] * curr[s * m_stride + n]; }
+            if(dot < 0.0f)
+            {
+                for(int s = Pose::QX; s <= Pose::QW; s++) { curr[s * m_stride + n] = -curr[s * m_stride + n]; }
+            }
+        }
+    }
+}
+
+// time: seconds; loop wraps it into [0, duration), otherwise it is clamped
+void AnimationClip::sample(float time, bool loop, Pose& out) const
+{
+    // local vars
+    float frame, alpha;
+    size_t f0, f1, frameSize;
+
+    if(!m_numFrames) { return; }
+    if(out.stride != m_stride) { out.resize(m_numNodes); }
+
+    if(loop && m_duration > 0.0f) { time = std::fmod(time, m_duration); if(time < 0.0f) { time += m_duration; } }
+    frame = std::min(std::max(time * m_sampleRate, 0.0f), static_cast<float>(m_numFrames - 1));
+    f0 = static_cast<size_t>(frame);
+    f1 = std::min(f0 + 1, m_numFrames - 1);
+    alpha = frame - static_cast<float>(f0);
+
+    // all streams are contiguous: one lerp over NUM_STREAMS * stride floats
+    frameSize = Pose::NUM_STREAMS * m_stride;
+    const float* a = &m_frames[f0 * frameSize];
+    const float* b = &m_frames[f1 * frameSize];
+    float* dst = &out.data[0];
+#ifdef SIMD_SSE
+    __m128 w = _mm_set1_ps(alpha);
+    for(size_t i = 0; i < frameSize; i += 4)
+    {
+        __m128 va = _mm_loadu_ps(a + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), va), w)));
+    }
+#else
+    for(size_t i = 0; i < frameSize; i++) { dst[i] = a[i] + (b[i] - a[i]) * alpha; }
+#endif
+    out.normalizeRotations();
+}
+
+Animator::Animator(const Skeleton& skeleton)
+{
+    nullify();
+    setSkeleton(skeleton);
+}
+
+void Animator::setSkeleton(const Skeleton& skeleton)
+{
+    m_skeleton = &skeleton;
+    m_pose = skeleton.getBindPose();
+    m_poses[0] = m_poses[1] = m_pose;
+    m_palette.assign(skeleton.getNumBones(), glm::mat4(1.0f));
+}
+
+// layer: 0 or 1, blended by setBlend()
+void Animator::play(int layer, const AnimationClip* clip, float time)
+{
+    m_clips[layer] = clip;
+    m_times[layer] = time;
+}
+
+// advance the clips by dt seconds and rebuild the palette
+// no GL call: safe to call from worker threads (one thread per animator)
+void Animator::update(float dt)
+{
+    if(!m_skeleton) { return; }
+
+    for(int layer = 0; layer < 2; layer++)
+    {
+        m_times[layer] += dt;
+        if(m_clips[layer]) { m_clips[layer]->sample(m_times[layer], true, m_poses[layer]); }
+    }
+
+    if(m_clips[0] && m_clips[1]) { Pose::blend(m_poses[0], m_poses[1], m_blend, m_pose); }
+    else if(m_clips[0]) { m_pose = m_poses[0]; }
+    else if(m_clips[1]) { m_pose = m_poses[1]; }
+    else { m_pose = m_skeleton->getBindPose(); }
+
+    m_skeleton->computePalette(m_pose, m_globals, m_palette);
+}
+
+// ---- animation system ----
+
+AnimationSystem::Stats AnimationSystem::update(std::vector<Animator*>& animators, float dt)
+{
+    Stats stats;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    JobSystem::instance().parallelFor(animators.size(), 16, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++) { animators[i]->update(dt); }
+    });
+
+    stats.numCharacters = animators.size();
+    stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+// pose evaluation throughput: numCharacters animators playing clip (blended with itself at an offset) for numFrames frames
+void AnimationSystem::benchmark(const Skeleton& skeleton, const AnimationClip& clip, size_t numCharacters, int numFrames)
+{
+    std::vector<Animator> animators(numCharacters);
+    std::vector<Animator*> pointers(numCharacters);
+    double ms = 0.0;
+
+    for(size_t i = 0; i < numCharacters; i++)
+    {
+        animators[i].setSkeleton(skeleton);
+        animators[i].play(0, &clip, 0.01f * i);
+        animators[i].play(1, &clip, 0.5f * clip.getDuration() + 0.01f * i);
+        animators[i].setBlend(0.3f);
+        pointers[i] = &animators[i];
+    }
+    for(int f = 0; f < numFrames; f++) { ms += update(pointers, 1.0f / 60.0f).ms; }
+
+    LOG_INFO(ANIMATION, "animation benchmark: {} characters, {} nodes, {} bones: {:.3f} ms/frame, {:.1f} characters/ms ({} threads)",
+        numCharacters, skeleton.getNumNodes(), skeleton.getNumBones(), ms / numFrames,
+        ms > 0.0 ? numCharacters * numFrames / ms : 0.0, JobSystem::instance().getNumWorkers() + 1);
+}
@@ -0,0 +1,183 @@
+// stb
+#include <stb/stb_image_write.h>
+
+// include
+#include <BatchRenderer.hpp>
+
+BatchRenderer::~BatchRenderer()
+{
+    if(m_FBO)
+    {
+        if(m_numPending || m_encoders.size()) { finish(); }
+        release();
+    }
+}
+
+// width x height RGBA8 color + 24-bit depth, ringSize PBOs of width * height * 4 bytes
+bool BatchRenderer::init(int width, int height, size_t ringSize)
+{
+    LOG_INFO(RENDER, "BatchRenderer::init({}, {}, {})", width, height, ringSize);
+
+    // delete existing targets
+    if(m_FBO)
+    {
+        LOG_WARN(RENDER, "delete existing batch renderer (FBO={})", m_FBO);
+        finish();
+        release();
+    }
+    if(width <= 0 || height <= 0 || ringSize == 0) { LOG_ERROR(RENDER, "wrong image size or ring size"); return false; }
+    m_width = width;
+    m_height = height;
+
+    // render targets
+    glGenFramebuffers(1, &m_FBO);
+    glGenRenderbuffers(1, &m_colorRBO);
+    glGenRenderbuffers(1, &m_depthRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorRBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRBO);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG_ERROR(RENDER, "incomplete offscreen framebuffer");
+        release();
+        return false;
+    }
+
+    // readback ring
+    m_ring.resize(ringSize);
+    for(size_t i = 0; i < ringSize; i++)
+    {
+        glGenBuffers(1, &m_ring[i].PBO);
+        GLState::instance().bindBuffer(GL_PIXEL_PACK_BUFFER, m_ring[i].PBO);
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width) * height * 4, nullptr, GL_STREAM_READ);
+        m_ring[i].fence = 0;
+    }
+    GLState::instance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_start = std::chrono::steady_clock::now();
+    return true;
+}
+
+// bind the offscreen framebuffer and clear it
+void BatchRenderer::beginImage()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+    glViewport(0, 0, m_width, m_height);
+    glClearColor(0.25f, 0.25f, 0.25f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+// queue the readback of the image drawn since beginImage(); the PNG is written to path later
+void BatchRenderer::endImage(const std::string& path)
+{
+    if(!m_FBO) { LOG_ERROR(RENDER, "BatchRenderer::endImage(): not initialized"); return; }
+
+    // ring full: the oldest readback has to finish first
+    if(m_numPending == m_ring.size()) { retire(true); }
+
+    Slot& slot = m_ring[(m_head + m_numPending) % m_ring.size()];
+    GLState::instance().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr); // returns at once, the copy runs on the GPU
+    GLState::instance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.path = path;
+    glFlush(); // the fence must reach the GPU, or polling it never succeeds
+    m_numPending++;
+    m_stats.numImages++;
+
+    // collect whatever has finished meanwhile, without waiting
+    while(m_numPending)
+    {
+        GLenum status = glClientWaitSync(m_ring[m_head].fence, 0, 0);
+        if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) { break; }
+        retire(false);
+    }
+}
+
+// wait for every readback and PNG file
+void BatchRenderer::finish()
+{
+    while(m_numPending) { retire(true); }
+    while(m_encoders.size())
+    {
+        m_encoders.front().wait();
+        m_encoders.pop_front();
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    m_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    m_stats.imagesPerSecond = m_stats.seconds > 0.0 ? m_stats.numImages / m_stats.seconds : 0.0;
+    if(m_stats.numImages)
+    {
+        LOG_INFO(RENDER, "batch render: {} images ({}x{}) in {:.3f} s, {:.1f} images/s, {} readback stalls ({:.3f} ms)",
+            m_stats.numImages, m_width, m_height, m_stats.seconds, m_stats.imagesPerSecond, m_stats.numStalls, m_stats.waitMs);
+    }
+}
+
+// map the oldest PBO, copy it out (bottom-up rows flipped) and hand it to a worker for encoding
+// wait: block until its fence signals
+void BatchRenderer::retire(bool wait)
+{
+    Slot& slot = m_ring[m_head];
+    size_t rowBytes = static_cast<size_t>(m_width) * 4;
+
+    if(wait && glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while(glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+        m_stats.numStalls++;
+        m_stats.waitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = 0;
+
+    std::shared_ptr<std::vector<unsigned char>> pixels = std::make_shared<std::vector<unsigned char>>(rowBytes * m_height);
+    GLState::instance().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+    const unsigned char* mapped = static_cast<const unsigned char*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rowBytes * m_height, GL_MAP_READ_BIT));
+    if(mapped)
+    {
+        for(int y = 0; y < m_height; y++) { memcpy(&(*pixels)[y * rowBytes], mapped + (m_height - 1 - y) * rowBytes, rowBytes); }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else { LOG_ERROR(RENDER, "failed to map readback buffer for \"{}\"", slot.path); }
+    GLState::instance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_head = (m_head + 1) % m_ring.size();
+    m_numPending--;
+    if(!mapped) { return; }
+
+    // bound the memory held by images waiting for a worker
+    while(m_encoders.size() > 2 * (JobSystem::instance().getNumWorkers() + 1))
+    {
+        m_encoders.front().wait();
+        m_encoders.pop_front();
+    }
+
+    std::string path = slot.path;
+    int width = m_width, height = m_height;
+    m_encoders.push_back(JobSystem::instance().async([pixels, path, width, height]()
+    {
+        if(!stbi_write_png(path.c_str(), width, height, 4, &(*pixels)[0], width * 4)) { LOG_ERROR(RENDER, "failed to write \"{}\"", path); }
+    }));
+}
+
+void BatchRenderer::release()
+{
+    for(size_t i = 0; i < m_ring.size(); i++)
+    {
+        if(m_ring[i].fence) { glDeleteSync(m_ring[i].fence); }
+        if(m_ring[i].PBO) { GLState::instance().deleteBuffers(1, &m_ring[i].PBO); }
+    }
+    if(m_FBO) { glDeleteFramebuffers(1, &m_FBO); }
+    if(m_colorRBO) { glDeleteRenderbuffers(1, &m_colorRBO); }
+    if(m_depthRBO) { glDeleteRenderbuffers(1, &m_depthRBO); }
+    nullify();
+}
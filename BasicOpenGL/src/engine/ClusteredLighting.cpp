@@ -0,0 +1,252 @@
+// include
+#include <ClusteredLighting.hpp>
+
+ClusteredLighting::ClusteredLighting()
+{
+    nullify();
+    m_dimX = 16; m_dimY = 9; m_dimZ = 24;
+}
+
+// e.g.) ClusteredLighting lighting(16, 9, 24);
+ClusteredLighting::ClusteredLighting(int dimX, int dimY, int dimZ)
+{
+    nullify();
+    m_dimX = std::max(1, dimX);
+    m_dimY = std::max(1, dimY);
+    m_dimZ = std::max(1, dimZ);
+}
+
+ClusteredLighting::~ClusteredLighting() { destroyBuffers(); }
+
+// must match the projection matrix used for rendering (glm::perspective(fovY, aspect, zNear, zFar))
+// call again when the window is resized
+void ClusteredLighting::setProjection(float fovY, float aspect, float zNear, float zFar)
+{
+    float tanHalfY = std::tan(fovY * 0.5f);
+    float tanHalfX = tanHalfY * aspect;
+
+    m_near = zNear;
+    m_far = zFar;
+    m_clusterBounds.resize(static_cast<size_t>(m_dimX) * m_dimY * m_dimZ);
+    m_sliceIndices.resize(m_dimZ);
+
+    for(int z = 0; z < m_dimZ; z++)
+    {
+        // exponential slicing: depth(z) = near * (far / near) ^ (z / dimZ)
+        float d0 = zNear * std::pow(zFar / zNear, static_cast<float>(z) / m_dimZ);
+        float d1 = zNear * std::pow(zFar / zNear, static_cast<float>(z + 1) / m_dimZ);
+
+        for(int y = 0; y < m_dimY; y++)
+        {
+            float ny0 = -1.0f + 2.0f * y / m_dimY, ny1 = -1.0f + 2.0f * (y + 1) / m_dimY;
+            for(int x = 0; x < m_dimX; x++)
+            {
+                float nx0 = -1.0f + 2.0f * x / m_dimX, nx1 = -1.0f + 2.0f * (x + 1) / m_dimX;
+
+                // tile corners on the near and far plane of the slice (view space looks down -z)
+                ClusterBounds& bounds = m_clusterBounds[(static_cast<size_t>(z) * m_dimY + y) * m_dimX + x];
+                bounds.boundsMin = glm::vec3(1e30f);
+                bounds.boundsMax = glm::vec3(-1e30f);
+                float depths[2] = { d0, d1 };
+                for(int k = 0; k < 2; k++)
+                {
+                    glm::vec3 p0(nx0 * tanHalfX * depths[k], ny0 * tanHalfY * depths[k], -depths[k]);
+                    glm::vec3 p1(nx1 * tanHalfX * depths[k], ny1 * tanHalfY * depths[k], -depths[k]);
+                    bounds.boundsMin = glm::min(bounds.boundsMin, glm::min(p0, p1));
+                    bounds.boundsMax = glm::max(bounds.boundsMax, glm::max(p0, p1));
+                }
+            }
+        }
+    }
+}
+
+// assign lights to clusters (CPU only, no GL call)
+// view: world -> view matrix of the camera
+void ClusteredLighting::update(const std::vector<Light>& lights, const glm::mat4& view)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    JobSystem& jobs = JobSystem::instance();
+    size_t numLights = lights.size();
+
+    if(m_clusterBounds.empty()) { LOG_ERROR(RENDER, "ClusteredLighting::update(): call setProjection() first"); return; }
+
+    // view-space lights, padded to a multiple of 4 with zero-radius spheres far behind the camera
+    size_t padded = (numLights + 3) & ~static_cast<size_t>(3);
+    m_lightX.assign(padded, 0.0f);
+    m_lightY.assign(padded, 0.0f);
+    m_lightZ.assign(padded, 1e30f);
+    m_lightRadius.assign(padded, 0.0f);
+    m_lightData.resize(numLights * 4);
+    jobs.parallelFor(numLights, 1024, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            const Light& light = lights[i];
+            glm::vec3 p = glm::vec3(view * glm::vec4(light.position, 1.0f));
+            glm::vec3 d = glm::vec3(view * glm::vec4(light.direction, 0.0f));
+            m_lightX[i] = p.x;
+            m_lightY[i] = p.y;
+            m_lightZ[i] = p.z;
+            m_lightRadius[i] = light.radius;
+            m_lightData[i * 4 + 0] = glm::vec4(p, light.radius);
+            m_lightData[i * 4 + 1] = glm::vec4(light.color * light.intensity, static_cast<float>(light.type));
+            m_lightData[i * 4 + 2] = glm::vec4(d, light.spotCosOuter);
+            m_lightData[i * 4 + 3] = glm::vec4(light.spotCosInner, 0.0f, 0.0f, 0.0f);
+        }
+    });
+
+    // one job per depth slice: every job owns its clusters and its index list
+    m_clusterTable.resize(m_clusterBounds.size() * 2);
+    jobs.parallelFor(static_cast<size_t>(m_dimZ), 1, [&](size_t begin, size_t end)
+    {
+        for(size_t z = begin; z < end; z++) { assignSlice(static_cast<int>(z)); }
+    });
+
+    // merge the per-slice lists and turn slice-local offsets into global ones
+    m_lightIndices.clear();
+    m_stats.maxLightsPerCluster = 0;
+    size_t clustersPerSlice = static_cast<size_t>(m_dimX) * m_dimY;
+    for(int z = 0; z < m_dimZ; z++)
+    {
+        uint32_t base = static_cast<uint32_t>(m_lightIndices.size());
+        for(size_t c = static_cast<size_t>(z) * clustersPerSlice; c < (z + 1) * clustersPerSlice; c++)
+        {
+            m_clusterTable[c * 2] += base;
+            m_stats.maxLightsPerCluster = std::max<size_t>(m_stats.maxLightsPerCluster, m_clusterTable[c * 2 + 1]);
+        }
+        m_lightIndices.insert(m_lightIndices.end(), m_sliceIndices[z].begin(), m_sliceIndices[z].end());
+    }
+
+    m_stats.numLights = numLights;
+    m_stats.numLightIndices = m_lightIndices.size();
+    m_stats.assignMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ClusteredLighting::assignSlice(int z)
+{
+    std::vector<uint32_t>& indices = m_sliceIndices[z];
+    std::vector<uint32_t> candidates;
+    size_t clustersPerSlice = static_cast<size_t>(m_dimX) * m_dimY;
+    size_t numPadded = m_lightX.size();
+
+    indices.clear();
+
+    // cheap depth pre-pass: lights overlapping the slice's depth range, in groups of 4
+    const ClusterBounds& first = m_clusterBounds[static_cast<size_t>(z) * clustersPerSlice];
+    float sliceNear = first.boundsMax.z, sliceFar = first.boundsMin.z; // view space: -near > -far
+    for(size_t i = 0; i < numPadded; i += 4)
+    {
+        for(size_t k = i; k < i + 4; k++)
+        {
+            if(m_lightZ[k] - m_lightRadius[k] <= sliceNear && m_lightZ[k] + m_lightRadius[k] >= sliceFar)
+            {
+                candidates.push_back(static_cast<uint32_t>(i));
+                break;
+            }
+        }
+    }
+
+    for(size_t c = 0; c < clustersPerSlice; c++)
+    {
+        size_t cluster = static_cast<size_t>(z) * clustersPerSlice + c;
+        const ClusterBounds& bounds = m_clusterBounds[cluster];
+        uint32_t offset = static_cast<uint32_t>(indices.size());
+
+        // sphere vs AABB: squared distance from the center to the box <= radius^2
+#ifdef SIMD_SSE
+        __m128 bMinX = _mm_set1_ps(bounds.boundsMin.x), bMinY = _mm_set1_ps(bounds.boundsMin.y), bMinZ = _mm_set1_ps(bounds.boundsMin.z);
+        __m128 bMaxX = _mm_set1_ps(bounds.boundsMax.x), bMaxY = _mm_set1_ps(bounds.boundsMax.y), bMaxZ = _mm_set1_ps(bounds.boundsMax.z);
+        __m128 zero = _mm_setzero_ps();
+        for(size_t j = 0; j < candidates.size(); j++)
+        {
+            size_t i = candidates[j];
+            __m128 x = _mm_loadu_ps(&m_lightX[i]), y = _mm_loadu_ps(&m_lightY[i]), zz = _mm_loadu_ps(&m_lightZ[i]);
+            __m128 r = _mm_loadu_ps(&m_lightRadius[i]);
+            __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(bMinX, x), zero), _mm_max_ps(_mm_sub_ps(x, bMaxX), zero));
+            __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(bMinY, y), zero), _mm_max_ps(_mm_sub_ps(y, bMaxY), zero));
+            __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(bMinZ, zz), zero), _mm_max_ps(_mm_sub_ps(zz, bMaxZ), zero));
+            __m128 dist2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            int mask = _mm_movemask_ps(_mm_cmple_ps(dist2, _mm_mul_ps(r, r)));
+            for(int k = 0; mask; k++, mask >>= 1)
+            {
+                if(mask & 1) { indices.push_back(static_cast<uint32_t>(i + k)); }
+            }
+        }
+#else
+        for(size_t j = 0; j < candidates.size(); j++)
+        {
+            for(size_t i = candidates[j]; i < candidates[j] + 4; i++)
+            {
+                float dx = std::max(0.0f, std::max(bounds.boundsMin.x - m_lightX[i], m_lightX[i] - bounds.boundsMax.x));
+                float dy = std::max(0.0f, std::max(bounds.boundsMin.y - m_lightY[i], m_lightY[i] - bounds.boundsMax.y));
+                float dz = std::max(0.0f, std::max(bounds.boundsMin.z - m_lightZ[i], m_lightZ[i] - bounds.boundsMax.z));
+                if(dx * dx + dy * dy + dz * dz <= m_lightRadius[i] * m_lightRadius[i]) { indices.push_back(static_cast<uint32_t>(i)); }
+            }
+        }
+#endif
+
+        m_clusterTable[cluster * 2] = offset; // slice-local for now
+        m_clusterTable[cluster * 2 + 1] = static_cast<uint32_t>(indices.size()) - offset;
+    }
+}
+
+// call this method on the GL thread after update()
+void ClusteredLighting::upload()
+{
+    static const GLenum formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+    const void* data[3] = { m_lightData.data(), m_clusterTable.data(), m_lightIndices.data() };
+    size_t sizes[3] = { m_lightData.size() * sizeof(glm::vec4), m_clusterTable.size() * sizeof(uint32_t), m_lightIndices.size() * sizeof(uint32_t) };
+
+    if(!m_buffers[0])
+    {
+        glGenBuffers(3, m_buffers);
+        glGenTextures(3, m_textures);
+        if(!(m_buffers[0] && m_buffers[1] && m_buffers[2] && m_textures[0] && m_textures[1] && m_textures[2]))
+        {
+            LOG_ERROR(RENDER, "failed to generate light buffers");
+            destroyBuffers();
+            return;
+        }
+    }
+
+    for(int i = 0; i < 3; i++)
+    {
+        // orphan and refill: the driver does not have to wait for the previous frame
+        // at least one texel, so the buffer texture is always complete
+        GLsizeiptr size = static_cast<GLsizeiptr>(std::max<size_t>(sizes[i], 16));
+        GLState::instance().bindBuffer(GL_TEXTURE_BUFFER, m_buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        if(sizes[i]) { glBufferSubData(GL_TEXTURE_BUFFER, 0, static_cast<GLsizeiptr>(sizes[i]), data[i]); }
+
+        GLState::instance().editTexture(GL_TEXTURE_BUFFER, m_textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, formats[i], m_buffers[i]);
+    }
+}
+
+// call this method after calling shaderProgram.use()
+// firstUnit: first of 3 consecutive texture units not used by Mesh::draw() (e.g. 8)
+void ClusteredLighting::bind(ShaderProgram& shaderProgram, int firstUnit, int screenWidth, int screenHeight)
+{
+    static const char* samplers[3] = { "lightData", "clusterTable", "lightIndices" };
+
+    for(int i = 0; i < 3; i++)
+    {
+        GLState::instance().bindTexture(static_cast<GLuint>(firstUnit + i), GL_TEXTURE_BUFFER, m_textures[i]);
+        shaderProgram.setSampler(samplers[i], firstUnit + i);
+    }
+
+    // slice = floor(log(depth) * scale + bias), see setProjection()
+    float logRatio = std::log(m_far / m_near);
+    shaderProgram.setVec3("clusterDim", static_cast<float>(m_dimX), static_cast<float>(m_dimY), static_cast<float>(m_dimZ));
+    shaderProgram.setVec2("clusterTileSize", static_cast<float>(screenWidth) / m_dimX, static_cast<float>(screenHeight) / m_dimY);
+    shaderProgram.setFloat("clusterSliceScale", m_dimZ / logRatio);
+    shaderProgram.setFloat("clusterSliceBias", -m_dimZ * std::log(m_near) / logRatio);
+}
+
+void ClusteredLighting::destroyBuffers()
+{
+    if(m_textures[0] || m_textures[1] || m_textures[2]) { GLState::instance().deleteTextures(3, m_textures); }
+    if(m_buffers[0] || m_buffers[1] || m_buffers[2]) { GLState::instance().deleteBuffers(3, m_buffers); }
+    m_buffers[0] = m_buffers[1] = m_buffers[2] = 0;
+    m_textures[0] = m_textures[1] = m_textures[2] = 0;
+}
@@ -0,0 +1,138 @@
+// include
+#include <CommandBuffer.hpp>
+
+// keeps the allocations, so steady-state recording does not allocate
+void CommandBuffer::clear()
+{
+    m_commands.clear();
+    m_payload.clear();
+}
+
+void CommandBuffer::append(const CommandBuffer& other)
+{
+    uint32_t payloadBase = static_cast<uint32_t>(m_payload.size());
+    size_t first = m_commands.size();
+
+    m_commands.insert(m_commands.end(), other.m_commands.begin(), other.m_commands.end());
+    m_payload.insert(m_payload.end(), other.m_payload.begin(), other.m_payload.end());
+    for(size_t i = first; i < m_commands.size(); i++)
+    {
+        if(m_commands[i].type == RenderCommand::SET_UNIFORM) { m_commands[i].setUniform.payloadOffset += payloadBase; }
+    }
+}
+
+void CommandBuffer::bindProgram(uint32_t program)
+{
+    RenderCommand cmd;
+    cmd.type = RenderCommand::BIND_PROGRAM;
+    cmd.bindProgram.program = program;
+    m_commands.push_back(cmd);
+}
+
+void CommandBuffer::bindVertexArray(uint32_t vertexArray)
+{
+    RenderCommand cmd;
+    cmd.type = RenderCommand::BIND_VERTEX_ARRAY;
+    cmd.bindVertexArray.vertexArray = vertexArray;
+    m_commands.push_back(cmd);
+}
+
+void CommandBuffer::bindTexture(uint16_t unit, uint32_t texture, uint8_t target)
+{
+    RenderCommand cmd;
+    cmd.type = RenderCommand::BIND_TEXTURE;
+    cmd.bindTexture.texture = texture;
+    cmd.bindTexture.unit = unit;
+    cmd.bindTexture.target = target;
+    m_commands.push_back(cmd);
+}
+
+void CommandBuffer::setInt(int32_t location, int i) { setUniform(location, RenderCommand::UNIFORM_INT, &i, sizeof(int)); }
+void CommandBuffer::setFloat(int32_t location, float f) { setUniform(location, RenderCommand::UNIFORM_FLOAT, &f, sizeof(float)); }
+void CommandBuffer::setVec2(int32_t location, const glm::vec2& v2) { setUniform(location, RenderCommand::UNIFORM_VEC2, &v2[0], sizeof(glm::vec2)); }
+void CommandBuffer::setVec3(int32_t location, const glm::vec3& v3) { setUniform(location, RenderCommand::UNIFORM_VEC3, &v3[0], sizeof(glm::vec3)); }
+void CommandBuffer::setVec4(int32_t location, const glm::vec4& v4) { setUniform(location, RenderCommand::UNIFORM_VEC4, &v4[0], sizeof(glm::vec4)); }
+void CommandBuffer::setMat3(int32_t location, const glm::mat3& m3) { setUniform(location, RenderCommand::UNIFORM_MAT3, &m3[0][0], sizeof(glm::mat3)); }
+void CommandBuffer::setMat4(int32_t location, const glm::mat4& m4) { setUniform(location, RenderCommand::UNIFORM_MAT4, &m4[0][0], sizeof(glm::mat4)); }
+
+void CommandBuffer::drawIndexed(uint32_t numIndices, uint32_t firstIndex, int32_t baseVertex)
+{
+    RenderCommand cmd;
+    cmd.type = RenderCommand::DRAW_INDEXED;
+    cmd.drawIndexed.numIndices = numIndices;
+    cmd.drawIndexed.firstIndex = firstIndex;
+    cmd.drawIndexed.baseVertex = baseVertex;
+    m_commands.push_back(cmd);
+}
+
+// location < 0 (inactive uniform) is dropped at record time
+void CommandBuffer::setUniform(int32_t location, uint8_t uniformType, const void* data, size_t size)
+{
+    if(location < 0) { return; }
+
+    RenderCommand cmd;
+    cmd.type = RenderCommand::SET_UNIFORM;
+    cmd.setUniform.location = location;
+    cmd.setUniform.payloadOffset = static_cast<uint32_t>(m_payload.size());
+    cmd.setUniform.uniformType = uniformType;
+
+    m_payload.resize(m_payload.size() + size / sizeof(uint32_t));
+    memcpy(&m_payload[cmd.setUniform.payloadOffset], data, size);
+    m_commands.push_back(cmd);
+}
+
+// call this method on the thread owning the GL context
+// bindings go through GLState, so binds repeated across command buffers (or frames) are dropped
+void CommandBuffer::execute() const
+{
+    static const GLenum targets[] = { GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BUFFER };
+    GLState& gl = GLState::instance();
+
+    for(size_t i = 0; i < m_commands.size(); i++)
+    {
+        const RenderCommand& cmd = m_commands[i];
+        switch(cmd.type)
+        {
+        case RenderCommand::BIND_PROGRAM:
+            gl.useProgram(cmd.bindProgram.program);
+            break;
+
+        case RenderCommand::BIND_VERTEX_ARRAY:
+            gl.bindVertexArray(cmd.bindVertexArray.vertexArray);
+            break;
+
+        case RenderCommand::BIND_TEXTURE:
+            gl.bindTexture(cmd.bindTexture.unit, targets[cmd.bindTexture.target], cmd.bindTexture.texture);
+            break;
+
+        case RenderCommand::SET_UNIFORM:
+        {
+            const void* data = &m_payload[cmd.setUniform.payloadOffset];
+            GLint location = cmd.setUniform.location;
+            gl.traceUniform(location);
+            switch(cmd.setUniform.uniformType)
+            {
+            case RenderCommand::UNIFORM_INT: glUniform1iv(location, 1, static_cast<const GLint*>(data)); break;
+            case RenderCommand::UNIFORM_FLOAT: glUniform1fv(location, 1, static_cast<const GLfloat*>(data)); break;
+            case RenderCommand::UNIFORM_VEC2: glUniform2fv(location, 1, static_cast<const GLfloat*>(data)); break;
+            case RenderCommand::UNIFORM_VEC3: glUniform3fv(location, 1, static_cast<const GLfloat*>(data)); break;
+            case RenderCommand::UNIFORM_VEC4: glUniform4fv(location, 1, static_cast<const GLfloat*>(data)); break;
+            case RenderCommand::UNIFORM_MAT3: glUniformMatrix3fv(location, 1, GL_FALSE, static_cast<const GLfloat*>(data)); break;
+            case RenderCommand::UNIFORM_MAT4: glUniformMatrix4fv(location, 1, GL_FALSE, static_cast<const GLfloat*>(data)); break;
+            default: LOG_WARN(RENDER, "wrong or unimplemented uniform type"); break;
+            }
+            break;
+        }
+
+        case RenderCommand::DRAW_INDEXED:
+            gl.traceDraw(GL_TRIANGLES, cmd.drawIndexed.numIndices);
+            glDrawElementsBaseVertex(GL_TRIANGLES, cmd.drawIndexed.numIndices, GL_UNSIGNED_INT,
+                (void*)(static_cast<uintptr_t>(cmd.drawIndexed.firstIndex) * sizeof(GLuint)), cmd.drawIndexed.baseVertex);
+            break;
+
+        default:
+            LOG_WARN(RENDER, "wrong or unimplemented render command");
+            break;
+        }
+    }
+}
@@ -0,0 +1,244 @@
+// include
+#include <FileSystem.hpp>
+
+// the pack is written and mapped as is
+static_assert(sizeof(FileSystem::PackHeader) == 48, "PackHeader must have no padding");
+static_assert(sizeof(FileSystem::PackEntry) == 48, "PackEntry must have no padding");
+
+const uint32_t FileSystem::VERSION;
+const uint32_t FileSystem::DEFAULT_ALIGNMENT;
+
+VirtualFile::VirtualFile(const char* filePath)
+{
+    nullify();
+    open(filePath);
+}
+
+// return: true (opened), false (error)
+bool VirtualFile::open(const char* filePath) { return FileSystem::instance().open(filePath, *this); }
+
+void VirtualFile::close()
+{
+    m_file.close();
+    nullify();
+}
+
+FileSystem& FileSystem::instance()
+{
+    static FileSystem s_fileSystem;
+    return s_fileSystem;
+}
+
+FileSystem::Stats FileSystem::getStats()
+{
+    // local vars
+    Stats stats;
+
+    memset(&stats, 0, sizeof(Stats)); // nullify
+    stats.numPacks = m_packs.size();
+    for(size_t i = 0; i < m_packs.size(); i++) { stats.numEntries += m_packs[i]->header->numEntries; }
+    stats.numPackedReads = m_numPackedReads;
+    stats.numLooseReads = m_numLooseReads;
+    stats.packedBytes = m_packedBytes;
+    stats.looseBytes = m_looseBytes;
+    stats.decompressedBytes = m_decompressedBytes;
+    stats.decompressMs = static_cast<double>(m_decompressNs.load()) * 1e-6;
+    return stats;
+}
+
+// e.g.) FileSystem::instance().mount("assets.pak");
+// entries of a later pack override the same paths of earlier ones
+// return: true (mounted), false (error)
+bool FileSystem::mount(const char* packPath)
+{
+    // local vars
+    std::unique_ptr<Pack> pack(new Pack());
+
+    // check filepath
+    if(!packPath) { LOG_ERROR(ASSET, "FileSystem::mount(nullptr): null filepath"); return false; }
+    LOG_INFO(ASSET, "FileSystem::mount(\"{}\")", packPath);
+
+    if(!pack->file.open(packPath)) { return false; }
+    pack->header = reinterpret_cast<const PackHeader*>(pack->file.getData());
+    if(!validate(*pack)) { LOG_ERROR(ASSET, "not an asset pack or corrupted: \"{}\"", packPath); return false; }
+    pack->entries = reinterpret_cast<const PackEntry*>(pack->file.getData() + pack->header->tocOffset);
+    pack->strings = pack->file.getData() + pack->header->stringsOffset;
+
+    LOG_INFO(ASSET, "mounted {} entries ({:.1f} MB)", pack->header->numEntries, pack->file.getSize() / 1048576.0);
+    m_packs.insert(m_packs.begin(), std::move(pack));
+    return true;
+}
+
+// every VirtualFile served from the packs must be closed before
+void FileSystem::unmountAll() { m_packs.clear(); }
+
+// pack entry if any pack has the path, the loose file otherwise
+// return: true (opened), false (error)
+bool FileSystem::open(const char* filePath, VirtualFile& file)
+{
+    // local vars
+    Pack* pack;
+    const PackEntry* entry;
+
+    // check filepath
+    if(!filePath) { LOG_ERROR(ASSET, "FileSystem::open(nullptr): null filepath"); return false; }
+
+    file.close();
+    entry = m_packs.empty() ? nullptr : find(normalizePath(filePath), pack);
+    if(!entry)
+    {
+        if(!file.m_file.open(filePath)) { return false; }
+        file.m_data = file.m_file.getData();
+        file.m_size = file.m_file.getSize();
+        m_numLooseReads++;
+        m_looseBytes += file.m_size;
+        return true;
+    }
+
+    const char* data = pack->file.getData() + entry->offset;
+    switch (entry->compression)
+    {
+    case NONE:
+        file.m_data = data;
+        file.m_size = static_cast<size_t>(entry->size);
+        break;
+
+#ifdef ENGINE_LZ4
+    case LZ4:
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        file.m_buffer.resize(static_cast<size_t>(entry->size));
+        int size = LZ4_decompress_safe(data, file.m_buffer.data(), static_cast<int>(entry->storedSize), static_cast<int>(entry->size));
+        if(size < 0 || static_cast<uint64_t>(size) != entry->size)
+        {
+            LOG_ERROR(ASSET, "corrupted LZ4 entry: \"{}\"", filePath);
+            file.close();
+            return false;
+        }
+        file.m_data = file.m_buffer.data();
+        file.m_size = file.m_buffer.size();
+        m_decompressedBytes += file.m_size;
+        m_decompressNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        break;
+    }
+#endif
+
+    default:
+        LOG_ERROR(ASSET, "unsupported compression {} (ENGINE_LZ4 off?): \"{}\"", entry->compression, filePath);
+        return false;
+    }
+
+    file.m_packed = true;
+    m_numPackedReads++;
+    m_packedBytes += static_cast<size_t>(entry->storedSize);
+    LOG_TRACE(ASSET, "FileSystem::open(\"{}\"): packed, {} bytes", filePath, file.m_size);
+    return true;
+}
+
+// no error when missing (e.g. assimp probing for files)
+bool FileSystem::exists(const char* filePath)
+{
+    // local vars
+    Pack* pack;
+    FILE* file;
+
+    if(!filePath) { return false; }
+    if(!m_packs.empty() && find(normalizePath(filePath), pack)) { return true; }
+
+    file = fopen(filePath, "rb");
+    if(file) { fclose(file); }
+    return file != nullptr;
+}
+
+// e.g.) "../../resource/./model\\model.obj" -> "resource/model/model.obj", "shader/../resource/a.png" -> "resource/a.png"
+std::string FileSystem::normalizePath(const char* filePath)
+{
+    // local vars
+    std::vector<std::string> parts;
+    std::string part, path;
+
+    for(const char* p = filePath; ; p++)
+    {
+        if(*p && *p != '/' && *p != '\\') { part += *p; continue; }
+
+        if(part == "..")
+        {
+            if(!parts.empty()) { parts.pop_back(); } // leading ".." are dropped
+        }
+        else if(!part.empty() && part != ".") { parts.push_back(part); }
+        part.clear();
+        if(!*p) { break; }
+    }
+
+    for(size_t i = 0; i < parts.size(); i++)
+    {
+        if(i) { path += '/'; }
+        path += parts[i];
+    }
+    return path;
+}
+
+// 64-bit FNV-1a
+uint64_t FileSystem::hashPath(const std::string& path)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for(size_t i = 0; i < path.size(); i++)
+    {
+        hash ^= static_cast<unsigned char>(path[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// binary search on the hash, then the path itself (collisions)
+const FileSystem::PackEntry* FileSystem::find(const std::string& path, Pack*& pack) const
+{
+    // local vars
+    uint64_t hash = hashPath(path);
+
+    for(size_t i = 0; i < m_packs.size(); i++)
+    {
+        const PackEntry* begin = m_packs[i]->entries;
+        const PackEntry* end = begin + m_packs[i]->header->numEntries;
+        const PackEntry* entry = std::lower_bound(begin, end, hash, [](const PackEntry& e, uint64_t h) { return e.hash < h; });
+
+        for(; entry != end && entry->hash == hash; entry++)
+        {
+            if(entry->pathLength == path.size() && !memcmp(m_packs[i]->strings + entry->pathOffset, path.data(), path.size()))
+            {
+                pack = m_packs[i].get();
+                return entry;
+            }
+        }
+    }
+    return nullptr;
+}
+
+// bounds of the header, the table, the paths and every entry (uncompressed: size of the stored bytes)
+bool FileSystem::validate(Pack& pack) const
+{
+    // local vars
+    const PackHeader* header = pack.header;
+    uint64_t fileSize = pack.file.getSize();
+
+    if(fileSize < sizeof(PackHeader) || memcmp(header->magic, "BOGLPAK1", 8)) { return false; }
+    if(header->version != VERSION)
+    {
+        LOG_ERROR(ASSET, "asset pack version {} (expected {})", header->version, VERSION);
+        return false;
+    }
+    if(header->tocOffset % alignof(PackEntry) || header->tocOffset > fileSize ||
+        header->numEntries > (fileSize - header->tocOffset) / sizeof(PackEntry)) { return false; }
+    if(header->stringsOffset > fileSize || header->stringsSize > fileSize - header->stringsOffset) { return false; }
+
+    const PackEntry* entries = reinterpret_cast<const PackEntry*>(pack.file.getData() + header->tocOffset);
+    for(uint32_t i = 0; i < header->numEntries; i++)
+    {
+        const PackEntry& entry = entries[i];
+        if(entry.offset > fileSize || entry.storedSize > fileSize - entry.offset) { return false; }
+        if(entry.compression == NONE && entry.size != entry.storedSize) { return false; } // open() serves size bytes from the pack
+        if(static_cast<uint64_t>(entry.pathOffset) + entry.pathLength > header->stringsSize) { return false; }
+        if(i && entries[i - 1].hash > entry.hash) { return false; }
+    }
+    return true;
+}
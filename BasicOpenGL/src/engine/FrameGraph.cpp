@@ -0,0 +1,666 @@
+// include
+#include <FrameGraph.hpp>
+
+// std
+#include <algorithm>
+#include <cstdio>
+
+FrameGraph::~FrameGraph()
+{
+    releaseFramebuffers();
+    releasePool();
+}
+
+// pass: the handle returned by addPass()
+// return: the framebuffer bound while the pass executes, 0 for the default framebuffer or a pass without attachments
+// e.g.) a later pass reading the color of this one with glBlitFramebuffer(): glBindFramebuffer(GL_READ_FRAMEBUFFER, g.getFramebuffer(scene))
+GLuint FrameGraph::getFramebuffer(int pass) const
+{
+    int framebuffer = m_passes[pass].framebuffer;
+    return framebuffer >= 0 ? m_framebuffers[framebuffer].FBO : 0;
+}
+
+// transient texture: allocated (or aliased) by compile(), contents undefined before the first write of each frame
+// return: resource handle
+int FrameGraph::createTexture(const char* name, const TextureDesc& desc)
+{
+    return addResource(name, false, false, desc, 0, 0);
+}
+
+// transient buffer of size bytes
+int FrameGraph::createBuffer(const char* name, GLsizeiptr size)
+{
+    return addResource(name, true, false, TextureDesc(), size, 0);
+}
+
+// texture: owned by the caller, 0 for the default framebuffer (write it with ATTACHMENT)
+// passes writing an imported resource are never culled
+int FrameGraph::importTexture(const char* name, GLuint texture, const TextureDesc& desc)
+{
+    return addResource(name, false, true, desc, 0, texture);
+}
+
+int FrameGraph::importBuffer(const char* name, GLuint buffer, GLsizeiptr size)
+{
+    return addResource(name, true, true, TextureDesc(), size, buffer);
+}
+
+// execute: called by execute() every frame with the pass's framebuffer bound (if it has attachments)
+// return: pass handle for read()/write()
+int FrameGraph::addPass(const char* name, ExecuteFunction execute)
+{
+    Pass pass = Pass();
+
+    pass.name = name ? name : "";
+    pass.execute = execute;
+    pass.framebuffer = -1;
+    m_passes.push_back(pass);
+    m_compiled = false;
+    return static_cast<int>(m_passes.size()) - 1;
+}
+
+// access: ACCESS (SAMPLED, STORAGE, ...)
+// the pass runs after the passes declared before it that write resource
+void FrameGraph::read(int pass, int resource, int access)
+{
+    if(pass < 0 || pass >= static_cast<int>(m_passes.size())) { LOG_ERROR(RENDER, "FrameGraph::read(): wrong pass {}", pass); return; }
+    if(resource < 0 || resource >= static_cast<int>(m_resources.size())) { LOG_ERROR(RENDER, "FrameGraph::read(): wrong resource {}", resource); return; }
+
+    Access a = { resource, access, false };
+    m_passes[pass].accesses.push_back(a);
+    m_compiled = false;
+}
+
+// access: ACCESS (ATTACHMENT, STORAGE, TRANSFER, ...)
+// the pass runs after the passes declared before it that read or write resource
+void FrameGraph::write(int pass, int resource, int access)
+{
+    if(pass < 0 || pass >= static_cast<int>(m_passes.size())) { LOG_ERROR(RENDER, "FrameGraph::write(): wrong pass {}", pass); return; }
+    if(resource < 0 || resource >= static_cast<int>(m_resources.size())) { LOG_ERROR(RENDER, "FrameGraph::write(): wrong resource {}", resource); return; }
+    if(access == SAMPLED || access == UNIFORM || access == VERTEX || access == INDIRECT) { LOG_WARN(RENDER, "FrameGraph::write(): \"{}\" is written with a read-only access", m_resources[resource].name); }
+
+    Access a = { resource, access, true };
+    m_passes[pass].accesses.push_back(a);
+    m_compiled = false;
+}
+
+// forget every pass and resource; the pool of physical textures and buffers is kept for the next compile()
+// e.g.) the window was resized: reset(), declare again, compile()
+void FrameGraph::reset()
+{
+    releaseFramebuffers();
+    std::vector<Pass>().swap(m_passes);
+    std::vector<Resource>().swap(m_resources);
+    std::vector<int>().swap(m_order);
+    m_compiled = false;
+}
+
+// cull, order, allocate and plan (GL calls: pool textures/buffers and framebuffers only)
+// return: false if a pass has no valid framebuffer
+bool FrameGraph::compile()
+{
+    // local vars
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool complete = true;
+
+    releaseFramebuffers();
+    cullPasses();
+    sortPasses();
+    assignPhysical();
+    planBarriers();
+    complete = createFramebuffers();
+    m_compiled = true;
+
+    LOG_INFO(RENDER, "FrameGraph::compile(): {} passes ({} culled), {} transient resources in {} textures and {} buffers, {:.1f} MB ({:.1f} MB without aliasing), {:.3f} ms",
+        m_stats.numPasses, m_stats.numCulled, m_stats.numResources, m_stats.numTextures, m_stats.numBuffers,
+        m_stats.bytes / 1048576.0, m_stats.unaliasedBytes / 1048576.0,
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return complete;
+}
+
+// run the passes in order: barriers, framebuffer and viewport, then the pass's function
+void FrameGraph::execute()
+{
+    if(!m_compiled) { compile(); }
+
+    for(size_t i = 0; i < m_order.size(); i++)
+    {
+        const Pass& pass = m_passes[m_order[i]];
+
+        if(pass.barriers) { glMemoryBarrier(pass.barriers); }
+        if(pass.framebuffer != -1)
+        {
+            if(pass.framebuffer == -2)
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                glViewport(0, 0, m_defaultWidth, m_defaultHeight);
+            }
+            else
+            {
+                const Framebuffer& framebuffer = m_framebuffers[pass.framebuffer];
+                glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.FBO);
+                glViewport(0, 0, framebuffer.width, framebuffer.height);
+            }
+        }
+        if(pass.execute) { pass.execute(*this); }
+    }
+}
+
+// one row per resource, one column per executed pass (execution order)
+// W: written, R: read, B: both, -: alive (allocated, not accessed), blank: not allocated
+// e.g.)
+// passes: 0: shadow 1: scene 2: bloom 3: present
+// resource                 physical       bytes    0  1  2  3
+// shadowMap                T0           4194304    W  R
+// sceneColor               T1           8388608       W  R  R
+// bloom                    T0           4194304          W  R      <- the memory of shadowMap
+// backbuffer               imported     8388608                W
+std::string FrameGraph::dumpLifetimes() const
+{
+    // local vars
+    std::string out;
+    char line[256];
+
+    snprintf(line, sizeof(line), "frame graph: %zu passes (%zu culled), %zu transient resources -> %zu textures + %zu buffers, %.1f MB (%.1f MB without aliasing)\n",
+        m_stats.numPasses, m_stats.numCulled, m_stats.numResources, m_stats.numTextures, m_stats.numBuffers,
+        m_stats.bytes / 1048576.0, m_stats.unaliasedBytes / 1048576.0);
+    out += line;
+
+    out += "passes:";
+    for(size_t i = 0; i < m_order.size(); i++)
+    {
+        snprintf(line, sizeof(line), " %zu: %s", i, m_passes[m_order[i]].name.c_str());
+        out += line;
+    }
+    for(size_t p = 0; p < m_passes.size(); p++)
+    {
+        if(m_passes[p].culled) { out += " (culled: " + m_passes[p].name + ")"; }
+    }
+    out += "\n";
+
+    snprintf(line, sizeof(line), "%-24s %-9s %10s  ", "resource", "physical", "bytes");
+    out += line;
+    for(size_t i = 0; i < m_order.size(); i++)
+    {
+        snprintf(line, sizeof(line), "%3zu", i);
+        out += line;
+    }
+    out += "\n";
+
+    for(size_t r = 0; r < m_resources.size(); r++)
+    {
+        const Resource& resource = m_resources[r];
+        char physical[16];
+        size_t bytes = resource.isBuffer ? static_cast<size_t>(resource.size) : getTextureBytes(resource.desc);
+
+        if(resource.imported) { snprintf(physical, sizeof(physical), "imported"); }
+        else if(resource.physical < 0) { snprintf(physical, sizeof(physical), "unused"); }
+        else { snprintf(physical, sizeof(physical), "%c%d", resource.isBuffer ? 'B' : 'T', resource.physical); }
+        snprintf(line, sizeof(line), "%-24s %-9s %10zu  ", resource.name.c_str(), physical, bytes);
+        out += line;
+
+        for(size_t i = 0; i < m_order.size(); i++)
+        {
+            bool reads = false, writes = false;
+            const std::vector<Access>& accesses = m_passes[m_order[i]].accesses;
+
+            for(size_t a = 0; a < accesses.size(); a++)
+            {
+                if(accesses[a].resource != static_cast<int>(r)) { continue; }
+                if(accesses[a].write) { writes = true; }
+                else { reads = true; }
+            }
+            if(reads || writes) { out += writes ? (reads ? "  B" : "  W") : "  R"; }
+            else if(resource.firstUse >= 0 && static_cast<int>(i) > resource.firstUse && static_cast<int>(i) < resource.lastUse) { out += "  -"; }
+            else { out += "   "; }
+        }
+        out += "\n";
+    }
+    return out;
+}
+
+int FrameGraph::addResource(const char* name, bool isBuffer, bool imported, const TextureDesc& desc, GLsizeiptr size, GLuint object)
+{
+    Resource resource = Resource();
+
+    resource.name = name ? name : "";
+    resource.isBuffer = isBuffer;
+    resource.imported = imported;
+    resource.desc = desc;
+    resource.size = size;
+    resource.object = object;
+    resource.physical = -1;
+    resource.firstUse = resource.lastUse = -1;
+    m_resources.push_back(resource);
+    m_compiled = false;
+    return static_cast<int>(m_resources.size()) - 1;
+}
+
+// dependencies: for every access, the last earlier writer of the resource (read after write, write after write);
+// for writes also the readers since that writer (write after read, ordering only)
+// live passes: passes writing an imported resource and, recursively, the passes they depend on
+void FrameGraph::cullPasses()
+{
+    // local vars
+    std::vector<int> lastWriter(m_resources.size(), -1);
+    std::vector<std::vector<int> > readers(m_resources.size());
+    std::vector<int> stack;
+
+    for(size_t p = 0; p < m_passes.size(); p++)
+    {
+        Pass& pass = m_passes[p];
+
+        pass.dependencies.clear();
+        pass.after.clear();
+        pass.culled = true;
+        for(size_t a = 0; a < pass.accesses.size(); a++)
+        {
+            int r = pass.accesses[a].resource;
+
+            if(lastWriter[r] >= 0 && lastWriter[r] != static_cast<int>(p)) { pass.dependencies.push_back(lastWriter[r]); }
+            if(pass.accesses[a].write)
+            {
+                for(size_t i = 0; i < readers[r].size(); i++)
+                {
+                    if(readers[r][i] != static_cast<int>(p)) { pass.after.push_back(readers[r][i]); }
+                }
+                if(m_resources[r].imported) { stack.push_back(static_cast<int>(p)); }
+            }
+        }
+        // resources written by this pass: later accesses depend on it
+        for(size_t a = 0; a < pass.accesses.size(); a++)
+        {
+            int r = pass.accesses[a].resource;
+
+            if(pass.accesses[a].write) { lastWriter[r] = static_cast<int>(p); readers[r].clear(); }
+        }
+        for(size_t a = 0; a < pass.accesses.size(); a++)
+        {
+            if(!pass.accesses[a].write) { readers[pass.accesses[a].resource].push_back(static_cast<int>(p)); }
+        }
+    }
+
+    while(!stack.empty())
+    {
+        Pass& pass = m_passes[stack.back()];
+        stack.pop_back();
+        if(!pass.culled) { continue; }
+
+        pass.culled = false;
+        for(size_t d = 0; d < pass.dependencies.size(); d++) { stack.push_back(pass.dependencies[d]); }
+    }
+
+    m_stats.numPasses = m_passes.size();
+    m_stats.numCulled = 0;
+    for(size_t p = 0; p < m_passes.size(); p++)
+    {
+        if(m_passes[p].culled) { LOG_DEBUG(RENDER, "FrameGraph: pass \"{}\" culled (its results are not used)", m_passes[p].name); m_stats.numCulled++; }
+    }
+}
+
+// depth-first post-order over the dependencies of the live passes (roots and dependencies in declaration order):
+// a producer runs right before its first consumer, which shortens the lifetimes of its outputs
+// every edge points to an earlier declared pass, so the graph has no cycle
+void FrameGraph::sortPasses()
+{
+    // local vars
+    std::vector<char> visited(m_passes.size(), 0);
+    std::vector<std::pair<int, size_t> > stack; // pass, next edge
+
+    m_order.clear();
+    for(size_t root = 0; root < m_passes.size(); root++)
+    {
+        if(m_passes[root].culled || visited[root]) { continue; }
+
+        visited[root] = 1;
+        stack.push_back(std::make_pair(static_cast<int>(root), size_t(0)));
+        while(!stack.empty())
+        {
+            const Pass& pass = m_passes[stack.back().first];
+            size_t edge = stack.back().second++;
+            size_t numDependencies = pass.dependencies.size();
+
+            if(edge < numDependencies + pass.after.size())
+            {
+                int next = edge < numDependencies ? pass.dependencies[edge] : pass.after[edge - numDependencies];
+                if(!m_passes[next].culled && !visited[next])
+                {
+                    visited[next] = 1;
+                    stack.push_back(std::make_pair(next, size_t(0)));
+                }
+                continue;
+            }
+            m_order.push_back(stack.back().first);
+            stack.pop_back();
+        }
+    }
+}
+
+// lifetimes are intervals of m_order; a transient resource takes a pool entry of the same kind
+// (textures: same size and format, buffers: large enough) that is free before its first use,
+// scanning resources by first use (interval coloring: as few entries as overlapping lifetimes allow)
+void FrameGraph::assignPhysical()
+{
+    // local vars
+    std::vector<int> byFirstUse;
+    std::vector<int> remap;
+    std::vector<Physical> pool;
+
+    for(size_t r = 0; r < m_resources.size(); r++)
+    {
+        m_resources[r].firstUse = m_resources[r].lastUse = -1;
+        if(!m_resources[r].imported) { m_resources[r].object = 0; m_resources[r].physical = -1; }
+    }
+    for(size_t i = 0; i < m_order.size(); i++)
+    {
+        const std::vector<Access>& accesses = m_passes[m_order[i]].accesses;
+        for(size_t a = 0; a < accesses.size(); a++)
+        {
+            Resource& resource = m_resources[accesses[a].resource];
+            if(resource.firstUse < 0) { resource.firstUse = static_cast<int>(i); }
+            resource.lastUse = static_cast<int>(i);
+        }
+    }
+
+    for(size_t r = 0; r < m_resources.size(); r++)
+    {
+        if(!m_resources[r].imported && m_resources[r].firstUse >= 0) { byFirstUse.push_back(static_cast<int>(r)); }
+    }
+    std::stable_sort(byFirstUse.begin(), byFirstUse.end(), [this](int a, int b) { return m_resources[a].firstUse < m_resources[b].firstUse; });
+
+    for(size_t p = 0; p < m_physical.size(); p++) { m_physical[p].busyUntil = -1; m_physical[p].used = false; }
+
+    m_stats.numResources = byFirstUse.size();
+    m_stats.unaliasedBytes = 0;
+    for(size_t i = 0; i < byFirstUse.size(); i++)
+    {
+        Resource& resource = m_resources[byFirstUse[i]];
+        int best = -1;
+
+        for(size_t p = 0; p < m_physical.size(); p++)
+        {
+            const Physical& physical = m_physical[p];
+
+            if(physical.isBuffer != resource.isBuffer || physical.busyUntil >= resource.firstUse) { continue; }
+            if(resource.isBuffer)
+            {
+                // the smallest buffer that is large enough
+                if(physical.size < resource.size) { continue; }
+                if(best < 0 || physical.size < m_physical[best].size) { best = static_cast<int>(p); }
+            }
+            else if(physical.desc.width == resource.desc.width && physical.desc.height == resource.desc.height && physical.desc.internalFormat == resource.desc.internalFormat)
+            {
+                // a pool entry used earlier this compile first: entries nobody reuses are released below
+                if(best < 0 || (physical.used && !m_physical[best].used)) { best = static_cast<int>(p); }
+            }
+        }
+        if(best < 0)
+        {
+            Physical physical = Physical();
+            physical.isBuffer = resource.isBuffer;
+            physical.desc = resource.desc;
+            physical.size = resource.size;
+            physical.object = allocate(resource.isBuffer, resource.desc, resource.size);
+            m_physical.push_back(physical);
+            best = static_cast<int>(m_physical.size()) - 1;
+        }
+
+        m_physical[best].busyUntil = resource.lastUse;
+        m_physical[best].used = true;
+        resource.physical = best;
+        resource.object = m_physical[best].object;
+        m_stats.unaliasedBytes += resource.isBuffer ? static_cast<size_t>(resource.size) : getTextureBytes(resource.desc);
+    }
+
+    // release the entries this graph no longer needs (e.g. the old size after a resize)
+    remap.assign(m_physical.size(), -1);
+    m_stats.numTextures = m_stats.numBuffers = 0;
+    m_stats.bytes = 0;
+    for(size_t p = 0; p < m_physical.size(); p++)
+    {
+        Physical& physical = m_physical[p];
+
+        if(!physical.used)
+        {
+            if(physical.isBuffer) { GLState::instance().deleteBuffers(1, &physical.object); }
+            else { GLState::instance().deleteTextures(1, &physical.object); }
+            continue;
+        }
+        remap[p] = static_cast<int>(pool.size());
+        pool.push_back(physical);
+        if(physical.isBuffer) { m_stats.numBuffers++; m_stats.bytes += static_cast<size_t>(physical.size); }
+        else { m_stats.numTextures++; m_stats.bytes += getTextureBytes(physical.desc); }
+    }
+    m_physical.swap(pool);
+    for(size_t r = 0; r < m_resources.size(); r++)
+    {
+        if(m_resources[r].physical >= 0) { m_resources[r].physical = remap[m_resources[r].physical]; }
+    }
+}
+
+// OpenGL orders framebuffer, copy and blit writes with the commands after them; only image stores and
+// shader storage writes (STORAGE) are incoherent and need glMemoryBarrier() before a later access.
+// the bit depends on how the later pass accesses the memory; aliased resources share the memory of their
+// physical entry, and the order is simulated twice so that writes at the end of a frame are seen by the next one
+void FrameGraph::planBarriers()
+{
+    // local vars
+    std::vector<char> pending(m_physical.size() + m_resources.size(), 0); // incoherent writes not yet made visible
+
+    for(int frame = 0; frame < 2; frame++)
+    {
+        for(size_t i = 0; i < m_order.size(); i++)
+        {
+            Pass& pass = m_passes[m_order[i]];
+
+            pass.barriers = 0;
+            for(size_t a = 0; a < pass.accesses.size(); a++)
+            {
+                const Resource& resource = m_resources[pass.accesses[a].resource];
+                size_t memory = resource.physical >= 0 ? static_cast<size_t>(resource.physical) : m_physical.size() + pass.accesses[a].resource;
+
+                if(pending[memory])
+                {
+                    pass.barriers |= getBarrierBits(pass.accesses[a].access, resource.isBuffer);
+                    pending[memory] = 0;
+                }
+            }
+            for(size_t a = 0; a < pass.accesses.size(); a++)
+            {
+                const Resource& resource = m_resources[pass.accesses[a].resource];
+                size_t memory = resource.physical >= 0 ? static_cast<size_t>(resource.physical) : m_physical.size() + pass.accesses[a].resource;
+
+                if(pass.accesses[a].write && pass.accesses[a].access == STORAGE) { pending[memory] = 1; }
+            }
+        }
+    }
+}
+
+// one framebuffer per pass with ATTACHMENT resources (read or written): colors in declaration order, then depth
+// the default framebuffer (imported texture 0) cannot be combined with other attachments
+bool FrameGraph::createFramebuffers()
+{
+    // local vars
+    bool complete = true;
+
+    for(size_t i = 0; i < m_order.size(); i++)
+    {
+        Pass& pass = m_passes[m_order[i]];
+        std::vector<GLenum> drawBuffers;
+        std::vector<int> attachments;
+        bool backbuffer = false;
+
+        pass.framebuffer = -1;
+        for(size_t a = 0; a < pass.accesses.size(); a++)
+        {
+            const Resource& resource = m_resources[pass.accesses[a].resource];
+
+            if(pass.accesses[a].access != ATTACHMENT || resource.isBuffer) { continue; }
+            if(resource.imported && resource.object == 0)
+            {
+                backbuffer = true;
+                m_defaultWidth = resource.desc.width;
+                m_defaultHeight = resource.desc.height;
+            }
+            else if(std::find(attachments.begin(), attachments.end(), pass.accesses[a].resource) == attachments.end()) { attachments.push_back(pass.accesses[a].resource); }
+        }
+        if(backbuffer)
+        {
+            if(!attachments.empty()) { LOG_ERROR(RENDER, "FrameGraph: pass \"{}\" attaches the default framebuffer and textures", pass.name); complete = false; }
+            pass.framebuffer = -2;
+            continue;
+        }
+        if(attachments.empty()) { continue; }
+
+        Framebuffer framebuffer = Framebuffer();
+        glGenFramebuffers(1, &framebuffer.FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.FBO);
+        for(size_t a = 0; a < attachments.size(); a++)
+        {
+            const Resource& resource = m_resources[attachments[a]];
+            GLenum attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(drawBuffers.size());
+
+            if(resource.desc.internalFormat == GL_DEPTH24_STENCIL8 || resource.desc.internalFormat == GL_DEPTH32F_STENCIL8) { attachment = GL_DEPTH_STENCIL_ATTACHMENT; }
+            else if(isDepthFormat(resource.desc.internalFormat)) { attachment = GL_DEPTH_ATTACHMENT; }
+            else { drawBuffers.push_back(attachment); }
+
+            glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, resource.object, 0);
+            framebuffer.width = resource.desc.width;
+            framebuffer.height = resource.desc.height;
+        }
+        if(drawBuffers.empty()) { glDrawBuffer(GL_NONE); glReadBuffer(GL_NONE); }
+        else { glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), &drawBuffers[0]); }
+
+        if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            LOG_ERROR(RENDER, "FrameGraph: framebuffer of pass \"{}\" is not complete", pass.name);
+            complete = false;
+        }
+        m_framebuffers.push_back(framebuffer);
+        pass.framebuffer = static_cast<int>(m_framebuffers.size()) - 1;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
+
+void FrameGraph::releaseFramebuffers()
+{
+    for(size_t i = 0; i < m_framebuffers.size(); i++) { glDeleteFramebuffers(1, &m_framebuffers[i].FBO); }
+    std::vector<Framebuffer>().swap(m_framebuffers);
+    for(size_t p = 0; p < m_passes.size(); p++) { m_passes[p].framebuffer = -1; }
+}
+
+void FrameGraph::releasePool()
+{
+    GLState& gl = GLState::instance();
+
+    for(size_t p = 0; p < m_physical.size(); p++)
+    {
+        if(m_physical[p].isBuffer) { gl.deleteBuffers(1, &m_physical[p].object); }
+        else { gl.deleteTextures(1, &m_physical[p].object); }
+    }
+    std::vector<Physical>().swap(m_physical);
+}
+
+GLuint FrameGraph::allocate(bool isBuffer, const TextureDesc& desc, GLsizeiptr size)
+{
+    // local vars
+    GLState& gl = GLState::instance();
+    GLuint object = 0;
+    GLenum format = GL_RGBA, type = GL_UNSIGNED_BYTE;
+
+    if(isBuffer)
+    {
+        glGenBuffers(1, &object);
+        gl.bindBuffer(GL_COPY_WRITE_BUFFER, object);
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_COPY);
+        return object;
+    }
+
+    getPixelFormat(desc.internalFormat, format, type);
+    glGenTextures(1, &object);
+    gl.editTexture(GL_TEXTURE_2D, object);
+    glTexImage2D(GL_TEXTURE_2D, 0, desc.internalFormat, desc.width, desc.height, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return object;
+}
+
+// access: the ACCESS of the pass reading (or overwriting) memory an earlier pass wrote with STORAGE
+GLbitfield FrameGraph::getBarrierBits(int access, bool isBuffer)
+{
+    switch(access)
+    {
+        case ATTACHMENT: return GL_FRAMEBUFFER_BARRIER_BIT;
+        case SAMPLED: return GL_TEXTURE_FETCH_BARRIER_BIT;
+        case STORAGE: return isBuffer ? GL_SHADER_STORAGE_BARRIER_BIT : GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+        case UNIFORM: return GL_UNIFORM_BARRIER_BIT;
+        case VERTEX: return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT;
+        case INDIRECT: return GL_COMMAND_BARRIER_BIT;
+        case TRANSFER: return isBuffer ? GL_BUFFER_UPDATE_BARRIER_BIT : GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT;
+        default: return GL_ALL_BARRIER_BITS;
+    }
+}
+
+// format and type for glTexImage2D() with no data (both must still match the internal format)
+void FrameGraph::getPixelFormat(GLenum internalFormat, GLenum& format, GLenum& type)
+{
+    switch(internalFormat)
+    {
+        case GL_DEPTH_COMPONENT16:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32: format = GL_DEPTH_COMPONENT; type = GL_UNSIGNED_INT; break;
+        case GL_DEPTH_COMPONENT32F: format = GL_DEPTH_COMPONENT; type = GL_FLOAT; break;
+        case GL_DEPTH24_STENCIL8: format = GL_DEPTH_STENCIL; type = GL_UNSIGNED_INT_24_8; break;
+        case GL_DEPTH32F_STENCIL8: format = GL_DEPTH_STENCIL; type = GL_FLOAT_32_UNSIGNED_INT_24_8_REV; break;
+        case GL_R8: format = GL_RED; type = GL_UNSIGNED_BYTE; break;
+        case GL_R16F:
+        case GL_R32F: format = GL_RED; type = GL_FLOAT; break;
+        case GL_RG8: format = GL_RG; type = GL_UNSIGNED_BYTE; break;
+        case GL_RG16F:
+        case GL_RG32F: format = GL_RG; type = GL_FLOAT; break;
+        case GL_R32UI: format = GL_RED_INTEGER; type = GL_UNSIGNED_INT; break;
+        case GL_RGB8: format = GL_RGB; type = GL_UNSIGNED_BYTE; break;
+        case GL_R11F_G11F_B10F:
+        case GL_RGB16F:
+        case GL_RGB32F: format = GL_RGB; type = GL_FLOAT; break;
+        case GL_RGBA16F:
+        case GL_RGBA32F: format = GL_RGBA; type = GL_FLOAT; break;
+        default: format = GL_RGBA; type = GL_UNSIGNED_BYTE; break; // GL_RGBA8, GL_SRGB8_ALPHA8, GL_RGB10_A2
+    }
+}
+
+// approximate GPU size (no padding or compression)
+size_t FrameGraph::getTextureBytes(const TextureDesc& desc)
+{
+    size_t texelBytes = 4;
+
+    switch(desc.internalFormat)
+    {
+        case GL_R8: texelBytes = 1; break;
+        case GL_R16F: case GL_RG8: case GL_DEPTH_COMPONENT16: texelBytes = 2; break;
+        case GL_RGB8: texelBytes = 3; break;
+        case GL_RGBA16F: case GL_RG32F: case GL_DEPTH32F_STENCIL8: texelBytes = 8; break;
+        case GL_RGB16F: texelBytes = 6; break;
+        case GL_RGB32F: texelBytes = 12; break;
+        case GL_RGBA32F: texelBytes = 16; break;
+        default: break; // 4 bytes: RGBA8, R32F, RG16F, R11F_G11F_B10F, R32UI, DEPTH24, DEPTH32F, DEPTH24_STENCIL8
+    }
+    return static_cast<size_t>(desc.width) * static_cast<size_t>(desc.height) * texelBytes;
+}
+
+bool FrameGraph::isDepthFormat(GLenum internalFormat)
+{
+    switch(internalFormat)
+    {
+        case GL_DEPTH_COMPONENT16:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32:
+        case GL_DEPTH_COMPONENT32F:
+        case GL_DEPTH24_STENCIL8:
+        case GL_DEPTH32F_STENCIL8: return true;
+        default: return false;
+    }
+}
@@ -0,0 +1,61 @@
+// include
+#include <FramePipeline.hpp>
+
+FramePipeline::FramePipeline() { nullify(); }
+
+FramePipeline::FramePipeline(size_t numBuffers, RecordFunction record)
+{
+    nullify();
+    start(numBuffers, record);
+}
+
+FramePipeline::~FramePipeline() { stop(); }
+
+// numBuffers: command buffers per frame (e.g. one per recording job)
+// the first frame starts recording immediately
+void FramePipeline::start(size_t numBuffers, RecordFunction record)
+{
+    stop();
+
+    m_record = record;
+    for(int i = 0; i < 2; i++)
+    {
+        m_frames[i].frameIndex = 0;
+        m_frames[i].buffers.resize(numBuffers);
+    }
+    kick(0);
+}
+
+// GL thread, once per frame:
+// wait for the frame recorded in the background, start recording the next one, then replay
+// the residency budget is enforced while no recording is in flight: the buffers the waited frame
+// touched were used in the previous residency frame, so they are kept until it is replayed
+void FramePipeline::submitFrame()
+{
+    if(!m_pending.valid()) { LOG_ERROR(RENDER, "FramePipeline::submitFrame(): pipeline is not started"); return; }
+
+    int submitIndex = m_recordIndex;
+    m_pending.get();
+    ResidencyManager::instance().beginFrame();
+    kick(1 - submitIndex);
+
+    RenderFrame& frame = m_frames[submitIndex];
+    for(size_t i = 0; i < frame.buffers.size(); i++) { frame.buffers[i].execute(); }
+}
+
+// wait for the frame in flight and drop the record function
+void FramePipeline::stop()
+{
+    if(m_pending.valid()) { m_pending.get(); }
+    nullify();
+}
+
+void FramePipeline::kick(int index)
+{
+    RenderFrame& frame = m_frames[index];
+
+    m_recordIndex = index;
+    frame.frameIndex = m_frameCounter++;
+    for(size_t i = 0; i < frame.buffers.size(); i++) { frame.buffers[i].clear(); }
+    m_pending = JobSystem::instance().async([this, &frame]() { m_record(frame); });
+}
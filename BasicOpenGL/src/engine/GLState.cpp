@@ -0,0 +1,263 @@
+// include
+#include <GLState.hpp>
+
+GLState::GLState() { nullify(); }
+
+GLState::~GLState()
+{
+    if(m_traceFile) { fclose(m_traceFile); }
+    nullify();
+}
+
+GLState& GLState::instance()
+{
+    static GLState s_glState;
+    return s_glState;
+}
+
+// tracePath: file the per-frame call log is appended to (nullptr: spdlog)
+void GLState::setTracing(bool tracing, const char* tracePath)
+{
+    if(m_traceFile) { fclose(m_traceFile); m_traceFile = nullptr; }
+    m_tracing = tracing;
+    m_trace.clear();
+    if(!tracing) { LOG_INFO(GL, "GLState::setTracing(false)"); return; }
+
+    LOG_INFO(GL, "GLState::setTracing(true, \"{}\")", tracePath ? tracePath : "");
+    if(tracePath)
+    {
+        m_traceFile = fopen(tracePath, "w");
+        if(!m_traceFile) { LOG_ERROR(GL, "failed to open GL trace file \"{}\"", tracePath); }
+    }
+}
+
+// forget every shadowed binding, e.g. after code outside include/ changed them
+void GLState::invalidate()
+{
+    m_program = m_vertexArray = m_activeUnit = UNKNOWN;
+    for(GLuint i = 0; i < MAX_TEXTURE_UNITS; i++)
+    {
+        for(int j = 0; j < NUM_TEXTURE_TARGETS; j++) { m_textures[i][j] = UNKNOWN; }
+    }
+    for(int i = 0; i < NUM_BUFFER_TARGETS; i++) { m_buffers[i] = UNKNOWN; }
+    for(GLuint i = 0; i < MAX_BUFFER_INDICES; i++) { m_uniformRanges[i].buffer = m_storageRanges[i].buffer = UNKNOWN; }
+}
+
+void GLState::useProgram(GLuint program)
+{
+    bool skipped = program == m_program;
+    record(USE_PROGRAM, skipped, 0, 0, program);
+    if(skipped) { return; }
+
+    glUseProgram(program);
+    m_program = program;
+}
+
+void GLState::bindVertexArray(GLuint vertexArray)
+{
+    bool skipped = vertexArray == m_vertexArray;
+    record(BIND_VERTEX_ARRAY, skipped, 0, 0, vertexArray);
+    if(skipped) { return; }
+
+    glBindVertexArray(vertexArray);
+    m_vertexArray = vertexArray;
+}
+
+// selects the unit only when the binding actually changes
+// e.g.) GLState::instance().bindTexture(0, GL_TEXTURE_2D, textureID);
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    int targetIndex = getTextureTarget(target);
+    bool cached = unit < MAX_TEXTURE_UNITS && targetIndex >= 0;
+    bool skipped = cached && m_textures[unit][targetIndex] == texture;
+    record(BIND_TEXTURE, skipped, target, unit, texture);
+    if(skipped) { return; }
+
+    activeTexture(unit);
+    glBindTexture(target, texture);
+    if(cached) { m_textures[unit][targetIndex] = texture; }
+}
+
+// bind texture to EDIT_UNIT and make it the active unit, so glTex*() calls that follow modify texture
+void GLState::editTexture(GLenum target, GLuint texture)
+{
+    activeTexture(EDIT_UNIT);
+    bindTexture(EDIT_UNIT, target, texture);
+}
+
+// GL_ELEMENT_ARRAY_BUFFER and targets this class does not know are passed through
+void GLState::bindBuffer(GLenum target, GLuint buffer)
+{
+    int targetIndex = getBufferTarget(target);
+    bool skipped = targetIndex >= 0 && m_buffers[targetIndex] == buffer;
+    record(BIND_BUFFER, skipped, target, 0, buffer);
+    if(skipped) { return; }
+
+    glBindBuffer(target, buffer);
+    if(targetIndex >= 0) { m_buffers[targetIndex] = buffer; }
+}
+
+// also binds buffer to the generic target, as glBindBufferRange() does
+// GL_UNIFORM_BUFFER and GL_SHADER_STORAGE_BUFFER are cached, other targets are passed through
+void GLState::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    BufferRange* ranges = target == GL_UNIFORM_BUFFER ? m_uniformRanges : target == GL_SHADER_STORAGE_BUFFER ? m_storageRanges : nullptr;
+    bool cached = ranges && index < MAX_BUFFER_INDICES;
+    bool skipped = cached && ranges[index].buffer == buffer && ranges[index].offset == offset && ranges[index].size == size;
+    record(BIND_BUFFER_RANGE, skipped, target, index, buffer);
+    if(skipped) { return; }
+
+    glBindBufferRange(target, index, buffer, offset, size);
+    if(cached)
+    {
+        ranges[index].buffer = buffer;
+        ranges[index].offset = offset;
+        ranges[index].size = size;
+    }
+    int targetIndex = getBufferTarget(target);
+    if(targetIndex >= 0) { m_buffers[targetIndex] = buffer; }
+}
+
+// a deleted program stays in use until another one is, but its name may come back from glCreateProgram()
+void GLState::deletePrograms(GLsizei n, const GLuint* programs)
+{
+    for(GLsizei i = 0; i < n; i++)
+    {
+        glDeleteProgram(programs[i]);
+        if(programs[i] == m_program) { m_program = UNKNOWN; }
+    }
+}
+
+void GLState::deleteVertexArrays(GLsizei n, const GLuint* vertexArrays)
+{
+    glDeleteVertexArrays(n, vertexArrays);
+    for(GLsizei i = 0; i < n; i++)
+    {
+        if(vertexArrays[i] == m_vertexArray) { m_vertexArray = 0; }
+    }
+}
+
+void GLState::deleteTextures(GLsizei n, const GLuint* textures)
+{
+    glDeleteTextures(n, textures);
+    for(GLsizei i = 0; i < n; i++)
+    {
+        for(GLuint unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+        {
+            for(int j = 0; j < NUM_TEXTURE_TARGETS; j++)
+            {
+                if(textures[i] && m_textures[unit][j] == textures[i]) { m_textures[unit][j] = 0; }
+            }
+        }
+    }
+}
+
+void GLState::deleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    glDeleteBuffers(n, buffers);
+    for(GLsizei i = 0; i < n; i++)
+    {
+        if(!buffers[i]) { continue; }
+        for(int j = 0; j < NUM_BUFFER_TARGETS; j++)
+        {
+            if(m_buffers[j] == buffers[i]) { m_buffers[j] = 0; }
+        }
+        for(GLuint j = 0; j < MAX_BUFFER_INDICES; j++)
+        {
+            if(m_uniformRanges[j].buffer == buffers[i]) { m_uniformRanges[j].buffer = 0; }
+            if(m_storageRanges[j].buffer == buffers[i]) { m_storageRanges[j].buffer = 0; }
+        }
+    }
+}
+
+// once per frame: keeps the counts for getFrameStats() and writes the call log when tracing
+void GLState::endFrame()
+{
+    static const char* names[NUM_CALLS] = { "glUseProgram", "glBindVertexArray", "glActiveTexture", "glBindTexture",
+        "glBindBuffer", "glBindBufferRange", "glUniform", "glDraw", "glDispatchCompute" };
+
+    if(m_tracing)
+    {
+        std::string line;
+        char buffer[128];
+
+        snprintf(buffer, sizeof(buffer), "==== frame %llu: %zu calls ====\n", static_cast<unsigned long long>(m_stats.frame), m_trace.size());
+        line = buffer;
+        for(size_t i = 0; i < m_trace.size(); i++)
+        {
+            const TraceRecord& r = m_trace[i];
+            snprintf(buffer, sizeof(buffer), "%s%s(target=0x%04x, unit=%u, name=%u)\n",
+                r.skipped ? "  (skipped) " : "", names[r.call], r.target, r.unit, r.name);
+            line += buffer;
+        }
+        for(int i = 0; i < NUM_CALLS; i++)
+        {
+            snprintf(buffer, sizeof(buffer), "%s: %zu (%zu skipped)\n", names[i], m_stats.numCalls[i], m_stats.numSkipped[i]);
+            line += buffer;
+        }
+
+        if(m_traceFile) { fputs(line.c_str(), m_traceFile); }
+        else { LOG_INFO(GL, "GL call log\n{}", line); }
+        m_trace.clear();
+    }
+
+    m_lastStats = m_stats;
+    m_stats = Stats();
+    m_stats.frame = m_lastStats.frame + 1;
+}
+
+void GLState::activeTexture(GLuint unit)
+{
+    bool skipped = unit == m_activeUnit;
+    record(ACTIVE_TEXTURE, skipped, 0, unit, 0);
+    if(skipped) { return; }
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    m_activeUnit = unit;
+}
+
+void GLState::record(uint8_t call, bool skipped, GLenum target, GLuint unit, GLuint name)
+{
+    if(skipped) { m_stats.numSkipped[call]++; }
+    else { m_stats.numCalls[call]++; }
+    if(!m_tracing) { return; }
+
+    TraceRecord r;
+    r.call = call;
+    r.skipped = skipped;
+    r.target = target;
+    r.unit = unit;
+    r.name = name;
+    m_trace.push_back(r);
+}
+
+int GLState::getTextureTarget(GLenum target)
+{
+    switch(target)
+    {
+    case GL_TEXTURE_2D: return TEX_2D;
+    case GL_TEXTURE_CUBE_MAP: return TEX_CUBE_MAP;
+    case GL_TEXTURE_BUFFER: return TEX_BUFFER;
+    case GL_TEXTURE_2D_ARRAY: return TEX_2D_ARRAY;
+    case GL_TEXTURE_3D: return TEX_3D;
+    default: return -1;
+    }
+}
+
+int GLState::getBufferTarget(GLenum target)
+{
+    switch(target)
+    {
+    case GL_ARRAY_BUFFER: return BUF_ARRAY;
+    case GL_UNIFORM_BUFFER: return BUF_UNIFORM;
+    case GL_TEXTURE_BUFFER: return BUF_TEXTURE;
+    case GL_COPY_READ_BUFFER: return BUF_COPY_READ;
+    case GL_COPY_WRITE_BUFFER: return BUF_COPY_WRITE;
+    case GL_PIXEL_PACK_BUFFER: return BUF_PIXEL_PACK;
+    case GL_PIXEL_UNPACK_BUFFER: return BUF_PIXEL_UNPACK;
+    case GL_SHADER_STORAGE_BUFFER: return BUF_SHADER_STORAGE;
+    case GL_DRAW_INDIRECT_BUFFER: return BUF_DRAW_INDIRECT;
+    case GL_PARAMETER_BUFFER: return BUF_PARAMETER; // = GL_PARAMETER_BUFFER_ARB
+    default: return -1; // includes GL_ELEMENT_ARRAY_BUFFER (VAO state)
+    }
+}
@@ -0,0 +1,425 @@
+// include
+#include <GpuScene.hpp>
+
+// std
+#include <algorithm>
+#include <cstdio>
+
+// cullShaderPath: shader/cull.comp (compiled with COMPACT when the draw count can stay on the GPU)
+// return: false without OpenGL 4.3 or if the compute shader does not compile
+bool GpuScene::init(const char* cullShaderPath)
+{
+    LOG_INFO(RENDER, "GpuScene::init(\"{}\")", cullShaderPath ? cullShaderPath : "");
+
+    if(!isSupported()) { LOG_ERROR(RENDER, "GPU-driven rendering needs OpenGL 4.3 (compute shaders, multi-draw indirect)"); return false; }
+
+    // indirect draw count: core in 4.6, ARB_indirect_parameters before
+    m_multiDrawCount = nullptr;
+    if(GLAD_GL_VERSION_4_6) { m_multiDrawCount = glMultiDrawElementsIndirectCount; }
+    else if(GLAD_GL_ARB_indirect_parameters) { m_multiDrawCount = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)glMultiDrawElementsIndirectCountARB; }
+    m_compact = m_multiDrawCount != nullptr;
+    m_stats.compact = m_compact;
+
+    m_cullProgram.loadComputeFromFile(cullShaderPath, m_compact ? "#define COMPACT\n" : "");
+    if(!m_cullProgram.getShaderProgramID()) { LOG_ERROR(RENDER, "failed to load the culling compute shader"); return false; }
+
+    LOG_INFO(RENDER, "GPU culling: {}", m_compact ? "compacted commands, draw count on the GPU" : "one command slot per instance");
+    return true;
+}
+
+// LOD 0 of a new mesh; its geometry is copied into the mega buffer by build()
+// return: mesh index for addLod()/addInstance(), -1 for meshes the GPU path cannot draw
+int GpuScene::addMesh(const Mesh& mesh)
+{
+    if(mesh.isSkinned()) { LOG_WARN(RENDER, "GpuScene::addMesh(): skinned meshes are not supported"); return -1; }
+    if(!mesh.getVBO() || !mesh.getNumIndices()) { LOG_WARN(RENDER, "GpuScene::addMesh(): empty mesh"); return -1; }
+
+    MeshRange range = MeshRange();
+    range.boundsMin = glm::vec4(mesh.getBoundsMin(), 1.0f);
+    range.boundsMax = glm::vec4(mesh.getBoundsMax(), 1.0f);
+    range.lods[0].firstIndex = static_cast<GLuint>(m_sources.size());
+    range.lods[0].distance = 1e30f;
+    range.numLods = 1;
+    range.batch = static_cast<GLuint>(findBatch(mesh));
+
+    m_sources.push_back(&mesh);
+    m_meshes.push_back(range);
+    return static_cast<int>(m_meshes.size()) - 1;
+}
+
+// lod: a coarser version of the mesh, drawn when the instance is farther than distance from the camera
+// (with the textures of LOD 0)
+// e.g.) scene.addLod(mesh, *lod1, 20.0f); scene.addLod(mesh, *lod2, 60.0f);
+void GpuScene::addLod(int mesh, const Mesh& lod, float distance)
+{
+    if(mesh < 0 || mesh >= static_cast<int>(m_meshes.size())) { LOG_ERROR(RENDER, "GpuScene::addLod(): wrong mesh {}", mesh); return; }
+    MeshRange& range = m_meshes[mesh];
+    if(range.numLods == MAX_LODS) { LOG_WARN(RENDER, "GpuScene::addLod(): more than {} LODs", MAX_LODS); return; }
+    if(lod.isSkinned() || !lod.getVBO() || !lod.getNumIndices()) { LOG_WARN(RENDER, "GpuScene::addLod(): unsupported LOD mesh"); return; }
+
+    range.lods[range.numLods - 1].distance = distance;
+    range.lods[range.numLods].firstIndex = static_cast<GLuint>(m_sources.size());
+    range.lods[range.numLods].distance = 1e30f;
+    range.numLods++;
+    m_sources.push_back(&lod);
+}
+
+// return: instance handle for setWorld()
+int GpuScene::addInstance(int mesh, const glm::mat4& world)
+{
+    if(mesh < 0 || mesh >= static_cast<int>(m_meshes.size())) { LOG_ERROR(RENDER, "GpuScene::addInstance(): wrong mesh {}", mesh); return -1; }
+    if(isBuilt()) { LOG_WARN(RENDER, "GpuScene::addInstance() after build(): drawn after the next build()"); }
+
+    Instance instance = Instance();
+    instance.world = world;
+    instance.mesh = static_cast<GLuint>(mesh);
+    m_handleToIndex.push_back(static_cast<int>(m_instances.size()));
+    m_instances.push_back(instance);
+    return static_cast<int>(m_handleToIndex.size()) - 1;
+}
+
+// uploaded by the next cull() (one glBufferSubData() for the range of changed instances)
+void GpuScene::setWorld(int handle, const glm::mat4& world)
+{
+    size_t index = static_cast<size_t>(m_handleToIndex[handle]);
+
+    m_instances[index].world = world;
+    if(m_dirtyBegin == m_dirtyEnd) { m_dirtyBegin = index; m_dirtyEnd = index + 1; }
+    else
+    {
+        m_dirtyBegin = std::min(m_dirtyBegin, index);
+        m_dirtyEnd = std::max(m_dirtyEnd, index + 1);
+    }
+}
+
+// copy the geometry into the mega buffer, sort the instances by batch and create the GPU buffers
+// may be called again after adding meshes or instances
+bool GpuScene::build()
+{
+    // local vars
+    GLState& gl = GLState::instance();
+    ResidencyManager& residency = ResidencyManager::instance();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<GLuint> firstIndices(m_sources.size());
+    std::vector<GLint> baseVertices(m_sources.size());
+    GLsizeiptr vertexBytes = 0, indexBytes = 0;
+
+    if(!m_cullProgram.getShaderProgramID()) { LOG_ERROR(RENDER, "GpuScene::build(): call init() first"); return false; }
+    if(m_instances.empty()) { LOG_WARN(RENDER, "GpuScene::build(): no instances"); return false; }
+    releaseBuffers();
+
+    // sort instances by batch: a batch's commands are one contiguous range
+    std::vector<int> order(m_instances.size());
+    for(size_t i = 0; i < order.size(); i++) { order[i] = static_cast<int>(i); }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return m_meshes[m_instances[a].mesh].batch < m_meshes[m_instances[b].mesh].batch; });
+
+    std::vector<Instance> sorted(m_instances.size());
+    std::vector<int> indexToHandle(m_handleToIndex.size());
+    for(size_t h = 0; h < m_handleToIndex.size(); h++) { indexToHandle[m_handleToIndex[h]] = static_cast<int>(h); }
+    for(size_t i = 0; i < order.size(); i++)
+    {
+        sorted[i] = m_instances[order[i]];
+        m_handleToIndex[indexToHandle[order[i]]] = static_cast<int>(i);
+    }
+    m_instances.swap(sorted);
+    m_dirtyBegin = m_dirtyEnd = 0;
+
+    for(size_t b = 0; b < m_batches.size(); b++) { m_batches[b].firstCommand = m_batches[b].numCommands = 0; }
+    for(size_t i = m_instances.size(); i-- > 0; )
+    {
+        Batch& batch = m_batches[m_meshes[m_instances[i].mesh].batch];
+        batch.firstCommand = static_cast<GLuint>(i);
+        batch.numCommands++;
+    }
+
+    // mega buffer: every source mesh is copied GPU to GPU, indices stay relative to their mesh (baseVertex)
+    for(size_t i = 0; i < m_sources.size(); i++)
+    {
+        baseVertices[i] = static_cast<GLint>(vertexBytes / sizeof(Vertex));
+        firstIndices[i] = static_cast<GLuint>(indexBytes / sizeof(GLuint));
+        vertexBytes += m_sources[i]->getVertexBytes();
+        indexBytes += static_cast<GLsizeiptr>(m_sources[i]->getNumIndices()) * sizeof(GLuint);
+    }
+    m_VBO = createBuffer(GL_COPY_WRITE_BUFFER, vertexBytes, nullptr, GL_STATIC_DRAW);
+    for(size_t i = 0; i < m_sources.size(); i++)
+    {
+        residency.makeResident(m_sources[i]->getResidency());
+        gl.bindBuffer(GL_COPY_READ_BUFFER, m_sources[i]->getVBO());
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, baseVertices[i] * static_cast<GLintptr>(sizeof(Vertex)), m_sources[i]->getVertexBytes());
+    }
+    m_EBO = createBuffer(GL_COPY_WRITE_BUFFER, indexBytes, nullptr, GL_STATIC_DRAW);
+    for(size_t i = 0; i < m_sources.size(); i++)
+    {
+        gl.bindBuffer(GL_COPY_READ_BUFFER, m_sources[i]->getEBO());
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, firstIndices[i] * static_cast<GLintptr>(sizeof(GLuint)),
+            static_cast<GLsizeiptr>(m_sources[i]->getNumIndices()) * sizeof(GLuint));
+    }
+
+    // identity buffer: the instance index attribute (divisor 1) reads element baseInstance
+    std::vector<GLuint> identity(m_instances.size());
+    for(size_t i = 0; i < identity.size(); i++) { identity[i] = static_cast<GLuint>(i); }
+    m_instanceIndexVBO = createBuffer(GL_ARRAY_BUFFER, identity.size() * sizeof(GLuint), &identity[0], GL_STATIC_DRAW);
+
+    // VAO: the layout of Mesh::load(), plus the instance index
+    glGenVertexArrays(1, &m_VAO);
+    gl.bindVertexArray(m_VAO);
+    gl.bindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, bitangent));
+    glEnableVertexAttribArray(4);
+    gl.bindBuffer(GL_ARRAY_BUFFER, m_instanceIndexVBO);
+    glVertexAttribIPointer(INSTANCE_ATTRIBUTE, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+    glVertexAttribDivisor(INSTANCE_ATTRIBUTE, 1);
+    glEnableVertexAttribArray(INSTANCE_ATTRIBUTE);
+    gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    gl.bindVertexArray(0);
+
+    // mesh ranges: source indices -> mega buffer ranges
+    std::vector<MeshRange> meshes = m_meshes;
+    for(size_t m = 0; m < meshes.size(); m++)
+    {
+        for(GLuint l = 0; l < meshes[m].numLods; l++)
+        {
+            size_t source = meshes[m].lods[l].firstIndex;
+            meshes[m].lods[l].firstIndex = firstIndices[source];
+            meshes[m].lods[l].count = static_cast<GLuint>(m_sources[source]->getNumIndices());
+            meshes[m].lods[l].baseVertex = baseVertices[source];
+        }
+    }
+    std::vector<GLuint> batchFirst(m_batches.size());
+    for(size_t b = 0; b < m_batches.size(); b++) { batchFirst[b] = m_batches[b].firstCommand; }
+
+    m_meshSSBO = createBuffer(GL_SHADER_STORAGE_BUFFER, meshes.size() * sizeof(MeshRange), &meshes[0], GL_STATIC_DRAW);
+    m_instanceSSBO = createBuffer(GL_SHADER_STORAGE_BUFFER, m_instances.size() * sizeof(Instance), &m_instances[0], GL_DYNAMIC_DRAW);
+    m_batchSSBO = createBuffer(GL_SHADER_STORAGE_BUFFER, batchFirst.size() * sizeof(GLuint), &batchFirst[0], GL_STATIC_DRAW);
+    m_commandBuffer = createBuffer(GL_SHADER_STORAGE_BUFFER, m_instances.size() * sizeof(DrawCommand), nullptr, GL_DYNAMIC_COPY);
+    m_countBuffer = createBuffer(GL_SHADER_STORAGE_BUFFER, (m_batches.size() + 1) * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY); // per batch, then the total
+    gl.bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    m_stats.numMeshes = m_meshes.size();
+    m_stats.numInstances = m_instances.size();
+    m_stats.numBatches = m_batches.size();
+    LOG_INFO(RENDER, "GpuScene::build(): {} meshes ({} with LODs), {} instances, {} batches, {:.1f} MB geometry, {:.3f} ms",
+        m_meshes.size(), m_sources.size() - m_meshes.size(), m_instances.size(), m_batches.size(),
+        (vertexBytes + indexBytes) / 1048576.0, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+// viewProj: also the transform of the OcclusionCuller that rasterized culler's occluders this frame
+// cameraPosition: world space, for LOD selection
+// a fixed number of GL calls (plus one upload of the changed instances and, with culler, of the depth pyramid)
+void GpuScene::cull(const glm::mat4& viewProj, const glm::vec3& cameraPosition, const OcclusionCuller* culler)
+{
+    // local vars
+    GLState& gl = GLState::instance();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GLuint zero = 0;
+
+    if(!isBuilt()) { return; }
+    m_viewProj = viewProj;
+
+    // moved instances
+    if(m_dirtyBegin < m_dirtyEnd)
+    {
+        gl.bindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceSSBO);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, m_dirtyBegin * sizeof(Instance), (m_dirtyEnd - m_dirtyBegin) * sizeof(Instance), &m_instances[m_dirtyBegin]);
+        m_dirtyBegin = m_dirtyEnd = 0;
+    }
+
+    // per-frame uniforms
+    m_cullProgram.use();
+    glm::mat4 vp = viewProj;
+    glm::vec3 camera = cameraPosition;
+    m_cullProgram.setMat4("viewProj", vp);
+    m_cullProgram.setVec3("cameraPosition", camera);
+    glUniform1ui(m_cullProgram.getUniformLocation("numInstances"), static_cast<GLuint>(m_instances.size()));
+    glUniform1ui(m_cullProgram.getUniformLocation("numBatches"), static_cast<GLuint>(m_batches.size()));
+    m_cullProgram.setInt("numHiZLevels", 0);
+    if(culler && culler->getNumLevels()) { uploadHiZ(*culler); }
+
+    // counters start at 0; every command slot is rewritten
+    gl.bindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+    gl.bindBufferRange(GL_SHADER_STORAGE_BUFFER, MESH_BINDING, m_meshSSBO, 0, m_meshes.size() * sizeof(MeshRange));
+    gl.bindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, m_instanceSSBO, 0, m_instances.size() * sizeof(Instance));
+    gl.bindBufferRange(GL_SHADER_STORAGE_BUFFER, BATCH_BINDING, m_batchSSBO, 0, m_batches.size() * sizeof(GLuint));
+    gl.bindBufferRange(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, m_commandBuffer, 0, m_instances.size() * sizeof(DrawCommand));
+    gl.bindBufferRange(GL_SHADER_STORAGE_BUFFER, COUNT_BINDING, m_countBuffer, 0, (m_batches.size() + 1) * sizeof(GLuint));
+    if(m_hizSSBO) { gl.bindBufferRange(GL_SHADER_STORAGE_BUFFER, HIZ_BINDING, m_hizSSBO, 0, m_hizBytes); }
+
+    m_cullProgram.dispatch(static_cast<GLuint>((m_instances.size() + GROUP_SIZE - 1) / GROUP_SIZE));
+
+    // commands and counts are read as indirect parameters (and by readNumVisible())
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    m_stats.cullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// one multi-draw per batch: its program, its textures, its range of commands
+// program: the variant of variants for the batch's features, with indirect.vs as the vertex stage
+void GpuScene::draw(ShaderVariants& variants)
+{
+    // local vars
+    GLState& gl = GLState::instance();
+    ResidencyManager& residency = ResidencyManager::instance();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if(!isBuilt()) { return; }
+
+    gl.bindVertexArray(m_VAO);
+    gl.bindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+    if(m_compact) { gl.bindBuffer(GL_PARAMETER_BUFFER, m_countBuffer); }
+    gl.bindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, m_instanceSSBO, 0, m_instances.size() * sizeof(Instance));
+
+    for(size_t b = 0; b < m_batches.size(); b++)
+    {
+        // local vars
+        const Batch& batch = m_batches[b];
+        int numDiffuse, numSpecular, numNormal, numHeight;
+        numDiffuse = numSpecular = numNormal = numHeight = 0;
+
+        if(!batch.numCommands) { continue; }
+
+        ShaderProgram& program = variants.get(batch.features);
+        program.use();
+        program.setMat4("viewProj", m_viewProj);
+
+        // bind textures (same sampler names as Mesh::draw())
+        for(size_t i = 0; i < batch.textures.size(); i++)
+        {
+            char uniformName[32];
+            switch (batch.textures[i].type)
+            {
+            case Texture::TYPE::DIFFUSE: snprintf(uniformName, sizeof(uniformName), "diffuseMap%d", numDiffuse++); break;
+            case Texture::TYPE::SPECULAR: snprintf(uniformName, sizeof(uniformName), "specularMap%d", numSpecular++); break;
+            case Texture::TYPE::NORMAL: snprintf(uniformName, sizeof(uniformName), "normalMap%d", numNormal++); break;
+            case Texture::TYPE::HEIGHT: snprintf(uniformName, sizeof(uniformName), "heightMap%d", numHeight++); break;
+            default: continue;
+            }
+            residency.makeResident(batch.textures[i].residency);
+            gl.bindTexture(static_cast<GLuint>(i), GL_TEXTURE_2D, batch.textures[i].textureID);
+            program.setSampler(uniformName, static_cast<int>(i));
+        }
+
+        const void* commands = (const void*)(static_cast<uintptr_t>(batch.firstCommand) * sizeof(DrawCommand));
+        gl.traceDraw(GL_TRIANGLES, batch.numCommands);
+        if(m_compact)
+        {
+            m_multiDrawCount(GL_TRIANGLES, GL_UNSIGNED_INT, commands, static_cast<GLintptr>(b * sizeof(GLuint)), static_cast<GLsizei>(batch.numCommands), 0);
+        }
+        else { glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, commands, static_cast<GLsizei>(batch.numCommands), 0); }
+    }
+
+    m_stats.drawMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// visible instances of the last cull(); waits for the GPU, so only for statistics
+size_t GpuScene::readNumVisible()
+{
+    GLuint numVisible = 0;
+
+    if(!isBuilt()) { return 0; }
+    GLState::instance().bindBuffer(GL_COPY_READ_BUFFER, m_countBuffer);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, m_batches.size() * sizeof(GLuint), sizeof(GLuint), &numVisible);
+    m_stats.numVisible = numVisible;
+    return numVisible;
+}
+
+// meshes with the same features and the same textures share a batch
+int GpuScene::findBatch(const Mesh& mesh)
+{
+    const std::vector<Texture>& textures = mesh.getTextures();
+
+    for(size_t b = 0; b < m_batches.size(); b++)
+    {
+        const Batch& batch = m_batches[b];
+        if(batch.features != mesh.getFeatures() || batch.textures.size() != textures.size()) { continue; }
+
+        bool same = true;
+        for(size_t i = 0; i < textures.size() && same; i++)
+        {
+            same = batch.textures[i].textureID == textures[i].textureID && batch.textures[i].type == textures[i].type;
+        }
+        if(same) { return static_cast<int>(b); }
+    }
+
+    Batch batch;
+    batch.features = mesh.getFeatures();
+    batch.textures = textures;
+    batch.firstCommand = batch.numCommands = 0;
+    m_batches.push_back(batch);
+    return static_cast<int>(m_batches.size()) - 1;
+}
+
+// the max-depth levels of the occluder pyramid, one after another in a shader storage buffer
+// hizLevels[l] = (width, height, offset of the level, 0)
+void GpuScene::uploadHiZ(const OcclusionCuller& culler)
+{
+    // local vars
+    GLState& gl = GLState::instance();
+    int numLevels = std::min(culler.getNumLevels(), MAX_HIZ_LEVELS);
+    GLint levels[MAX_HIZ_LEVELS * 4];
+    GLsizeiptr bytes = 0;
+
+    for(int l = 0; l < numLevels; l++)
+    {
+        levels[l * 4 + 0] = culler.getLevelWidth(l);
+        levels[l * 4 + 1] = culler.getLevelHeight(l);
+        levels[l * 4 + 2] = static_cast<GLint>(bytes / sizeof(float));
+        levels[l * 4 + 3] = 0;
+        bytes += culler.getMaxDepth(l).size() * sizeof(float);
+    }
+
+    if(!m_hizSSBO) { glGenBuffers(1, &m_hizSSBO); }
+    gl.bindBuffer(GL_SHADER_STORAGE_BUFFER, m_hizSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, nullptr, GL_STREAM_DRAW); // orphan the previous frame's pyramid
+    for(int l = 0; l < numLevels; l++)
+    {
+        const std::vector<float>& depth = culler.getMaxDepth(l);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, levels[l * 4 + 2] * static_cast<GLintptr>(sizeof(float)), depth.size() * sizeof(float), &depth[0]);
+    }
+    m_hizBytes = bytes;
+
+    glUniform4iv(m_cullProgram.getUniformLocation("hizLevels"), numLevels, levels);
+    m_cullProgram.setInt("numHiZLevels", numLevels);
+}
+
+// leaves the buffer bound to target
+GLuint GpuScene::createBuffer(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    GLuint buffer = 0;
+
+    glGenBuffers(1, &buffer);
+    GLState::instance().bindBuffer(target, buffer);
+    glBufferData(target, size, data, usage);
+    return buffer;
+}
+
+void GpuScene::releaseBuffers()
+{
+    GLState& gl = GLState::instance();
+    GLuint buffers[] = { m_VBO, m_EBO, m_instanceIndexVBO, m_meshSSBO, m_instanceSSBO, m_batchSSBO, m_commandBuffer, m_countBuffer, m_hizSSBO };
+
+    if(m_VAO) { gl.deleteVertexArrays(1, &m_VAO); }
+    for(size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++)
+    {
+        if(buffers[i]) { gl.deleteBuffers(1, &buffers[i]); }
+    }
+    m_VAO = m_VBO = m_EBO = m_instanceIndexVBO = 0;
+    m_meshSSBO = m_instanceSSBO = m_batchSSBO = m_commandBuffer = m_countBuffer = m_hizSSBO = 0;
+    m_hizBytes = 0;
+}
+
+void GpuScene::release()
+{
+    releaseBuffers();
+    nullify();
+}
@@ -0,0 +1,106 @@
+// include
+#include <HeadlessContext.hpp>
+
+// creates the context, makes it current on this thread and loads GL with glad
+bool HeadlessContext::create()
+{
+    // local vars
+    EGLint major, minor, numConfigs;
+    EGLConfig config;
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS); // nullptr without EGL_EXT_client_extensions
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE };
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE };
+    const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+
+    if(m_context != EGL_NO_CONTEXT)
+    {
+        LOG_WARN(GL, "destroy existing headless context");
+        destroy();
+    }
+
+    // display
+    if(hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if(getPlatformDisplay) { m_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr); }
+    }
+    if(m_display == EGL_NO_DISPLAY) { m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY); }
+    if(m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, &major, &minor))
+    {
+        LOG_ERROR(GL, "failed to initialize EGL display (0x{:x})", eglGetError());
+        m_display = EGL_NO_DISPLAY;
+        return false;
+    }
+    LOG_INFO(GL, "EGL {}.{} ({})", major, minor, eglQueryString(m_display, EGL_VENDOR));
+
+    // context
+    if(!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(m_display, configAttribs, &config, 1, &numConfigs) || numConfigs < 1)
+    {
+        LOG_ERROR(GL, "no EGL config for desktop OpenGL (0x{:x})", eglGetError());
+        destroy();
+        return false;
+    }
+    m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, contextAttribs);
+    if(m_context == EGL_NO_CONTEXT)
+    {
+        LOG_ERROR(GL, "failed to create OpenGL 3.3 core context (0x{:x})", eglGetError());
+        destroy();
+        return false;
+    }
+
+    // surface
+    if(!hasExtension(eglQueryString(m_display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        m_surface = eglCreatePbufferSurface(m_display, config, pbufferAttribs);
+        if(m_surface == EGL_NO_SURFACE) { LOG_ERROR(GL, "failed to create pbuffer surface (0x{:x})", eglGetError()); destroy(); return false; }
+    }
+    if(!eglMakeCurrent(m_display, m_surface, m_surface, m_context))
+    {
+        LOG_ERROR(GL, "failed to make the headless context current (0x{:x})", eglGetError());
+        destroy();
+        return false;
+    }
+
+    if(!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        LOG_ERROR(GL, "failed to load OpenGL functions");
+        destroy();
+        return false;
+    }
+    LOG_INFO(GL, "headless context: {} ({})", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+    return true;
+}
+
+void HeadlessContext::destroy()
+{
+    if(m_display == EGL_NO_DISPLAY) { return; }
+
+    eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if(m_surface != EGL_NO_SURFACE) { eglDestroySurface(m_display, m_surface); }
+    if(m_context != EGL_NO_CONTEXT) { eglDestroyContext(m_display, m_context); }
+    eglTerminate(m_display);
+    nullify();
+}
+
+// whole-word match in a space-separated extension string
+bool HeadlessContext::hasExtension(const char* extensions, const char* name)
+{
+    if(!extensions) { return false; }
+
+    size_t length = strlen(name);
+    for(const char* p = strstr(extensions, name); p; p = strstr(p + length, name))
+    {
+        if((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0')) { return true; }
+    }
+    return false;
+}
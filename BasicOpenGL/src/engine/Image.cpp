@@ -0,0 +1,236 @@
+// stb
+#include <stb/stb_image.h>
+
+// include
+#include <Image.hpp>
+
+int Image::s_flipVertically = 0;
+int Image::s_demoteLevels = 2;
+
+Image::Image() { nullify(); }
+
+// e.g.) Shader myS("lena_std.tif", GL_TEXTURE_2D);
+Image::Image(const char* imagePath, GLenum target)
+{
+    nullify();
+    loadFromFile(imagePath, target);
+}
+
+Image::~Image()
+{
+    if(m_imageID)
+    {
+        ResidencyManager::instance().remove(m_residency);
+        GLState::instance().deleteTextures(1, &m_imageID);
+        nullify();
+    }
+}
+
+void Image::setFlipVerticallyOnLoad(int flag_true_if_should_flip)
+{
+    s_flipVertically = flag_true_if_should_flip;
+    stbi_set_flip_vertically_on_load(flag_true_if_should_flip);
+}
+
+// number of top mip levels dropped when ResidencyManager demotes a texture (default: 2, 1/16 of the memory)
+void Image::setDemoteLevels(int levels) { s_demoteLevels = levels; }
+
+void Image::setTexParameter(GLenum target, GLenum pname, GLint param) { glTexParameteri(target, pname, param); }
+void Image::setTexParameter(GLenum target, GLenum pname, GLfloat param) { glTexParameterf(target, pname, param); }
+
+// e.g.) Shader myS("lena_std.tif", GL_TEXTURE_2D);
+// TODO
+// add implemetations for GL_TEXTURE_CUBE_MAP and others
+void Image::loadFromFile(const char* imagePath, GLenum target)
+{
+    // local vars
+    unsigned char* data;
+    GLenum format;
+
+    // check filepath
+    if(!imagePath) { LOG_ERROR(ASSET, "Image::loadFromFile(nullptr): null filepath"); return; }
+    LOG_DEBUG(ASSET, "Image::loadFromFile(\"{}\")", imagePath);
+
+    // delete existing image
+    if(m_imageID)
+    {
+        LOG_WARN(ASSET, "delete existing image (ImageID={})", m_imageID);
+        ResidencyManager::instance().remove(m_residency);
+        GLState::instance().deleteTextures(1, &m_imageID);
+        nullify();
+    }
+
+    // open image file
+    data = decode(imagePath, &m_width, &m_height, &m_nrChannels);
+    if(!data) { LOG_ERROR(ASSET, "no such image file"); return; }
+    format = getFormat();
+
+    // generate texture object
+    glGenTextures(1, &m_imageID);
+    if(!m_imageID)
+    {
+        LOG_ERROR(ASSET, "failed to generate texture");
+        nullify(); // due to decode()
+        return;
+    }
+
+    // bind texture object and generate texture
+    switch (target)
+    {
+    case GL_TEXTURE_2D:
+        GLState::instance().editTexture(target, m_imageID);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, m_width, m_height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        break;
+    
+    default:
+        LOG_ERROR(ASSET, "wrong or unimplemented target");
+        GLState::instance().deleteTextures(1, &m_imageID);
+        nullify();
+        return;
+    }
+
+    // free image buffer
+    stbi_image_free(data);
+    
+    LOG_DEBUG(ASSET, "ImageID = {}", m_imageID);
+    m_imagePath = imagePath;
+    m_flipVertically = s_flipVertically;
+
+    // track GPU memory (evict/demote/restore run on the GL thread)
+    m_residency = ResidencyManager::instance().add(ResidencyEntry::TEXTURE, getMipChainBytes(m_width, m_height),
+        [this]() { return evict(); }, [this]() { return demote(); }, [this]() { return restore(); });
+}
+
+GLenum Image::getFormat()
+{
+    switch(m_nrChannels)
+    {
+    case 1:
+        return GL_RED;
+    case 2:
+        return GL_RG;
+    case 3:
+    default:
+        return GL_RGB;
+    case 4:
+        return GL_RGBA;
+    }
+}
+
+// level 0 of width x height and all of its mips
+size_t Image::getMipChainBytes(int width, int height)
+{
+    size_t bytes = 0;
+    while(true)
+    {
+        bytes += static_cast<size_t>(width) * height * m_nrChannels;
+        if(width == 1 && height == 1) { break; }
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return bytes;
+}
+
+// free mip levels [first, last level of the full-size chain] (texture must be bound)
+void Image::releaseLevels(int first)
+{
+    int numLevels = 1;
+    for(int size = (m_width > m_height ? m_width : m_height); size > 1; size /= 2) { numLevels++; }
+
+    for(int level = first; level < numLevels; level++)
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, getFormat(), 0, 0, 0, getFormat(), GL_UNSIGNED_BYTE, nullptr);
+    }
+}
+
+// keep the texture name but shrink it to a 1x1 gray placeholder
+// return: bytes left on the GPU
+size_t Image::evict()
+{
+    // local vars
+    GLint unpackAlignment;
+    const unsigned char gray[4] = { 128, 128, 128, 255 };
+
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+    GLState::instance().editTexture(GL_TEXTURE_2D, m_imageID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, getFormat(), 1, 1, 0, getFormat(), GL_UNSIGNED_BYTE, gray);
+    releaseLevels(1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0); // 1x1 level 0 alone is complete
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+    LOG_DEBUG(ASSET, "Image::evict() \"{}\"", m_imagePath);
+    return static_cast<size_t>(m_nrChannels);
+}
+
+// drop the top s_demoteLevels mips: read back a lower mip and make it the new level 0
+// return: bytes left on the GPU
+size_t Image::demote()
+{
+    // local vars
+    GLint packAlignment, unpackAlignment;
+    int width, height;
+    std::vector<unsigned char> pixels;
+
+    width = m_width >> s_demoteLevels;
+    height = m_height >> s_demoteLevels;
+    if(s_demoteLevels <= 0 || width < 1 || height < 1) { return getMipChainBytes(m_width, m_height); }
+
+    glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+    GLState::instance().editTexture(GL_TEXTURE_2D, m_imageID);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    pixels.resize(static_cast<size_t>(width) * height * m_nrChannels);
+    glGetTexImage(GL_TEXTURE_2D, s_demoteLevels, getFormat(), GL_UNSIGNED_BYTE, &pixels[0]);
+    releaseLevels(0);
+    glTexImage2D(GL_TEXTURE_2D, 0, getFormat(), width, height, 0, getFormat(), GL_UNSIGNED_BYTE, &pixels[0]);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, packAlignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+    LOG_DEBUG(ASSET, "Image::demote() \"{}\" {}x{} -> {}x{}", m_imagePath, m_width, m_height, width, height);
+    return getMipChainBytes(width, height);
+}
+
+// reload the full-size image from m_imagePath
+// return: bytes on the GPU
+size_t Image::restore()
+{
+    // local vars
+    unsigned char* data;
+    int width, height, nrChannels;
+
+    stbi_set_flip_vertically_on_load(m_flipVertically);
+    data = decode(m_imagePath.c_str(), &width, &height, &nrChannels);
+    stbi_set_flip_vertically_on_load(s_flipVertically);
+    if(!data || width != m_width || height != m_height || nrChannels != m_nrChannels)
+    {
+        LOG_ERROR(ASSET, "Image::restore(): \"{}\" is missing or changed on disk", m_imagePath);
+        if(data) { stbi_image_free(data); }
+        return static_cast<size_t>(m_nrChannels); // keep the placeholder
+    }
+
+    GLState::instance().editTexture(GL_TEXTURE_2D, m_imageID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000); // GL default
+    glTexImage2D(GL_TEXTURE_2D, 0, getFormat(), m_width, m_height, 0, getFormat(), GL_UNSIGNED_BYTE, data);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    stbi_image_free(data);
+    LOG_DEBUG(ASSET, "Image::restore() \"{}\"", m_imagePath);
+    return getMipChainBytes(m_width, m_height);
+}
+
+// FileSystem (asset pack or loose file) -> stbi_load_from_memory(), channels as stored in the file
+// return: pixels to be freed by stbi_image_free(), nullptr (error)
+unsigned char* Image::decode(const char* imagePath, int* width, int* height, int* nrChannels)
+{
+    VirtualFile imageFile;
+
+    if(!imageFile.open(imagePath)) { return nullptr; }
+    return stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(imageFile.getData()), static_cast<int>(imageFile.getSize()),
+        width, height, nrChannels, 0);
+}
@@ -0,0 +1,112 @@
+// include
+#include <JobSystem.hpp>
+
+// numWorkers: number of background threads (0 = run everything on the calling thread)
+JobSystem::JobSystem(unsigned int numWorkers)
+{
+    m_quit = false;
+    for(unsigned int i = 0; i < numWorkers; i++) { m_workers.emplace_back(&JobSystem::workerLoop, this); }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_cv.notify_all();
+    for(size_t i = 0; i < m_workers.size(); i++) { m_workers[i].join(); }
+}
+
+// one worker per hardware thread, minus the calling (main) thread
+JobSystem& JobSystem::instance()
+{
+    static JobSystem s_jobSystem(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return s_jobSystem;
+}
+
+// e.g.) JobSystem::instance().parallelFor(numVertices, 4096, [&](size_t begin, size_t end) { ... });
+//
+// splits [0, count) into chunks of (at least) grain elements and blocks until every chunk is done
+// fn(begin, end) must be safe to call concurrently for disjoint ranges
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn)
+{
+    struct Batch
+    {
+        const std::function<void(size_t, size_t)>* fn;
+        size_t count, grain, numChunks;
+        std::atomic<size_t> next, done;
+    };
+
+    if(!count) { return; }
+    if(!grain) { grain = 1; }
+
+    // small ranges (or no workers): run inline
+    size_t numChunks = (count + grain - 1) / grain;
+    if(numChunks == 1 || m_workers.empty()) { fn(0, count); return; }
+
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+    batch->fn = &fn;
+    batch->count = count;
+    batch->grain = grain;
+    batch->numChunks = numChunks;
+    batch->next = 0;
+    batch->done = 0;
+
+    // grab chunks until none are left
+    // batch->fn is only dereferenced for a valid chunk, i.e. while the caller is still waiting
+    auto drain = [batch]()
+    {
+        size_t chunk;
+        while((chunk = batch->next.fetch_add(1)) < batch->numChunks)
+        {
+            size_t begin = chunk * batch->grain;
+            size_t end = std::min(begin + batch->grain, batch->count);
+            (*batch->fn)(begin, end);
+            batch->done.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    size_t numHelpers = std::min(numChunks - 1, m_workers.size());
+    for(size_t i = 0; i < numHelpers; i++) { push(drain); }
+
+    drain();
+    while(batch->done.load(std::memory_order_acquire) < numChunks) { std::this_thread::yield(); }
+}
+
+// run a single task on a worker thread
+std::future<void> JobSystem::async(std::function<void()> task)
+{
+    std::shared_ptr<std::packaged_task<void()>> pTask = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    std::future<void> result = pTask->get_future();
+
+    if(m_workers.empty()) { (*pTask)(); }
+    else { push([pTask]() { (*pTask)(); }); }
+
+    return result;
+}
+
+void JobSystem::push(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+}
+
+void JobSystem::workerLoop()
+{
+    while(true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_quit || !m_queue.empty(); });
+            if(m_quit && m_queue.empty()) { return; }
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        task();
+    }
+}
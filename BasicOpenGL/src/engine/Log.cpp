@@ -0,0 +1,53 @@
+// spdlog
+#include <spdlog/cfg/helpers.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+// include
+#include <Log.hpp>
+
+const char* Log::s_names[Log::NUM_SUBSYSTEMS] = { "core", "gl", "asset", "render", "animation" };
+
+Log::Log()
+{
+    spdlog::init_thread_pool(QUEUE_SIZE, 1);
+    std::shared_ptr<spdlog::sinks::stdout_color_sink_mt> sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+
+    for(int i = 0; i < NUM_SUBSYSTEMS; i++)
+    {
+        m_loggers[i] = std::make_shared<spdlog::async_logger>(s_names[i], sink, spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+        m_loggers[i]->flush_on(spdlog::level::err);
+        m_rawLoggers[i] = m_loggers[i].get();
+        if(i != CORE) { spdlog::register_logger(m_loggers[i]); }
+    }
+    spdlog::set_default_logger(m_loggers[CORE]); // registers it as "core"
+}
+
+// drains the queue and stops the background thread
+Log::~Log()
+{
+    flush();
+    spdlog::shutdown();
+}
+
+Log& Log::instance()
+{
+    static Log s_log;
+    return s_log;
+}
+
+// e.g.) Log::setLevel(Log::ASSET, spdlog::level::debug);
+void Log::setLevel(int subsystem, spdlog::level::level_enum level) { instance().m_loggers[subsystem]->set_level(level); }
+
+// levels: "<subsystem>=<level>,..." or a single "<level>" for all subsystems, nullptr is ignored
+// subsystems: core, gl, asset, render, animation; levels: trace, debug, info, warn, err, critical, off
+// e.g.) Log::setLevels(getenv("LOG_LEVELS"));
+void Log::setLevels(const char* levels)
+{
+    instance();
+    if(levels) { spdlog::cfg::helpers::load_levels(levels); }
+}
+
+void Log::flush()
+{
+    for(int i = 0; i < NUM_SUBSYSTEMS; i++) { instance().m_loggers[i]->flush(); }
+}
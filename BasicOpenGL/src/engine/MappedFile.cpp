@@ -0,0 +1,92 @@
+// include
+#include <MappedFile.hpp>
+
+MappedFile::MappedFile() { nullify(); }
+
+MappedFile::MappedFile(const char* filePath)
+{
+    nullify();
+    open(filePath);
+}
+
+MappedFile::~MappedFile() { close(); }
+
+// e.g.) MappedFile file; if(file.open("model.obj")) { parse(file.getData(), file.getSize()); }
+// return: true (mapped), false (error)
+bool MappedFile::open(const char* filePath)
+{
+    // check filepath
+    if(!filePath) { LOG_ERROR(ASSET, "MappedFile::open(nullptr): null filepath"); return false; }
+
+    // close existing mapping
+    if(m_data) { close(); }
+
+#ifdef _WIN32
+    LARGE_INTEGER size;
+
+    m_file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(m_file == INVALID_HANDLE_VALUE) { LOG_ERROR(ASSET, "no such file: \"{}\"", filePath); nullify(); return false; }
+    if(!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+    {
+        LOG_ERROR(ASSET, "empty or unreadable file: \"{}\"", filePath);
+        CloseHandle(m_file);
+        nullify();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(m_mapping) { m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)); }
+    if(!m_data)
+    {
+        LOG_ERROR(ASSET, "failed to map file: \"{}\"", filePath);
+        if(m_mapping) { CloseHandle(m_mapping); }
+        CloseHandle(m_file);
+        nullify();
+        return false;
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+#else
+    struct stat st;
+    void* data;
+
+    m_fd = ::open(filePath, O_RDONLY);
+    if(m_fd < 0) { LOG_ERROR(ASSET, "no such file: \"{}\"", filePath); nullify(); return false; }
+    if(fstat(m_fd, &st) || st.st_size == 0)
+    {
+        LOG_ERROR(ASSET, "empty or unreadable file: \"{}\"", filePath);
+        ::close(m_fd);
+        nullify();
+        return false;
+    }
+
+    data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if(data == MAP_FAILED)
+    {
+        LOG_ERROR(ASSET, "failed to map file: \"{}\"", filePath);
+        ::close(m_fd);
+        nullify();
+        return false;
+    }
+    madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    m_data = static_cast<const char*>(data);
+    m_size = static_cast<size_t>(st.st_size);
+#endif
+
+    m_filePath = filePath;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(!m_data) { return; }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    CloseHandle(m_file);
+#else
+    munmap(const_cast<char*>(m_data), m_size);
+    ::close(m_fd);
+#endif
+    nullify();
+}
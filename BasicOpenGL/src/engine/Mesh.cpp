@@ -0,0 +1,317 @@
+// include
+#include <Mesh.hpp>
+
+void Mesh::nullify()
+{
+    m_VAO = m_VBO = m_EBO = 0;
+    m_boneVBO = 0;
+    m_vertexBytes = m_indexBytes = m_boneBytes = 0;
+    m_residency = nullptr;
+    std::vector<unsigned char>().swap(m_evictedVertices);
+    std::vector<unsigned char>().swap(m_evictedIndices);
+    std::vector<unsigned char>().swap(m_evictedBones);
+    std::vector<Texture>().swap(m_textures); // anonymous object
+    m_features = 0;
+    m_boundsMin = m_boundsMax = glm::vec3(0.0f);
+    std::vector<glm::vec3>().swap(m_occluderPositions);
+    std::vector<unsigned int>().swap(m_occluderIndices);
+}
+
+Mesh::Mesh() { nullify(); }
+
+Mesh::Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Texture>& textures)
+{
+    nullify();
+    load(vertices, indices, textures);
+}
+
+Mesh::~Mesh() { if(m_VAO) { release(); } }
+
+void Mesh::release()
+{
+    GLState& gl = GLState::instance();
+    ResidencyManager::instance().remove(m_residency);
+    gl.deleteVertexArrays(1, &m_VAO);
+    if(m_VBO) { gl.deleteBuffers(1, &m_VBO); }
+    if(m_EBO) { gl.deleteBuffers(1, &m_EBO); }
+    if(m_boneVBO) { gl.deleteBuffers(1, &m_boneVBO); }
+    nullify();
+}
+
+void Mesh::load(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Texture>& textures)
+{
+    LOG_DEBUG(ASSET, "Mesh::load()");
+
+    // delete existing mesh
+    if(m_VAO)
+    {
+        LOG_WARN(ASSET, "delete existing Mesh (VAO={})", m_VAO);
+        release();
+    }
+
+    // generate VAO, EBO, and EBO
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+    if(!(m_VAO && m_VBO && m_EBO))
+    {
+        LOG_ERROR(ASSET, "failed to generate VAO, VBO, or EBO");
+        if(m_VAO) { GLState::instance().deleteVertexArrays(1, &m_VAO); }
+        if(m_VBO) { GLState::instance().deleteBuffers(1, &m_VBO); }
+        if(m_EBO) { GLState::instance().deleteBuffers(1, &m_EBO); }
+        nullify();
+        return;
+    }
+
+    // bind VAO
+    GLState::instance().bindVertexArray(m_VAO);
+
+    // bind and buffer VBO
+    GLState::instance().bindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    m_vertexBytes = vertices.size() * sizeof(Vertex);
+    glBufferData(GL_ARRAY_BUFFER, m_vertexBytes, &vertices[0], GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, bitangent));
+    glEnableVertexAttribArray(4);
+
+    // bind and buffer EBO
+    GLState::instance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    m_indexBytes = indices.size() * sizeof(unsigned int);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexBytes, &indices[0], GL_STATIC_DRAW);
+    m_numIndices = static_cast<GLuint>(indices.size());
+
+    // store textures (ID and type)
+    m_textures = textures;
+
+    // minimal shader variant: one keyword per texture type in use
+    for(size_t i = 0; i < m_textures.size(); i++)
+    {
+        switch (m_textures[i].type)
+        {
+        case Texture::TYPE::DIFFUSE: m_features |= 1u << ShaderVariants::DIFFUSE_MAP; break;
+        case Texture::TYPE::SPECULAR: m_features |= 1u << ShaderVariants::SPECULAR_MAP; break;
+        case Texture::TYPE::NORMAL: m_features |= 1u << ShaderVariants::NORMAL_MAP; break;
+        case Texture::TYPE::HEIGHT: m_features |= 1u << ShaderVariants::HEIGHT_MAP; break;
+        default: break;
+        }
+    }
+
+    // bounding box
+    if(vertices.size())
+    {
+        m_boundsMin = m_boundsMax = vertices[0].position;
+        for(size_t i = 1; i < vertices.size(); i++)
+        {
+            m_boundsMin = glm::min(m_boundsMin, vertices[i].position);
+            m_boundsMax = glm::max(m_boundsMax, vertices[i].position);
+        }
+    }
+
+    // unbind VAO
+    GLState::instance().bindVertexArray(0);
+
+    // track GPU memory (evict/restore run on the GL thread)
+    m_residency = ResidencyManager::instance().add(ResidencyEntry::BUFFER, m_vertexBytes + m_indexBytes,
+        [this]() { return evict(); }, nullptr, [this]() { return restore(); });
+
+    LOG_DEBUG(ASSET, "Mesh.VAO = {}", m_VAO);
+}
+
+// bone IDs (location 5, ivec4) and weights (location 6, vec4), one entry per vertex
+// the mesh then needs the SKINNED shader variant
+void Mesh::setBoneData(std::vector<VertexBoneData>& boneData)
+{
+    if(!m_VAO || boneData.empty()) { return; }
+
+    if(!m_boneVBO) { glGenBuffers(1, &m_boneVBO); }
+    if(!m_boneVBO) { LOG_ERROR(ASSET, "failed to generate bone VBO"); return; }
+
+    // evict() and restore() handle all three buffers together
+    ResidencyManager::instance().makeResident(m_residency);
+
+    GLState::instance().bindVertexArray(m_VAO);
+    GLState::instance().bindBuffer(GL_ARRAY_BUFFER, m_boneVBO);
+    m_boneBytes = boneData.size() * sizeof(VertexBoneData);
+    glBufferData(GL_ARRAY_BUFFER, m_boneBytes, &boneData[0], GL_STATIC_DRAW);
+
+    glVertexAttribIPointer(5, 4, GL_INT, sizeof(VertexBoneData), (void*)offsetof(VertexBoneData, boneIDs));
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(VertexBoneData), (void*)offsetof(VertexBoneData, weights));
+    glEnableVertexAttribArray(6);
+    GLState::instance().bindVertexArray(0);
+    ResidencyManager::instance().resize(m_residency, m_vertexBytes + m_indexBytes + m_boneBytes);
+
+    m_features |= 1u << ShaderVariants::SKINNED;
+}
+
+// copy VBO, EBO (and bone VBO) to system memory and free their storage
+// GL_COPY_READ_BUFFER keeps the VAO (and its element buffer binding) untouched
+// return: bytes left on the GPU
+size_t Mesh::evict()
+{
+    m_evictedVertices.resize(m_vertexBytes);
+    GLState::instance().bindBuffer(GL_COPY_READ_BUFFER, m_VBO);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, m_vertexBytes, &m_evictedVertices[0]);
+    glBufferData(GL_COPY_READ_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+
+    m_evictedIndices.resize(m_indexBytes);
+    GLState::instance().bindBuffer(GL_COPY_READ_BUFFER, m_EBO);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, m_indexBytes, &m_evictedIndices[0]);
+    glBufferData(GL_COPY_READ_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+
+    if(m_boneVBO)
+    {
+        m_evictedBones.resize(m_boneBytes);
+        GLState::instance().bindBuffer(GL_COPY_READ_BUFFER, m_boneVBO);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, m_boneBytes, &m_evictedBones[0]);
+        glBufferData(GL_COPY_READ_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+    }
+
+    LOG_DEBUG(ASSET, "Mesh::evict() VAO={}", m_VAO);
+    return 0;
+}
+
+// upload the copies made by evict() again; the VAO still refers to the same buffer names
+// return: bytes on the GPU
+size_t Mesh::restore()
+{
+    GLState::instance().bindBuffer(GL_COPY_READ_BUFFER, m_VBO);
+    glBufferData(GL_COPY_READ_BUFFER, m_vertexBytes, &m_evictedVertices[0], GL_STATIC_DRAW);
+    GLState::instance().bindBuffer(GL_COPY_READ_BUFFER, m_EBO);
+    glBufferData(GL_COPY_READ_BUFFER, m_indexBytes, &m_evictedIndices[0], GL_STATIC_DRAW);
+    if(m_boneVBO)
+    {
+        GLState::instance().bindBuffer(GL_COPY_READ_BUFFER, m_boneVBO);
+        glBufferData(GL_COPY_READ_BUFFER, m_boneBytes, &m_evictedBones[0], GL_STATIC_DRAW);
+    }
+
+    std::vector<unsigned char>().swap(m_evictedVertices);
+    std::vector<unsigned char>().swap(m_evictedIndices);
+    std::vector<unsigned char>().swap(m_evictedBones);
+    LOG_DEBUG(ASSET, "Mesh::restore() VAO={}", m_VAO);
+    return m_vertexBytes + m_indexBytes + m_boneBytes;
+}
+
+// keep positions and indices on the CPU so the mesh can be rasterized by OcclusionCuller
+void Mesh::setOccluderGeometry(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    m_occluderPositions.resize(vertices.size());
+    for(size_t i = 0; i < vertices.size(); i++) { m_occluderPositions[i] = vertices[i].position; }
+    m_occluderIndices = indices;
+}
+
+// call this method after calling shaderProgram.use()
+//
+// uniform sampler2D in shaderProgram:
+// diffuseMap<n>, specularMap<n>, normalMap<n>, heightMap<n> (n = 0, 1, 2, ...)
+//
+// TODO: better solution?
+// uniform sampler2D diffuseMap[MAX_SIZE];
+// uniform numDiffuse;
+void Mesh::draw(ShaderProgram& shaderProgram)
+{
+    // local vars
+    int numDiffuse, numSpecular, numNormal, numHeight;
+    numDiffuse = numSpecular = numNormal = numHeight = 0;
+    ResidencyManager& residency = ResidencyManager::instance();
+    GLState& gl = GLState::instance();
+
+    // reload evicted buffers now (reload stall)
+    residency.makeResident(m_residency);
+
+    // bind textures
+    for(size_t i = 0; i < m_textures.size(); i++)
+    {
+        std::string uniformName;
+        switch (m_textures[i].type)
+        {
+        case Texture::TYPE::DIFFUSE:
+            uniformName = "diffuseMap";
+            uniformName += std::to_string(numDiffuse++);
+            break;
+        case Texture::TYPE::SPECULAR:
+            uniformName = "specularMap";
+            uniformName += std::to_string(numSpecular++);
+            break;
+        case Texture::TYPE::NORMAL:
+            uniformName = "normalMap";
+            uniformName += std::to_string(numNormal++);
+            break;
+        case Texture::TYPE::HEIGHT:
+            uniformName = "heightMap";
+            uniformName += std::to_string(numHeight++);
+            break;
+        default:
+            LOG_WARN(ASSET, "wrong or unimplemented texture type");
+            continue;
+        }
+        
+        // select texture unit and bind texture
+        residency.makeResident(m_textures[i].residency);
+        gl.bindTexture(static_cast<GLuint>(i), GL_TEXTURE_2D, m_textures[i].textureID);
+
+        // assign the number of texture unit to uniform
+        shaderProgram.setSampler(uniformName.c_str(), i);
+    }
+
+    // draw mesh
+    // the VAO and textures stay bound: the next mesh only rebinds what differs
+    gl.bindVertexArray(m_VAO);
+    gl.traceDraw(GL_TRIANGLES, m_numIndices);
+    glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, 0);
+}
+
+// same as draw(), but recorded into a command buffer instead of calling GL
+// no GL call: safe to call from worker threads
+// the program is expected to be bound by an earlier command
+void Mesh::record(CommandBuffer& commandBuffer, const ShaderProgram& shaderProgram) const
+{
+    // local vars
+    int numDiffuse, numSpecular, numNormal, numHeight;
+    numDiffuse = numSpecular = numNormal = numHeight = 0;
+    ResidencyManager& residency = ResidencyManager::instance();
+
+    // evicted buffers are requested for the next frame and skipped for this one
+    // (evicted textures are still drawable: they sample a 1x1 placeholder meanwhile)
+    residency.touch(m_residency);
+    if(m_residency && m_residency->state.load(std::memory_order_acquire) == ResidencyEntry::EVICTED) { return; }
+
+    // bind textures
+    for(size_t i = 0; i < m_textures.size(); i++)
+    {
+        char uniformName[32];
+        switch (m_textures[i].type)
+        {
+        case Texture::TYPE::DIFFUSE:
+            snprintf(uniformName, sizeof(uniformName), "diffuseMap%d", numDiffuse++);
+            break;
+        case Texture::TYPE::SPECULAR:
+            snprintf(uniformName, sizeof(uniformName), "specularMap%d", numSpecular++);
+            break;
+        case Texture::TYPE::NORMAL:
+            snprintf(uniformName, sizeof(uniformName), "normalMap%d", numNormal++);
+            break;
+        case Texture::TYPE::HEIGHT:
+            snprintf(uniformName, sizeof(uniformName), "heightMap%d", numHeight++);
+            break;
+        default:
+            continue;
+        }
+
+        residency.touch(m_textures[i].residency);
+        commandBuffer.bindTexture(static_cast<uint16_t>(i), m_textures[i].textureID);
+        commandBuffer.setInt(shaderProgram.getUniformLocation(uniformName), static_cast<int>(i));
+    }
+
+    // draw mesh (textures stay bound: the next mesh rebinds the units it uses)
+    commandBuffer.bindVertexArray(m_VAO);
+    commandBuffer.drawIndexed(static_cast<uint32_t>(m_numIndices));
+}
@@ -0,0 +1,789 @@
+// include
+#include <Model.hpp>
+
+bool Model::s_weldVertices = true;
+float Model::s_weldEpsilon = 0.0f;
+bool Model::s_useObjLoader = true;
+float Model::s_creaseAngle = 175.0f;
+bool Model::s_validateTangentSpace = false;
+float Model::s_animationSampleRate = 30.0f;
+
+void Model::nullify()
+{
+    for(size_t i = 0; i < m_meshes.size(); i++) { delete m_meshes[i]; }
+    for(size_t i = 0; i < m_images.size(); i++) { delete m_images[i]; }
+    std::vector<Mesh*>().swap(m_meshes);
+    std::vector<Image*>().swap(m_images);
+    std::vector<Node>().swap(m_nodes);
+    m_skeleton.clear();
+    std::vector<AnimationClip>().swap(m_clips);
+}
+
+Model::Model()
+{
+    nullify();
+    m_isOccluder = false;
+}
+
+Model::Model(const char* modelPath)
+{
+    nullify();
+    m_isOccluder = false;
+    loadFromFile(modelPath);
+}
+
+// e.g.) Model walls("walls.obj", true); // keep CPU geometry for OcclusionCuller
+Model::Model(const char* modelPath, bool isOccluder)
+{
+    nullify();
+    m_isOccluder = isOccluder;
+    loadFromFile(modelPath);
+}
+
+Model::~Model() { nullify(); }
+
+// weld duplicated vertices of every mesh loaded afterwards (default: true)
+void Model::setWeldVertices(bool flag) { s_weldVertices = flag; }
+
+// 0.0f (default): weld bitwise-identical vertices only
+// > 0.0f: weld vertices whose attributes fall into the same grid cell of size epsilon
+void Model::setWeldEpsilon(float epsilon) { s_weldEpsilon = epsilon; }
+
+// load *.obj files with ObjLoader instead of assimp (default: true)
+void Model::setUseObjLoader(bool flag) { s_useObjLoader = flag; }
+
+// meshes without normals (and OBJ corners without vn): generated normals are not smoothed across edges sharper than this
+// (degrees, default: 175 as in assimp)
+void Model::setCreaseAngle(float degrees) { s_creaseAngle = degrees; }
+
+// import non-OBJ models a second time with aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace and log
+// how far the generated normals and tangents are from assimp's and how long each import took (default: false)
+// assimp smooths tangents within 45 degrees and weights them differently: a few degrees of mean difference are expected
+void Model::setValidateTangentSpace(bool flag) { s_validateTangentSpace = flag; }
+
+// keyframes of animations loaded afterwards are resampled at this rate (default: 30 frames per second)
+void Model::setAnimationSampleRate(float framesPerSecond) { s_animationSampleRate = framesPerSecond; }
+
+// load an OBJ file numRuns times with assimp and with ObjLoader (everything Model does: import, normals, tangents,
+// welding, GPU upload and textures) and log the mean time of each against OBJ_TARGET_SPEEDUP
+// e.g.) Model::benchmarkObj("../../resource/model/model.obj", 10);
+// return: true if ObjLoader is at least OBJ_TARGET_SPEEDUP times faster
+bool Model::benchmarkObj(const char* objPath, int numRuns)
+{
+    // local vars
+    bool useObjLoader = s_useObjLoader;
+    double ms[2] = { 0.0, 0.0 }; // assimp, ObjLoader
+    double speedup;
+
+    if(!objPath || !isObjFile(objPath) || numRuns <= 0) { LOG_ERROR(ASSET, "Model::benchmarkObj(): not an OBJ file"); return false; }
+
+    for(int run = 0; run < numRuns; run++)
+    {
+        for(int loader = 0; loader < 2; loader++)
+        {
+            s_useObjLoader = loader == 1;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            Model model(objPath);
+            ms[loader] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+    s_useObjLoader = useObjLoader;
+
+    speedup = ms[1] > 0.0 ? ms[0] / ms[1] : 0.0;
+    if(speedup >= OBJ_TARGET_SPEEDUP)
+    {
+        LOG_INFO(ASSET, "OBJ benchmark \"{}\": assimp {:.3f} ms, ObjLoader {:.3f} ms, {:.1f}x faster (pass, target {:.0f}x), mean of {} loads",
+            objPath, ms[0] / numRuns, ms[1] / numRuns, speedup, OBJ_TARGET_SPEEDUP, numRuns);
+        return true;
+    }
+    LOG_WARN(ASSET, "OBJ benchmark \"{}\": assimp {:.3f} ms, ObjLoader {:.3f} ms, {:.1f}x faster (FAIL, target {:.0f}x), mean of {} loads",
+        objPath, ms[0] / numRuns, ms[1] / numRuns, speedup, OBJ_TARGET_SPEEDUP, numRuns);
+    return false;
+}
+
+// occluder models keep a CPU copy of their positions and indices (see addOccluders())
+// takes effect on the next loadFromFile()
+void Model::setOccluder(bool flag) { m_isOccluder = flag; }
+
+void Model::loadFromFile(const char* modelPath)
+{
+    // local vars
+    const aiScene* scene;
+    std::string modelDir;
+    unsigned int numMeshes;
+    VertexWelder welder(s_weldEpsilon);
+    VertexWelder::Stats weldTotal;
+    TangentSpace tangentSpace(s_creaseAngle);
+    TangentSpace::Stats tangentTotal;
+    TangentSpaceError error;
+    size_t numNormalMeshes = 0, numTangentMeshes = 0, numVertices = 0, numTriangles = 0;
+
+    // check filepath
+    if(!modelPath) { LOG_ERROR(ASSET, "Image::loadFromFile(nullptr): null filepath"); return; }
+    LOG_INFO(ASSET, "Model::loadFromFile(\"{}\")", modelPath);
+    
+    // delete existing model
+    if(m_meshes.size() || m_images.size())
+    {
+        LOG_WARN(ASSET, "delete existing Model");
+        nullify();
+    }
+
+    // get model directory
+    modelDir = modelPath;
+	modelDir = modelDir.substr(0, modelDir.find_last_of("/\\")) + '/'; // find both '/' and '\'
+    LOG_DEBUG(ASSET, "modelDir = \"{}\"", modelDir);
+
+    // Wavefront OBJ: bypass assimp
+    if(s_useObjLoader && isObjFile(modelPath))
+    {
+        loadFromObj(modelPath, modelDir);
+        return;
+    }
+
+    // open model file
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Assimp::Importer importer;
+    importer.SetIOHandler(new PackIOSystem()); // asset pack or loose files, deleted by the importer
+    // normals and tangents are generated by TangentSpace below (in parallel, tangents only where a material needs them)
+    scene = importer.ReadFile(modelPath,
+        aiProcess_Triangulate |
+        aiProcess_FlipUVs);
+	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	{
+        LOG_ERROR(ASSET, "assimp error:\n{}", importer.GetErrorString());
+		return;
+	}
+    double importMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO(ASSET, "assimp import took {:.3f} ms", importMs);
+
+    // reference: assimp's own normals and tangents (same vertex order)
+    Assimp::Importer referenceImporter;
+    const aiScene* reference = nullptr;
+    double referenceMs = 0.0;
+    if(s_validateTangentSpace)
+    {
+        std::chrono::steady_clock::time_point referenceStart = std::chrono::steady_clock::now();
+        referenceImporter.SetIOHandler(new PackIOSystem());
+        referenceImporter.SetPropertyFloat(AI_CONFIG_PP_GSN_MAX_SMOOTHING_ANGLE, s_creaseAngle);
+        reference = referenceImporter.ReadFile(modelPath, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace);
+        referenceMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - referenceStart).count();
+        if(reference && reference->mNumMeshes != scene->mNumMeshes) { reference = nullptr; }
+        memset(&error, 0, sizeof(TangentSpaceError)); // nullify
+    }
+
+    numMeshes = scene->mNumMeshes;
+    LOG_INFO(ASSET, "found {} meshes belonging to \"{}\"", numMeshes, modelPath);
+
+    // node hierarchy, needed by bones and animations
+    bool hasBones = false;
+    for(unsigned int i = 0; i < numMeshes; i++) { hasBones = hasBones || scene->mMeshes[i]->HasBones(); }
+    if(hasBones || scene->HasAnimations())
+    {
+        loadSkeleton(scene->mRootNode, -1);
+        m_skeleton.setGlobalInverse(glm::inverse(toMat4(scene->mRootNode->mTransformation)));
+        LOG_INFO(ASSET, "skeleton: {} nodes", m_skeleton.getNumNodes());
+    }
+
+    memset(&weldTotal, 0, sizeof(VertexWelder::Stats)); // nullify
+    memset(&tangentTotal, 0, sizeof(TangentSpace::Stats)); // nullify
+	for (unsigned int i = 0; i < numMeshes; i++)
+	{
+        LOG_DEBUG(ASSET, "{}-th mesh", i);
+
+		aiMesh* mesh = scene->mMeshes[i];
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<Texture> textures;
+        std::vector<VertexBoneData> boneData;
+
+        // load vertices, indices, textures, and bone weights
+        loadVertices(mesh, vertices);
+        loadIndices(mesh, indices);
+        loadTextures(mesh, textures, scene->mMaterials, modelDir);
+        loadBones(mesh, boneData);
+
+        // normals if the file has none; tangents only for normal and height maps (the only readers of aTangent/aBitangent)
+        bool generateNormals = !mesh->HasNormals();
+        bool generateTangents = !mesh->HasTangentsAndBitangents() && mesh->mTextureCoords[0] && TangentSpace::needsTangents(textures);
+        if(generateNormals)
+        {
+            TangentSpace::Stats stats = tangentSpace.generateNormals(vertices, indices);
+            tangentTotal.normalSeconds += stats.normalSeconds;
+            numNormalMeshes++;
+        }
+        if(generateTangents)
+        {
+            std::vector<unsigned int> sources; // split vertices carry the bone weights of their original
+            TangentSpace::Stats stats = tangentSpace.generateTangents(vertices, indices, &sources);
+            for(size_t s = 0; s < sources.size() && boneData.size(); s++)
+            {
+                VertexBoneData bones = boneData[sources[s]];
+                boneData.push_back(bones);
+            }
+            tangentTotal.numTriangles += stats.numTriangles;
+            tangentTotal.numSplitVertices += stats.numSplitVertices;
+            tangentTotal.tangentSeconds += stats.tangentSeconds;
+            numTangentMeshes++;
+        }
+        if(reference) { compareTangentSpace(reference->mMeshes[i], vertices, generateNormals, generateTangents, error); }
+
+        // weld duplicated vertices (assimp is not asked for aiProcess_JoinIdenticalVertices)
+        // skinned meshes are not welded: VertexWelder does not carry bone data along
+        if(s_weldVertices && boneData.empty())
+        {
+            VertexWelder::Stats stats = welder.weld(vertices, indices);
+            weldTotal.numVerticesIn += stats.numVerticesIn;
+            weldTotal.numVerticesOut += stats.numVerticesOut;
+            weldTotal.seconds += stats.seconds;
+        }
+
+        numVertices += vertices.size();
+        numTriangles += indices.size() / 3;
+        m_meshes.push_back(new Mesh(vertices, indices, textures));
+        if(boneData.size()) { m_meshes.back()->setBoneData(boneData); }
+        if(m_isOccluder) { m_meshes.back()->setOccluderGeometry(vertices, indices); }
+	}
+
+    loadNodes(scene->mRootNode, -1);
+    loadAnimations(scene);
+
+    if(s_weldVertices && weldTotal.numVerticesIn)
+    {
+        LOG_INFO(ASSET, "welded {} -> {} vertices ({:.1f}%) in {:.3f} ms ({:.2f} Mvertices/s)",
+            weldTotal.numVerticesIn, weldTotal.numVerticesOut,
+            100.0 * weldTotal.numVerticesOut / weldTotal.numVerticesIn,
+            weldTotal.seconds * 1000.0,
+            weldTotal.seconds > 0.0 ? weldTotal.numVerticesIn / weldTotal.seconds / 1e6 : 0.0);
+    }
+    if(numNormalMeshes || numTangentMeshes)
+    {
+        LOG_INFO(ASSET, "tangent space: normals for {} meshes in {:.3f} ms, tangents for {} of {} meshes in {:.3f} ms ({:.2f} Mtriangles/s, {} split vertices)",
+            numNormalMeshes, tangentTotal.normalSeconds * 1000.0, numTangentMeshes, numMeshes, tangentTotal.tangentSeconds * 1000.0,
+            tangentTotal.tangentSeconds > 0.0 ? tangentTotal.numTriangles / tangentTotal.tangentSeconds / 1e6 : 0.0, tangentTotal.numSplitVertices);
+    }
+    if(reference)
+    {
+        LOG_INFO(ASSET, "tangent space vs assimp: normals {:.3f} deg mean, {:.2f} deg max ({} vertices); tangents {:.3f} deg mean, {:.2f} deg max ({} vertices), {} handedness flips",
+            error.numNormals ? error.normalSum / error.numNormals : 0.0, error.normalMax, error.numNormals,
+            error.numTangents ? error.tangentSum / error.numTangents : 0.0, error.tangentMax, error.numTangents, error.numFlipped);
+        LOG_INFO(ASSET, "tangent space vs assimp: {:.3f} ms import + {:.3f} ms generation, assimp {:.3f} ms import with aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace",
+            importMs, (tangentTotal.normalSeconds + tangentTotal.tangentSeconds) * 1000.0, referenceMs);
+    }
+
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() - referenceMs;
+    LOG_INFO(ASSET, "loaded {} vertices, {} triangles in {:.3f} ms ({:.2f} Mtriangles/s)",
+        numVertices, numTriangles, totalMs, totalMs > 0.0 ? numTriangles / totalMs / 1e3 : 0.0);
+}
+
+void Model::draw(ShaderProgram& ShaderProgram)
+{
+    size_t numMeshes;
+    
+    numMeshes = m_meshes.size();
+    for(size_t i = 0; i < numMeshes; i++) { m_meshes[i]->draw(ShaderProgram); }
+}
+
+// draw only the meshes whose bounding box passes culler.isVisible()
+// model: model matrix of this Model (the culler holds view * projection)
+void Model::draw(ShaderProgram& shaderProgram, const OcclusionCuller& culler, const glm::mat4& model)
+{
+    for(size_t i = 0; i < m_meshes.size(); i++)
+    {
+        if(culler.isVisible(m_meshes[i]->getBoundsMin(), m_meshes[i]->getBoundsMax(), model)) { m_meshes[i]->draw(shaderProgram); }
+    }
+}
+
+// no GL call: safe to call from worker threads (see Mesh::record())
+void Model::record(CommandBuffer& commandBuffer, const ShaderProgram& shaderProgram) const
+{
+    for(size_t i = 0; i < m_meshes.size(); i++) { m_meshes[i]->record(commandBuffer, shaderProgram); }
+}
+
+void Model::record(CommandBuffer& commandBuffer, const ShaderProgram& shaderProgram, const OcclusionCuller& culler, const glm::mat4& model) const
+{
+    for(size_t i = 0; i < m_meshes.size(); i++)
+    {
+        if(culler.isVisible(m_meshes[i]->getBoundsMin(), m_meshes[i]->getBoundsMax(), model)) { m_meshes[i]->record(commandBuffer, shaderProgram); }
+    }
+}
+
+// every mesh with the minimal variant of shaderVariants it needs
+void Model::draw(ShaderVariants& shaderVariants)
+{
+    for(size_t i = 0; i < m_meshes.size(); i++)
+    {
+        ShaderProgram& shaderProgram = shaderVariants.get(m_meshes[i]->getFeatures());
+        shaderProgram.use();
+        m_meshes[i]->draw(shaderProgram);
+    }
+}
+
+// the variants must be compiled beforehand (see getFeatureMasks()): meshes without one are skipped
+// the program is rebound only when the variant changes
+void Model::record(CommandBuffer& commandBuffer, const ShaderVariants& shaderVariants, const OcclusionCuller& culler, const glm::mat4& model) const
+{
+    const ShaderProgram* bound = nullptr;
+
+    for(size_t i = 0; i < m_meshes.size(); i++)
+    {
+        if(!culler.isVisible(m_meshes[i]->getBoundsMin(), m_meshes[i]->getBoundsMax(), model)) { continue; }
+
+        const ShaderProgram* shaderProgram = shaderVariants.find(m_meshes[i]->getFeatures());
+        if(!shaderProgram) { continue; }
+        if(shaderProgram != bound)
+        {
+            commandBuffer.bindProgram(shaderProgram->getShaderProgramID());
+            bound = shaderProgram;
+        }
+        m_meshes[i]->record(commandBuffer, *shaderProgram);
+    }
+}
+
+// feature masks of all meshes (duplicates removed), e.g. for ShaderVariants::precompile()
+std::vector<uint32_t> Model::getFeatureMasks() const
+{
+    std::vector<uint32_t> masks;
+    for(size_t i = 0; i < m_meshes.size(); i++)
+    {
+        if(std::find(masks.begin(), masks.end(), m_meshes[i]->getFeatures()) == masks.end()) { masks.push_back(m_meshes[i]->getFeatures()); }
+    }
+    return masks;
+}
+
+// call between culler.beginFrame() and culler.rasterize()
+void Model::addOccluders(OcclusionCuller& culler, const glm::mat4& model) const
+{
+    for(size_t i = 0; i < m_meshes.size(); i++)
+    {
+        if(!m_meshes[i]->isOccluder()) { continue; }
+
+        const std::vector<glm::vec3>& positions = m_meshes[i]->getOccluderPositions();
+        const std::vector<unsigned int>& indices = m_meshes[i]->getOccluderIndices();
+        culler.addOccluder(&positions[0], positions.size(), &indices[0], indices.size(), model);
+    }
+}
+
+void Model::loadVertices(aiMesh* mesh, std::vector<Vertex>& vertices)
+{
+    if(!mesh) { return; }
+
+    unsigned int numVertices = mesh->mNumVertices;
+    for (unsigned int i = 0; i < numVertices; i++)
+    {
+        Vertex vert{}; // nullify
+        glm::vec3 v3;
+
+        // aPos
+        v3.x = mesh->mVertices[i].x;
+        v3.y = mesh->mVertices[i].y;
+        v3.z = mesh->mVertices[i].z;
+        vert.position = v3;
+
+        // aNormal
+        if(mesh->HasNormals())
+        {
+            v3.x = mesh->mNormals[i].x;
+            v3.y = mesh->mNormals[i].y;
+            v3.z = mesh->mNormals[i].z;
+            vert.normal = v3;
+        }
+        // aTexCoord
+        if(mesh->mTextureCoords[0])
+        {
+            glm::vec2 v2;
+            v2.x = mesh->mTextureCoords[0][i].x;
+            v2.y = mesh->mTextureCoords[0][i].y;
+            vert.texCoord = v2;
+        }
+        
+        // aTangent and aBitangent
+        if(mesh->HasTangentsAndBitangents())
+        {
+            v3.x = mesh->mTangents[i].x;
+            v3.y = mesh->mTangents[i].y;
+            v3.z = mesh->mTangents[i].z;
+            vert.tangent = v3;
+
+            v3.x = mesh->mBitangents[i].x;
+            v3.y = mesh->mBitangents[i].y;
+            v3.z = mesh->mBitangents[i].z;
+            vert.bitangent = v3;
+        }
+        
+        vertices.push_back(vert);
+    }
+}
+
+void Model::loadIndices(aiMesh* mesh, std::vector<unsigned int>& indices)
+{
+    if(!mesh) { return; }
+
+    for(unsigned int i = 0; i < mesh->mNumFaces; i++)
+        {
+            aiFace face = mesh->mFaces[i];
+            for(unsigned int j = 0; j < face.mNumIndices; j++)
+            {
+                indices.push_back(face.mIndices[j]);
+            }
+        }
+}
+
+void Model::loadTextures(aiMesh* mesh, std::vector<Texture>& textures, aiMaterial** materials, std::string& modelDir)
+{
+    if(!mesh) { return; }
+
+    unsigned int materialIndex = mesh->mMaterialIndex;
+
+    loadTextureByType(textures, materials, materialIndex, aiTextureType_DIFFUSE, modelDir);
+    loadTextureByType(textures, materials, materialIndex, aiTextureType_SPECULAR, modelDir);
+    loadTextureByType(textures, materials, materialIndex, aiTextureType_NORMALS, modelDir);
+    loadTextureByType(textures, materials, materialIndex, aiTextureType_HEIGHT, modelDir);
+}
+
+void Model::loadTextureByType(std::vector<Texture>& textures, aiMaterial** materials, unsigned int materialIndex, aiTextureType type, std::string& modelDir)
+{
+    Texture tex;
+    unsigned int textureCount;
+
+    memset(&tex, 0, sizeof(Texture)); // nullify
+    switch(type)
+    {
+    case aiTextureType_DIFFUSE:
+        tex.type = Texture::TYPE::DIFFUSE;
+        break;
+    case aiTextureType_SPECULAR:
+        tex.type = Texture::TYPE::SPECULAR;
+        break;
+    case aiTextureType_NORMALS:
+        tex.type = Texture::TYPE::NORMAL;
+        break;
+    case aiTextureType_HEIGHT:
+        tex.type = Texture::TYPE::HEIGHT;
+        break;
+    default:
+        LOG_ERROR(ASSET, "wrong or unimplemented texture type");
+        return;
+    }
+
+    textureCount = materials[materialIndex]->GetTextureCount(type);
+	for(unsigned int i = 0; i < textureCount; i++)
+	{
+        aiString path;
+		materials[materialIndex]->GetTexture(type, i, &path);
+
+        Image* image = loadImage(modelDir + path.C_Str());
+        tex.textureID = image->getImageID();
+        tex.residency = image->getResidency();
+        textures.push_back(tex);
+	}
+}
+
+// add node and its descendants to m_nodes in depth-first preorder
+void Model::loadNodes(aiNode* node, int parent)
+{
+    Node modelNode;
+
+    modelNode.name = node->mName.C_Str();
+    modelNode.parent = parent;
+    modelNode.transformation = toMat4(node->mTransformation);
+    modelNode.meshes.assign(node->mMeshes, node->mMeshes + node->mNumMeshes);
+    m_nodes.push_back(modelNode);
+
+    int index = static_cast<int>(m_nodes.size() - 1);
+    for(unsigned int i = 0; i < node->mNumChildren; i++) { loadNodes(node->mChildren[i], index); }
+}
+
+// add node and its descendants to m_skeleton in depth-first preorder
+void Model::loadSkeleton(aiNode* node, int parent)
+{
+    aiVector3D scaling, position;
+    aiQuaternion rotation;
+
+    node->mTransformation.Decompose(scaling, rotation, position);
+    int index = m_skeleton.addNode(node->mName.C_Str(), parent,
+        glm::vec3(position.x, position.y, position.z),
+        glm::quat(rotation.w, rotation.x, rotation.y, rotation.z),
+        glm::vec3(scaling.x, scaling.y, scaling.z));
+
+    for(unsigned int i = 0; i < node->mNumChildren; i++) { loadSkeleton(node->mChildren[i], index); }
+}
+
+// keep the 4 largest influences of every vertex and renormalize them
+// influences of bones past SkinningBuffer::MAX_BONES (or without a node) are dropped; a vertex left without any
+// (or never weighted) is bound rigidly to the mesh's bone nearest the root, and without such a bone the mesh is not skinned
+// boneData stays empty for meshes without bones
+void Model::loadBones(aiMesh* mesh, std::vector<VertexBoneData>& boneData)
+{
+    // local vars
+    int rootBone = -1, rootNode = -1;
+    size_t numRigid = 0;
+
+    if(!mesh || !mesh->HasBones()) { return; }
+
+    boneData.resize(mesh->mNumVertices);
+    memset(&boneData[0], 0, boneData.size() * sizeof(VertexBoneData)); // nullify
+
+    for(unsigned int i = 0; i < mesh->mNumBones; i++)
+    {
+        aiBone* bone = mesh->mBones[i];
+        int boneIndex = m_skeleton.addBone(bone->mName.C_Str(), toMat4(bone->mOffsetMatrix));
+        if(boneIndex < 0) { continue; }
+        if(boneIndex >= SkinningBuffer::MAX_BONES) { LOG_WARN(ASSET, "bone \"{}\" exceeds MAX_BONES", bone->mName.C_Str()); continue; }
+
+        // nodes are in depth-first preorder: the smallest node index is the nearest to the root
+        int node = m_skeleton.findNode(bone->mName.C_Str());
+        if(rootBone < 0 || node < rootNode) { rootBone = boneIndex; rootNode = node; }
+
+        for(unsigned int j = 0; j < bone->mNumWeights; j++)
+        {
+            VertexBoneData& data = boneData[bone->mWeights[j].mVertexId];
+            float weight = bone->mWeights[j].mWeight;
+
+            // replace the smallest slot if this influence is larger
+            int smallest = 0;
+            for(int k = 1; k < 4; k++) { if(data.weights[k] < data.weights[smallest]) { smallest = k; } }
+            if(weight > data.weights[smallest])
+            {
+                data.boneIDs[smallest] = boneIndex;
+                data.weights[smallest] = weight;
+            }
+        }
+    }
+
+    if(rootBone < 0)
+    {
+        LOG_ERROR(ASSET, "mesh \"{}\": none of its {} bones fits in MAX_BONES ({}), drawn unskinned", mesh->mName.C_Str(), mesh->mNumBones, SkinningBuffer::MAX_BONES);
+        boneData.clear();
+        return;
+    }
+
+    for(size_t i = 0; i < boneData.size(); i++)
+    {
+        float sum = boneData[i].weights[0] + boneData[i].weights[1] + boneData[i].weights[2] + boneData[i].weights[3];
+        if(sum > 0.0f) { for(int k = 0; k < 4; k++) { boneData[i].weights[k] /= sum; } }
+        else
+        {
+            // a zero weight sum would collapse the vertex to the origin in mesh.vs
+            boneData[i].boneIDs[0] = rootBone;
+            boneData[i].weights[0] = 1.0f;
+            numRigid++;
+        }
+    }
+    if(numRigid) { LOG_WARN(ASSET, "mesh \"{}\": {} vertices without a bone, bound to bone {}", mesh->mName.C_Str(), numRigid, rootBone); }
+}
+
+// resample every channel at s_animationSampleRate into an AnimationClip
+void Model::loadAnimations(const aiScene* scene)
+{
+    m_clips.resize(scene->mNumAnimations);
+    for(unsigned int i = 0; i < scene->mNumAnimations; i++)
+    {
+        aiAnimation* animation = scene->mAnimations[i];
+        double ticksPerSecond = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : 25.0;
+        AnimationClip& clip = m_clips[i];
+
+        clip.init(animation->mName.C_Str(), static_cast<float>(animation->mDuration / ticksPerSecond), s_animationSampleRate, m_skeleton);
+        for(unsigned int c = 0; c < animation->mNumChannels; c++)
+        {
+            aiNodeAnim* channel = animation->mChannels[c];
+            int node = m_skeleton.findNode(channel->mNodeName.C_Str());
+            if(node < 0) { continue; }
+
+            unsigned int p = 0, r = 0, s = 0; // current key of each track (frames only move forward)
+            for(size_t f = 0; f < clip.getNumFrames(); f++)
+            {
+                double tick = std::min(f / s_animationSampleRate * ticksPerSecond, animation->mDuration);
+
+                while(p + 1 < channel->mNumPositionKeys && channel->mPositionKeys[p + 1].mTime <= tick) { p++; }
+                while(r + 1 < channel->mNumRotationKeys && channel->mRotationKeys[r + 1].mTime <= tick) { r++; }
+                while(s + 1 < channel->mNumScalingKeys && channel->mScalingKeys[s + 1].mTime <= tick) { s++; }
+
+                glm::vec3 translation(0.0f), scale(1.0f);
+                glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+                if(channel->mNumPositionKeys)
+                {
+                    const aiVectorKey& k0 = channel->mPositionKeys[p];
+                    const aiVectorKey& k1 = channel->mPositionKeys[std::min(p + 1, channel->mNumPositionKeys - 1)];
+                    float t = k1.mTime > k0.mTime ? static_cast<float>((tick - k0.mTime) / (k1.mTime - k0.mTime)) : 0.0f;
+                    translation = glm::mix(glm::vec3(k0.mValue.x, k0.mValue.y, k0.mValue.z), glm::vec3(k1.mValue.x, k1.mValue.y, k1.mValue.z), std::max(t, 0.0f));
+                }
+                if(channel->mNumRotationKeys)
+                {
+                    const aiQuatKey& k0 = channel->mRotationKeys[r];
+                    const aiQuatKey& k1 = channel->mRotationKeys[std::min(r + 1, channel->mNumRotationKeys - 1)];
+                    float t = k1.mTime > k0.mTime ? static_cast<float>((tick - k0.mTime) / (k1.mTime - k0.mTime)) : 0.0f;
+                    rotation = glm::slerp(glm::quat(k0.mValue.w, k0.mValue.x, k0.mValue.y, k0.mValue.z),
+                        glm::quat(k1.mValue.w, k1.mValue.x, k1.mValue.y, k1.mValue.z), std::max(t, 0.0f));
+                }
+                if(channel->mNumScalingKeys)
+                {
+                    const aiVectorKey& k0 = channel->mScalingKeys[s];
+                    const aiVectorKey& k1 = channel->mScalingKeys[std::min(s + 1, channel->mNumScalingKeys - 1)];
+                    float t = k1.mTime > k0.mTime ? static_cast<float>((tick - k0.mTime) / (k1.mTime - k0.mTime)) : 0.0f;
+                    scale = glm::mix(glm::vec3(k0.mValue.x, k0.mValue.y, k0.mValue.z), glm::vec3(k1.mValue.x, k1.mValue.y, k1.mValue.z), std::max(t, 0.0f));
+                }
+                clip.setKey(f, node, translation, rotation, scale);
+            }
+        }
+        clip.finalize();
+        LOG_INFO(ASSET, "animation \"{}\": {:.2f} s, {} channels, {} frames", clip.getName(), clip.getDuration(), animation->mNumChannels, clip.getNumFrames());
+    }
+}
+
+// mesh: the same mesh imported with aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace
+// only the vertices generated by TangentSpace are compared (split vertices, appended at the end, are not)
+void Model::compareTangentSpace(const aiMesh* mesh, const std::vector<Vertex>& vertices, bool normals, bool tangents, TangentSpaceError& error)
+{
+    size_t numVertices = std::min(static_cast<size_t>(mesh->mNumVertices), vertices.size());
+
+    // e.g. point and line meshes: nothing to compare, and mNormals is null
+    if(!mesh->HasNormals()) { return; }
+    tangents = tangents && mesh->HasTangentsAndBitangents();
+    for(size_t i = 0; i < numVertices; i++)
+    {
+        const Vertex& vert = vertices[i];
+        glm::vec3 n(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+
+        // assimp marks the vectors it could not compute with NaN
+        if(normals && glm::length(n) > 0.0f && glm::length(vert.normal) > 0.0f)
+        {
+            double angle = glm::degrees(std::acos(std::min(std::max(glm::dot(glm::normalize(n), glm::normalize(vert.normal)), -1.0f), 1.0f)));
+            error.normalSum += angle;
+            error.normalMax = std::max(error.normalMax, angle);
+            error.numNormals++;
+        }
+        if(tangents)
+        {
+            glm::vec3 t(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+            glm::vec3 b(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
+            if(!(glm::length(t) > 0.0f) || !(glm::length(b) > 0.0f) || !(glm::length(vert.tangent) > 0.0f)) { continue; }
+
+            double angle = glm::degrees(std::acos(std::min(std::max(glm::dot(glm::normalize(t), vert.tangent), -1.0f), 1.0f)));
+            error.tangentSum += angle;
+            error.tangentMax = std::max(error.tangentMax, angle);
+            error.numTangents++;
+            if((glm::dot(glm::cross(n, t), b) >= 0.0f) != (glm::dot(glm::cross(vert.normal, vert.tangent), vert.bitangent) >= 0.0f)) { error.numFlipped++; }
+        }
+    }
+}
+
+// assimp matrices are row-major, glm matrices are column-major
+glm::mat4 Model::toMat4(const aiMatrix4x4& m)
+{
+    return glm::mat4(
+        m.a1, m.b1, m.c1, m.d1,
+        m.a2, m.b2, m.c2, m.d2,
+        m.a3, m.b3, m.c3, m.d3,
+        m.a4, m.b4, m.c4, m.d4);
+}
+
+// load meshes and material textures with ObjLoader
+void Model::loadFromObj(const char* modelPath, std::string& modelDir)
+{
+    // local vars
+    ObjLoader loader;
+    VertexWelder welder(s_weldEpsilon);
+    size_t numVerticesIn = 0, numVerticesOut = 0;
+    TangentSpace tangentSpace(s_creaseAngle);
+    TangentSpace::Stats tangentTotal;
+    size_t numNormalMeshes = 0, numTangentMeshes = 0;
+
+    if(!loader.loadFromFile(modelPath)) { return; }
+
+    std::vector<ObjLoader::MeshData>& meshes = loader.getMeshes();
+    std::vector<ObjLoader::Material>& materials = loader.getMaterials();
+    LOG_INFO(ASSET, "found {} meshes belonging to \"{}\"", meshes.size(), modelPath);
+    memset(&tangentTotal, 0, sizeof(TangentSpace::Stats)); // nullify
+    for(size_t i = 0; i < meshes.size(); i++)
+    {
+        std::vector<Texture> textures;
+
+        // same order as loadTextures(): diffuse, specular, normal, height
+        if(meshes[i].materialIndex >= 0)
+        {
+            ObjLoader::Material& material = materials[meshes[i].materialIndex];
+            for(int type = Texture::TYPE::DIFFUSE; type <= Texture::TYPE::HEIGHT; type++)
+            {
+                for(size_t j = 0; j < material.texturePaths[type].size(); j++)
+                {
+                    Texture tex;
+                    memset(&tex, 0, sizeof(Texture)); // nullify
+                    tex.type = type;
+                    Image* image = loadImage(modelDir + material.texturePaths[type][j]);
+                    tex.textureID = image->getImageID();
+                    tex.residency = image->getResidency();
+                    textures.push_back(tex);
+                }
+            }
+        }
+
+        // normals for the corners without vn (one vertex per corner), within the crease angle
+        bool generateNormals = meshes[i].missingNormals.size() > 0;
+        if(generateNormals)
+        {
+            TangentSpace::Stats stats = tangentSpace.generateNormals(meshes[i].vertices, meshes[i].indices, &meshes[i].missingNormals);
+            tangentTotal.normalSeconds += stats.normalSeconds;
+            numNormalMeshes++;
+        }
+
+        // tangents only for normal and height maps
+        if(TangentSpace::needsTangents(textures))
+        {
+            TangentSpace::Stats stats = tangentSpace.generateTangents(meshes[i].vertices, meshes[i].indices);
+            tangentTotal.numTriangles += stats.numTriangles;
+            tangentTotal.tangentSeconds += stats.tangentSeconds;
+            numTangentMeshes++;
+        }
+
+        // v/vt/vn tuples are already unique; the per-corner vertices of generated normals are welded
+        if(generateNormals && s_weldVertices)
+        {
+            VertexWelder::Stats stats = welder.weld(meshes[i].vertices, meshes[i].indices);
+            numVerticesIn += stats.numVerticesIn;
+            numVerticesOut += stats.numVerticesOut;
+        }
+        m_meshes.push_back(new Mesh(meshes[i].vertices, meshes[i].indices, textures));
+        if(m_isOccluder) { m_meshes.back()->setOccluderGeometry(meshes[i].vertices, meshes[i].indices); }
+    }
+
+    // OBJ has no hierarchy: one root node holding every mesh
+    Node root;
+    root.name = modelPath;
+    root.parent = -1;
+    root.transformation = glm::mat4(1.0f);
+    for(unsigned int i = 0; i < m_meshes.size(); i++) { root.meshes.push_back(i); }
+    m_nodes.push_back(root);
+
+    if(numNormalMeshes || numTangentMeshes)
+    {
+        LOG_INFO(ASSET, "tangent space: normals for {} meshes in {:.3f} ms ({} -> {} vertices welded), tangents for {} of {} meshes in {:.3f} ms ({:.2f} Mtriangles/s)",
+            numNormalMeshes, tangentTotal.normalSeconds * 1000.0, numVerticesIn, numVerticesOut,
+            numTangentMeshes, meshes.size(), tangentTotal.tangentSeconds * 1000.0,
+            tangentTotal.tangentSeconds > 0.0 ? tangentTotal.numTriangles / tangentTotal.tangentSeconds / 1e6 : 0.0);
+    }
+}
+
+// load an image once per model
+Image* Model::loadImage(const std::string& imagePath)
+{
+    size_t numImages = m_images.size();
+    for(size_t i = 0; i < numImages; i++)
+    {
+        if(m_images[i]->getImagePath() == imagePath) { return m_images[i]; }
+    }
+
+    m_images.push_back(new Image(imagePath.c_str(), GL_TEXTURE_2D));
+    return m_images.back();
+}
+
+bool Model::isObjFile(const char* modelPath)
+{
+    std::string path = modelPath;
+    size_t dot = path.find_last_of('.');
+    if(dot == std::string::npos) { return false; }
+
+    std::string ext = path.substr(dot + 1);
+    for(size_t i = 0; i < ext.size(); i++) { ext[i] = static_cast<char>(tolower(ext[i])); }
+    return ext == "obj";
+}
@@ -0,0 +1,449 @@
+// include
+#include <ObjLoader.hpp>
+
+ObjLoader::ObjLoader()
+{
+    nullify();
+    m_flipUVs = true;
+}
+
+ObjLoader::ObjLoader(const char* objPath)
+{
+    nullify();
+    m_flipUVs = true;
+    loadFromFile(objPath);
+}
+
+// e.g.) ObjLoader loader; if(loader.loadFromFile("model.obj")) { ... loader.getMeshes() ... }
+// return: true (loaded), false (error)
+bool ObjLoader::loadFromFile(const char* objPath)
+{
+    // local vars
+    VirtualFile file;
+    std::vector<Chunk> chunks;
+    std::vector<std::vector<Segment>> meshSegments;
+    std::chrono::steady_clock::time_point start;
+    size_t numChunks, numPositions, numTexCoords, numNormals;
+    std::string objDir;
+    JobSystem& jobs = JobSystem::instance();
+
+    // check filepath
+    if(!objPath) { LOG_ERROR(ASSET, "ObjLoader::loadFromFile(nullptr): null filepath"); return false; }
+    LOG_INFO(ASSET, "ObjLoader::loadFromFile(\"{}\")", objPath);
+
+    // delete existing data
+    nullify();
+
+    start = std::chrono::steady_clock::now();
+    if(!file.open(objPath)) { return false; }
+
+    objDir = objPath;
+    objDir = objDir.substr(0, objDir.find_last_of("/\\") + 1); // find both '/' and '\'
+
+    // 1. line-aligned chunks (~1 MB, at least one per worker)
+    const char* data = file.getData();
+    const char* dataEnd = data + file.getSize();
+    numChunks = std::max<size_t>(1, std::min<size_t>(file.getSize() / (1 << 20) + 1, 4 * (jobs.getNumWorkers() + 1)));
+    chunks.resize(numChunks);
+    for(size_t i = 0; i < numChunks; i++)
+    {
+        const char* begin = i ? chunks[i - 1].end : data;
+        const char* end = (i + 1 == numChunks) ? dataEnd : data + file.getSize() * (i + 1) / numChunks;
+        if(end < begin) { end = begin; }
+        const char* newline = static_cast<const char*>(memchr(end, '\n', dataEnd - end));
+        chunks[i].begin = begin;
+        chunks[i].end = (i + 1 == numChunks || !newline) ? dataEnd : newline + 1;
+    }
+
+    // 2. parse
+    jobs.parallelFor(numChunks, 1, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++) { parseChunk(chunks[i]); }
+    });
+
+    // 3. resolve chunk-relative indices
+    numPositions = numTexCoords = numNormals = 0;
+    for(size_t i = 0; i < numChunks; i++)
+    {
+        if(chunks[i].error) { LOG_ERROR(ASSET, "malformed OBJ file: \"{}\"", objPath); return false; }
+        chunks[i].positionBase = numPositions;
+        chunks[i].texCoordBase = numTexCoords;
+        chunks[i].normalBase = numNormals;
+        numPositions += chunks[i].positions.size() / 3;
+        numTexCoords += chunks[i].texCoords.size() / 2;
+        numNormals += chunks[i].normals.size() / 3;
+    }
+    m_positions.resize(numPositions * 3);
+    m_texCoords.resize(numTexCoords * 2);
+    m_normals.resize(numNormals * 3);
+
+    jobs.parallelFor(numChunks, 1, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            Chunk& chunk = chunks[i];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), m_positions.begin() + chunk.positionBase * 3);
+            std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), m_texCoords.begin() + chunk.texCoordBase * 2);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), m_normals.begin() + chunk.normalBase * 3);
+            std::vector<float>().swap(chunk.positions);
+            std::vector<float>().swap(chunk.texCoords);
+            std::vector<float>().swap(chunk.normals);
+
+            for(size_t c = 0; c < chunk.corners.size(); c++)
+            {
+                uint8_t rel = chunk.relative[c];
+                if(rel & 1) { chunk.corners[c].v += static_cast<int32_t>(chunk.positionBase); }
+                if(rel & 2) { chunk.corners[c].vt += static_cast<int32_t>(chunk.texCoordBase); }
+                if(rel & 4) { chunk.corners[c].vn += static_cast<int32_t>(chunk.normalBase); }
+            }
+        }
+    });
+
+    // materials
+    for(size_t i = 0; i < numChunks; i++)
+    {
+        for(size_t j = 0; j < chunks[i].mtllibs.size(); j++) { loadMaterials(objDir + chunks[i].mtllibs[j]); }
+    }
+
+    // material runs -> one mesh per material, in order of first use
+    {
+        std::unordered_map<std::string, int> materialIndices;
+        std::unordered_map<int, size_t> meshOfMaterial;
+        int current = -1;
+
+        for(size_t i = 0; i < m_materials.size(); i++) { materialIndices[m_materials[i].name] = static_cast<int>(i); }
+
+        for(size_t i = 0; i < numChunks; i++)
+        {
+            size_t numTriangles = chunks[i].corners.size() / 3;
+            size_t first = 0;
+
+            for(size_t s = 0; s <= chunks[i].switches.size(); s++)
+            {
+                size_t last = (s < chunks[i].switches.size()) ? chunks[i].switches[s].firstTriangle : numTriangles;
+                if(last > first)
+                {
+                    std::unordered_map<int, size_t>::iterator it = meshOfMaterial.find(current);
+                    if(it == meshOfMaterial.end())
+                    {
+                        it = meshOfMaterial.emplace(current, m_meshes.size()).first;
+                        m_meshes.emplace_back();
+                        m_meshes.back().materialIndex = current;
+                        meshSegments.emplace_back();
+                    }
+                    meshSegments[it->second].push_back({ i, first, last });
+                }
+                if(s < chunks[i].switches.size())
+                {
+                    std::unordered_map<std::string, int>::iterator found = materialIndices.find(chunks[i].switches[s].name);
+                    if(found == materialIndices.end()) { LOG_WARN(ASSET, "undefined material \"{}\"", chunks[i].switches[s].name); }
+                    current = (found == materialIndices.end()) ? -1 : found->second;
+                    first = last;
+                }
+            }
+        }
+    }
+
+    // 4. build meshes
+    std::vector<char> meshOK(m_meshes.size(), 0);
+    jobs.parallelFor(m_meshes.size(), 1, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++) { meshOK[i] = buildMesh(chunks, meshSegments[i], m_meshes[i]); }
+    });
+    for(size_t i = 0; i < meshOK.size(); i++)
+    {
+        if(!meshOK[i]) { LOG_ERROR(ASSET, "index out of range in OBJ file: \"{}\"", objPath); nullify(); return false; }
+    }
+
+    // scratch data is no longer needed
+    std::vector<float>().swap(m_positions);
+    std::vector<float>().swap(m_texCoords);
+    std::vector<float>().swap(m_normals);
+
+    m_stats.numBytes = file.getSize();
+    for(size_t i = 0; i < m_meshes.size(); i++)
+    {
+        m_stats.numTriangles += m_meshes[i].indices.size() / 3;
+        m_stats.numVertices += m_meshes[i].vertices.size();
+    }
+    m_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LOG_INFO(ASSET, "parsed {:.2f} MB ({} meshes, {} triangles, {} vertices) in {:.3f} ms ({:.1f} MB/s)",
+        m_stats.numBytes / 1e6, m_meshes.size(), m_stats.numTriangles, m_stats.numVertices,
+        m_stats.seconds * 1000.0, m_stats.seconds > 0.0 ? m_stats.numBytes / m_stats.seconds / 1e6 : 0.0);
+    return true;
+}
+
+void ObjLoader::parseChunk(Chunk& chunk)
+{
+    // local vars
+    const char* p = chunk.begin;
+    std::vector<Corner> face;
+    std::vector<uint8_t> faceRelative;
+
+    chunk.error = false;
+    while(p < chunk.end)
+    {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', chunk.end - p));
+        if(!lineEnd) { lineEnd = chunk.end; }
+
+        const char* q = skipSpace(p, lineEnd);
+        if(q < lineEnd)
+        {
+            if(isKeyword(q, lineEnd, "v"))
+            {
+                float xyz[3] = { 0.0f, 0.0f, 0.0f };
+                q += 1;
+                for(int k = 0; k < 3; k++) { q = parseFloat(skipSpace(q, lineEnd), lineEnd, xyz[k]); }
+                if(!q) { chunk.error = true; return; }
+                chunk.positions.insert(chunk.positions.end(), xyz, xyz + 3);
+            }
+            else if(isKeyword(q, lineEnd, "vt"))
+            {
+                float uv[2] = { 0.0f, 0.0f };
+                q = parseFloat(skipSpace(q + 2, lineEnd), lineEnd, uv[0]);
+                if(!q) { chunk.error = true; return; }
+                q = skipSpace(q, lineEnd);
+                if(q < lineEnd) { q = parseFloat(q, lineEnd, uv[1]); } // 1D texture coordinates are valid
+                if(!q) { chunk.error = true; return; }
+                if(m_flipUVs) { uv[1] = 1.0f - uv[1]; }
+                chunk.texCoords.insert(chunk.texCoords.end(), uv, uv + 2);
+            }
+            else if(isKeyword(q, lineEnd, "vn"))
+            {
+                float xyz[3] = { 0.0f, 0.0f, 0.0f };
+                q += 2;
+                for(int k = 0; k < 3; k++) { q = parseFloat(skipSpace(q, lineEnd), lineEnd, xyz[k]); }
+                if(!q) { chunk.error = true; return; }
+                chunk.normals.insert(chunk.normals.end(), xyz, xyz + 3);
+            }
+            else if(isKeyword(q, lineEnd, "f"))
+            {
+                face.clear();
+                faceRelative.clear();
+                q = skipSpace(q + 1, lineEnd);
+                while(q < lineEnd)
+                {
+                    int32_t idx[3] = { MISSING, MISSING, MISSING };
+                    int32_t counts[3] =
+                    {
+                        static_cast<int32_t>(chunk.positions.size() / 3),
+                        static_cast<int32_t>(chunk.texCoords.size() / 2),
+                        static_cast<int32_t>(chunk.normals.size() / 3)
+                    };
+                    uint8_t rel = 0;
+
+                    // v, v/vt, v//vn, v/vt/vn
+                    for(int k = 0; k < 3; k++)
+                    {
+                        if(k)
+                        {
+                            if(q >= lineEnd || *q != '/') { break; }
+                            q++;
+                            if(q < lineEnd && *q == '/') { continue; } // v//vn
+                        }
+                        if(q >= lineEnd || *q == ' ' || *q == '\t' || *q == '\r') { break; }
+                        q = parseIndex(q, lineEnd, idx[k]);
+                        if(!q || idx[k] == 0) { chunk.error = true; return; }
+                        if(idx[k] > 0) { idx[k] -= 1; }
+                        else { idx[k] += counts[k]; rel |= static_cast<uint8_t>(1 << k); }
+                    }
+
+                    face.push_back({ idx[0], idx[1], idx[2] });
+                    faceRelative.push_back(rel);
+                    q = skipSpace(skipToken(q, lineEnd), lineEnd);
+                }
+
+                // fan triangulation
+                for(size_t k = 1; k + 1 < face.size(); k++)
+                {
+                    size_t fan[3] = { 0, k, k + 1 };
+                    for(int c = 0; c < 3; c++)
+                    {
+                        chunk.corners.push_back(face[fan[c]]);
+                        chunk.relative.push_back(faceRelative[fan[c]]);
+                    }
+                }
+            }
+            else if(isKeyword(q, lineEnd, "usemtl"))
+            {
+                chunk.switches.push_back({ chunk.corners.size() / 3, readName(q + 6, lineEnd) });
+            }
+            else if(isKeyword(q, lineEnd, "mtllib"))
+            {
+                chunk.mtllibs.push_back(readName(q + 6, lineEnd));
+            }
+            // o, g, s, l, p, comments and others are ignored
+        }
+
+        p = lineEnd + 1;
+    }
+}
+
+// newmtl/map_Kd/map_Ks/norm/map_bump, mapped to Texture::TYPE the same way assimp does
+bool ObjLoader::loadMaterials(const std::string& mtlPath)
+{
+    // local vars
+    VirtualFile file;
+    const char *p, *end;
+    Material* current = nullptr;
+
+    LOG_INFO(ASSET, "ObjLoader::loadMaterials(\"{}\")", mtlPath);
+    if(!file.open(mtlPath.c_str())) { return false; }
+
+    p = file.getData();
+    end = p + file.getSize();
+    while(p < end)
+    {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if(!lineEnd) { lineEnd = end; }
+
+        const char* q = skipSpace(p, lineEnd);
+        const char* keyEnd = skipToken(q, lineEnd);
+        std::string key(q, keyEnd);
+        int type = -1;
+
+        if(key == "newmtl")
+        {
+            m_materials.emplace_back();
+            current = &m_materials.back();
+            current->name = readName(keyEnd, lineEnd);
+        }
+        else if(key == "map_Kd") { type = Texture::TYPE::DIFFUSE; }
+        else if(key == "map_Ks") { type = Texture::TYPE::SPECULAR; }
+        else if(key == "norm" || key == "map_Kn") { type = Texture::TYPE::NORMAL; }
+        else if(key == "map_bump" || key == "map_Bump" || key == "bump") { type = Texture::TYPE::HEIGHT; }
+
+        if(type >= 0 && current)
+        {
+            // options (e.g. -bm 1.0) come first, the file name is the last token
+            std::string args = readName(keyEnd, lineEnd);
+            size_t split = args.find_last_of(" \t");
+            current->texturePaths[type].push_back(split == std::string::npos ? args : args.substr(split + 1));
+        }
+
+        p = lineEnd + 1;
+    }
+
+    return true;
+}
+
+// deduplicate v/vt/vn tuples of the given triangle runs into one MeshData
+// corners without vn are not deduplicated: TangentSpace::generateNormals() then sees one vertex per corner
+// and keeps crease edges exact (as with assimp, which does not join vertices before aiProcess_GenSmoothNormals)
+// return: true (ok), false (index out of range)
+bool ObjLoader::buildMesh(std::vector<Chunk>& chunks, std::vector<Segment>& segments, MeshData& mesh)
+{
+    // local vars
+    size_t numCorners = 0;
+    size_t capacity = 1;
+    bool missingNormals = false;
+    const int32_t numPositions = static_cast<int32_t>(m_positions.size() / 3);
+    const int32_t numTexCoords = static_cast<int32_t>(m_texCoords.size() / 2);
+    const int32_t numNormals = static_cast<int32_t>(m_normals.size() / 3);
+
+    for(size_t s = 0; s < segments.size(); s++) { numCorners += (segments[s].lastTriangle - segments[s].firstTriangle) * 3; }
+    while(capacity < numCorners * 2) { capacity <<= 1; }
+
+    // open-addressing table: corner tuple -> vertex index
+    std::vector<Corner> keys(capacity);
+    std::vector<uint32_t> values(capacity, 0xFFFFFFFFu);
+
+    mesh.indices.reserve(numCorners);
+    mesh.vertices.reserve(numCorners / 3);
+    for(size_t s = 0; s < segments.size(); s++)
+    {
+        Chunk& chunk = chunks[segments[s].chunk];
+        for(size_t c = segments[s].firstTriangle * 3; c < segments[s].lastTriangle * 3; c++)
+        {
+            const Corner& corner = chunk.corners[c];
+            if(corner.v < 0 || corner.v >= numPositions) { return false; }
+            if(corner.vt != MISSING && (corner.vt < 0 || corner.vt >= numTexCoords)) { return false; }
+            if(corner.vn != MISSING && (corner.vn < 0 || corner.vn >= numNormals)) { return false; }
+
+            size_t slot = 0;
+            if(corner.vn != MISSING)
+            {
+                uint32_t hash = static_cast<uint32_t>(corner.v) * 73856093u ^ static_cast<uint32_t>(corner.vt) * 19349663u ^ static_cast<uint32_t>(corner.vn) * 83492791u;
+                slot = (hash ^ (hash >> 16)) & (capacity - 1);
+                while(values[slot] != 0xFFFFFFFFu && !(keys[slot].v == corner.v && keys[slot].vt == corner.vt && keys[slot].vn == corner.vn))
+                {
+                    slot = (slot + 1) & (capacity - 1);
+                }
+                if(values[slot] != 0xFFFFFFFFu)
+                {
+                    mesh.indices.push_back(values[slot]);
+                    continue;
+                }
+            }
+
+            Vertex vert{}; // nullify
+            vert.position = glm::vec3(m_positions[corner.v * 3], m_positions[corner.v * 3 + 1], m_positions[corner.v * 3 + 2]);
+            if(corner.vt != MISSING) { vert.texCoord = glm::vec2(m_texCoords[corner.vt * 2], m_texCoords[corner.vt * 2 + 1]); }
+            if(corner.vn != MISSING)
+            {
+                vert.normal = glm::vec3(m_normals[corner.vn * 3], m_normals[corner.vn * 3 + 1], m_normals[corner.vn * 3 + 2]);
+                keys[slot] = corner;
+                values[slot] = static_cast<uint32_t>(mesh.vertices.size());
+            }
+            else if(!missingNormals)
+            {
+                mesh.missingNormals.assign(mesh.vertices.size(), 0);
+                missingNormals = true;
+            }
+
+            mesh.indices.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+            mesh.vertices.push_back(vert);
+            if(missingNormals) { mesh.missingNormals.push_back(corner.vn == MISSING); }
+        }
+    }
+
+    return true;
+}
+
+const char* ObjLoader::skipSpace(const char* p, const char* end)
+{
+    while(p && p < end && (*p == ' ' || *p == '\t' || *p == '\r')) { p++; }
+    return p;
+}
+
+const char* ObjLoader::skipToken(const char* p, const char* end)
+{
+    while(p && p < end && *p != ' ' && *p != '\t' && *p != '\r') { p++; }
+    return p;
+}
+
+// return: end of the number, nullptr on error
+const char* ObjLoader::parseFloat(const char* p, const char* end, float& f)
+{
+    if(!p || p >= end) { return nullptr; }
+    if(*p == '+') { p++; } // std::from_chars() rejects a leading '+'
+
+    std::from_chars_result result = std::from_chars(p, end, f);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+// return: end of the number, nullptr on error
+const char* ObjLoader::parseIndex(const char* p, const char* end, int32_t& i)
+{
+    if(!p || p >= end) { return nullptr; }
+
+    std::from_chars_result result = std::from_chars(p, end, i);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+// rest of the line without surrounding whitespace
+std::string ObjLoader::readName(const char* p, const char* end)
+{
+    p = skipSpace(p, end);
+    while(end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) { end--; }
+    return std::string(p, end);
+}
+
+// keyword followed by whitespace (or the end of the line)
+bool ObjLoader::isKeyword(const char* p, const char* end, const char* keyword)
+{
+    size_t len = strlen(keyword);
+    if(static_cast<size_t>(end - p) < len || memcmp(p, keyword, len)) { return false; }
+    return p + len == end || p[len] == ' ' || p[len] == '\t' || p[len] == '\r';
+}
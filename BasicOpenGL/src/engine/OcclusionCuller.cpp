@@ -0,0 +1,283 @@
+// include
+#include <OcclusionCuller.hpp>
+
+OcclusionCuller::OcclusionCuller()
+{
+    nullify();
+    setResolution(256, 128);
+}
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+{
+    nullify();
+    setResolution(width, height);
+}
+
+OcclusionCuller::Stats OcclusionCuller::getStats() const
+{
+    Stats stats;
+    stats.numOccluderTriangles = m_numOccluderTriangles;
+    stats.numTested = m_numTested;
+    stats.numCulled = m_numCulled;
+    stats.numOffscreen = m_numOffscreen;
+    stats.rasterMs = m_rasterMs;
+    return stats;
+}
+
+// width is rounded up to a multiple of 4 (one SSE register per 4 pixels)
+void OcclusionCuller::setResolution(int width, int height)
+{
+    m_width = std::max(4, (width + 3) & ~3);
+    m_height = std::max(1, height);
+    m_depth.assign(static_cast<size_t>(m_width) * m_height, 1.0f);
+
+    // pyramid: level 0 = full resolution, down to 1x1
+    std::vector<Level>().swap(m_levels);
+    int w = m_width, h = m_height;
+    while(true)
+    {
+        Level level;
+        level.width = w;
+        level.height = h;
+        level.minDepth.assign(static_cast<size_t>(w) * h, 1.0f);
+        level.maxDepth.assign(static_cast<size_t>(w) * h, 1.0f);
+        m_levels.push_back(level);
+        if(w == 1 && h == 1) { break; }
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    }
+}
+
+// clear the occluder list and counters
+void OcclusionCuller::beginFrame(const glm::mat4& viewProj)
+{
+    m_viewProj = viewProj;
+    m_vertices.clear();
+    m_indices.clear();
+    m_numOccluderTriangles = 0;
+    m_numTested = m_numCulled = m_numOffscreen = 0;
+}
+
+// positions/indices: occluder triangles in model space (indexed triangle list)
+void OcclusionCuller::addOccluder(const glm::vec3* positions, size_t numPositions, const unsigned int* indices, size_t numIndices, const glm::mat4& model)
+{
+    glm::mat4 mvp = m_viewProj * model;
+    uint32_t base = static_cast<uint32_t>(m_vertices.size());
+
+    m_vertices.resize(m_vertices.size() + numPositions);
+    JobSystem::instance().parallelFor(numPositions, 4096, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            glm::vec4 clip = mvp * glm::vec4(positions[i], 1.0f);
+            ScreenVertex& sv = m_vertices[base + i];
+            sv.valid = clip.w > 1e-5f;
+            if(!sv.valid) { continue; }
+
+            float invW = 1.0f / clip.w;
+            sv.x = (clip.x * invW * 0.5f + 0.5f) * m_width;
+            sv.y = (clip.y * invW * 0.5f + 0.5f) * m_height;
+            sv.z = clip.z * invW * 0.5f + 0.5f;
+        }
+    });
+
+    for(size_t i = 0; i + 2 < numIndices; i += 3)
+    {
+        m_indices.push_back(base + indices[i]);
+        m_indices.push_back(base + indices[i + 1]);
+        m_indices.push_back(base + indices[i + 2]);
+    }
+    m_numOccluderTriangles += numIndices / 3;
+}
+
+// rasterize the occluders added since beginFrame() and rebuild the pyramid
+void OcclusionCuller::rasterize()
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    JobSystem& jobs = JobSystem::instance();
+
+    std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+
+    // bands of rows: every job owns its rows, so no synchronization is needed
+    const int rowsPerBand = 8;
+    size_t numBands = static_cast<size_t>((m_height + rowsPerBand - 1) / rowsPerBand);
+    jobs.parallelFor(numBands, 1, [&](size_t begin, size_t end)
+    {
+        for(size_t band = begin; band < end; band++)
+        {
+            int y0 = static_cast<int>(band) * rowsPerBand;
+            rasterizeRows(y0, std::min(y0 + rowsPerBand, m_height));
+        }
+    });
+
+    buildPyramid();
+    m_rasterMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// rasterize every occluder triangle into rows [y0, y1), keeping the nearest depth
+void OcclusionCuller::rasterizeRows(int y0, int y1)
+{
+    for(size_t t = 0; t + 2 < m_indices.size(); t += 3)
+    {
+        const ScreenVertex& a = m_vertices[m_indices[t]];
+        const ScreenVertex& b = m_vertices[m_indices[t + 1]];
+        const ScreenVertex& c = m_vertices[m_indices[t + 2]];
+
+        // triangles crossing the near plane are skipped (conservative: they occlude nothing)
+        if(!(a.valid && b.valid && c.valid)) { continue; }
+
+        // pixel-center bounding box, clipped to the band
+        int minX = std::max(0, static_cast<int>(std::ceil(std::min(a.x, std::min(b.x, c.x)) - 0.5f)));
+        int maxX = std::min(m_width - 1, static_cast<int>(std::floor(std::max(a.x, std::max(b.x, c.x)) - 0.5f)));
+        int minY = std::max(y0, static_cast<int>(std::ceil(std::min(a.y, std::min(b.y, c.y)) - 0.5f)));
+        int maxY = std::min(y1 - 1, static_cast<int>(std::floor(std::max(a.y, std::max(b.y, c.y)) - 0.5f)));
+        if(minX > maxX || minY > maxY) { continue; }
+
+        // edge functions E(x, y) = A * x + B * y + C, positive inside (either winding)
+        float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if(std::fabs(area) < 1e-8f) { continue; }
+        float sign = area > 0.0f ? 1.0f : -1.0f;
+        float invArea = 1.0f / std::fabs(area);
+
+        float A0 = (b.y - c.y) * sign, B0 = (c.x - b.x) * sign, C0 = (b.x * c.y - b.y * c.x) * sign;
+        float A1 = (c.y - a.y) * sign, B1 = (a.x - c.x) * sign, C1 = (c.x * a.y - c.y * a.x) * sign;
+        float A2 = (a.y - b.y) * sign, B2 = (b.x - a.x) * sign, C2 = (a.x * b.y - a.y * b.x) * sign;
+
+        // depth is affine in screen space: z = zA * x + zB * y + zC
+        float zA = (A0 * a.z + A1 * b.z + A2 * c.z) * invArea;
+        float zB = (B0 * a.z + B1 * b.z + B2 * c.z) * invArea;
+        float zC = (C0 * a.z + C1 * b.z + C2 * c.z) * invArea;
+
+        int startX = minX & ~3; // aligned to 4 pixels
+        for(int y = minY; y <= maxY; y++)
+        {
+            float py = y + 0.5f;
+            float* row = &m_depth[static_cast<size_t>(y) * m_width];
+
+#ifdef SIMD_SSE
+            __m128 xOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            __m128 vA0 = _mm_set1_ps(A0), vA1 = _mm_set1_ps(A1), vA2 = _mm_set1_ps(A2), vZA = _mm_set1_ps(zA);
+            __m128 rowE0 = _mm_set1_ps(B0 * py + C0), rowE1 = _mm_set1_ps(B1 * py + C1), rowE2 = _mm_set1_ps(B2 * py + C2);
+            __m128 rowZ = _mm_set1_ps(zB * py + zC);
+            __m128 zero = _mm_setzero_ps();
+
+            for(int x = startX; x <= maxX; x += 4)
+            {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), xOffsets);
+                __m128 e0 = _mm_add_ps(_mm_mul_ps(vA0, px), rowE0);
+                __m128 e1 = _mm_add_ps(_mm_mul_ps(vA1, px), rowE1);
+                __m128 e2 = _mm_add_ps(_mm_mul_ps(vA2, px), rowE2);
+                __m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+                if(!_mm_movemask_ps(inside)) { continue; }
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(vZA, px), rowZ);
+                __m128 old = _mm_loadu_ps(row + x);
+                __m128 nearest = _mm_min_ps(old, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+            }
+#else
+            for(int x = minX; x <= maxX; x++)
+            {
+                float px = x + 0.5f;
+                if(A0 * px + B0 * py + C0 < 0.0f || A1 * px + B1 * py + C1 < 0.0f || A2 * px + B2 * py + C2 < 0.0f) { continue; }
+                row[x] = std::min(row[x], zA * px + zB * py + zC);
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionCuller::buildPyramid()
+{
+    JobSystem& jobs = JobSystem::instance();
+
+    // level 0: the depth buffer itself
+    std::copy(m_depth.begin(), m_depth.end(), m_levels[0].minDepth.begin());
+    std::copy(m_depth.begin(), m_depth.end(), m_levels[0].maxDepth.begin());
+
+    for(size_t l = 1; l < m_levels.size(); l++)
+    {
+        Level& src = m_levels[l - 1];
+        Level& dst = m_levels[l];
+        jobs.parallelFor(static_cast<size_t>(dst.height), 16, [&](size_t begin, size_t end)
+        {
+            for(size_t y = begin; y < end; y++)
+            {
+                int sy0 = static_cast<int>(y) * 2, sy1 = std::min(sy0 + 1, src.height - 1);
+                for(int x = 0; x < dst.width; x++)
+                {
+                    int sx0 = x * 2, sx1 = std::min(sx0 + 1, src.width - 1);
+                    size_t i00 = static_cast<size_t>(sy0) * src.width + sx0, i01 = static_cast<size_t>(sy0) * src.width + sx1;
+                    size_t i10 = static_cast<size_t>(sy1) * src.width + sx0, i11 = static_cast<size_t>(sy1) * src.width + sx1;
+                    size_t d = y * dst.width + x;
+                    dst.minDepth[d] = std::min(std::min(src.minDepth[i00], src.minDepth[i01]), std::min(src.minDepth[i10], src.minDepth[i11]));
+                    dst.maxDepth[d] = std::max(std::max(src.maxDepth[i00], src.maxDepth[i01]), std::max(src.maxDepth[i10], src.maxDepth[i11]));
+                }
+            }
+        });
+    }
+}
+
+// boundsMin/boundsMax: model-space AABB
+// return: false if the box is outside the frustum or entirely behind the rasterized occluders
+bool OcclusionCuller::isVisible(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model) const
+{
+    glm::mat4 mvp = m_viewProj * model;
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, nearest = 1.0f;
+    int outside[6] = { 0, 0, 0, 0, 0, 0 };
+
+    m_numTested++;
+    for(int i = 0; i < 8; i++)
+    {
+        glm::vec3 corner((i & 1) ? boundsMax.x : boundsMin.x, (i & 2) ? boundsMax.y : boundsMin.y, (i & 4) ? boundsMax.z : boundsMin.z);
+        glm::vec4 clip = mvp * glm::vec4(corner, 1.0f);
+
+        outside[0] += clip.x < -clip.w; outside[1] += clip.x > clip.w;
+        outside[2] += clip.y < -clip.w; outside[3] += clip.y > clip.w;
+        outside[4] += clip.z < -clip.w; outside[5] += clip.z > clip.w;
+        if(clip.w <= 1e-5f) { nearest = 0.0f; continue; } // crosses the near plane: cannot be occluded
+
+        float invW = 1.0f / clip.w;
+        float sx = (clip.x * invW * 0.5f + 0.5f) * m_width;
+        float sy = (clip.y * invW * 0.5f + 0.5f) * m_height;
+        minX = std::min(minX, sx); maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy); maxY = std::max(maxY, sy);
+        nearest = std::min(nearest, std::max(0.0f, clip.z * invW * 0.5f + 0.5f));
+    }
+
+    // all corners outside one clip plane
+    for(int p = 0; p < 6; p++)
+    {
+        if(outside[p] == 8) { m_numOffscreen++; return false; }
+    }
+    if(nearest <= 0.0f) { return true; }
+
+    int x0 = std::max(0, static_cast<int>(std::floor(minX))), x1 = std::min(m_width - 1, static_cast<int>(std::floor(maxX)));
+    int y0 = std::max(0, static_cast<int>(std::floor(minY))), y1 = std::min(m_height - 1, static_cast<int>(std::floor(maxY)));
+    if(x0 > x1 || y0 > y1) { m_numOffscreen++; return false; }
+
+    // start at the coarsest level where the rectangle covers at most 2x2 texels, refine at most twice
+    // min/max per texel: nearer than every occluder -> visible; farther than every occluder -> keep checking
+    size_t coarse = 0;
+    while(coarse + 1 < m_levels.size() && ((x1 >> coarse) - (x0 >> coarse) > 1 || (y1 >> coarse) - (y0 >> coarse) > 1)) { coarse++; }
+
+    for(size_t l = coarse; ; l--)
+    {
+        const Level& level = m_levels[l];
+        bool ambiguous = false;
+        for(int y = (y0 >> l); y <= (y1 >> l); y++)
+        {
+            for(int x = (x0 >> l); x <= (x1 >> l); x++)
+            {
+                size_t i = static_cast<size_t>(y) * level.width + x;
+                if(nearest < level.minDepth[i]) { return true; }
+                if(nearest <= level.maxDepth[i]) { ambiguous = true; }
+            }
+        }
+        if(!ambiguous) { break; }                     // behind the farthest occluder everywhere
+        if(l == 0 || coarse - l == 2) { return true; } // give up: treat as visible
+    }
+
+    m_numCulled++;
+    return false;
+}
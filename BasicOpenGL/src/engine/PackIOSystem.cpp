@@ -0,0 +1,49 @@
+// include
+#include <PackIOSystem.hpp>
+
+// return: number of whole elements read
+size_t PackIOStream::Read(void* buffer, size_t size, size_t count)
+{
+    if(!size || !count) { return 0; }
+
+    size_t remaining = m_file.getSize() - m_position;
+    count = std::min(count, remaining / size);
+    memcpy(buffer, m_file.getData() + m_position, size * count);
+    m_position += size * count;
+    return count;
+}
+
+aiReturn PackIOStream::Seek(size_t offset, aiOrigin origin)
+{
+    // local vars
+    size_t position;
+
+    switch (origin)
+    {
+    case aiOrigin_SET: position = offset; break;
+    case aiOrigin_CUR: position = m_position + offset; break;
+    case aiOrigin_END: position = m_file.getSize() - offset; break;
+    default: return aiReturn_FAILURE;
+    }
+    if(position > m_file.getSize()) { return aiReturn_FAILURE; }
+
+    m_position = position;
+    return aiReturn_SUCCESS;
+}
+
+bool PackIOSystem::Exists(const char* filePath) const { return FileSystem::instance().exists(filePath); }
+
+// read-only: nullptr for write modes
+Assimp::IOStream* PackIOSystem::Open(const char* filePath, const char* mode)
+{
+    // local vars
+    PackIOStream* stream;
+
+    if(!filePath || (mode && (strchr(mode, 'w') || strchr(mode, 'a') || strchr(mode, '+')))) { return nullptr; }
+
+    stream = new PackIOStream();
+    if(!stream->open(filePath)) { delete stream; return nullptr; }
+    return stream;
+}
+
+void PackIOSystem::Close(Assimp::IOStream* stream) { delete stream; }
@@ -0,0 +1,230 @@
+// include
+#include <ParticleSystem.hpp>
+
+// std
+#include <cstddef>
+
+// capacity: particle slots, clamped to MAX_CAPACITY (32 bytes each, twice)
+// simShaderPath: shader/particle_sim.vs, vertShaderPath/fragShaderPath: shader/particle.vs, particle.fs
+// return: false if a shader does not compile or a buffer cannot be created
+bool ParticleSystem::init(size_t capacity, const char* simShaderPath, const char* vertShaderPath, const char* fragShaderPath)
+{
+    // local vars
+    GLState& gl = GLState::instance();
+    GLsizeiptr bytes;
+
+    LOG_INFO(RENDER, "ParticleSystem::init({})", capacity);
+    releaseBuffers();
+
+    m_capacity = std::min(std::max<size_t>(capacity, 1), MAX_CAPACITY);
+    if(m_capacity != capacity) { LOG_WARN(RENDER, "ParticleSystem::init(): capacity clamped to {}", m_capacity); }
+
+    // the simulation is captured, in this order, into the target buffer
+    m_simProgram.loadFeedbackFromFile(simShaderPath, nullptr, { "outPositionAge", "outVelocityLife" });
+    m_drawProgram.loadFromFile(vertShaderPath, fragShaderPath, nullptr);
+    if(!m_simProgram.getShaderProgramID() || !m_drawProgram.getShaderProgramID())
+    {
+        LOG_ERROR(RENDER, "failed to load the particle shaders");
+        releaseBuffers();
+        return false;
+    }
+
+    // ping-pong buffers; the first update() overwrites their undefined contents
+    bytes = static_cast<GLsizeiptr>(m_capacity * sizeof(Particle));
+    glGenBuffers(2, m_buffers);
+    glGenVertexArrays(2, m_simVAOs);
+    glGenVertexArrays(2, m_drawVAOs);
+    glGenBuffers(1, &m_emitBuffer);
+    glGenTextures(1, &m_emitTexture);
+    glGenQueries(NUM_QUERIES, m_queries);
+    if(!(m_buffers[0] && m_buffers[1] && m_simVAOs[0] && m_simVAOs[1] && m_drawVAOs[0] && m_drawVAOs[1] && m_emitBuffer && m_emitTexture))
+    {
+        LOG_ERROR(RENDER, "failed to generate particle buffers");
+        releaseBuffers();
+        return false;
+    }
+
+    for(int i = 0; i < 2; i++)
+    {
+        gl.bindBuffer(GL_ARRAY_BUFFER, m_buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_DYNAMIC_COPY);
+
+        // update(): one vertex per particle, draw(): one instance per particle
+        GLuint VAOs[2] = { m_simVAOs[i], m_drawVAOs[i] };
+        for(GLuint divisor = 0; divisor < 2; divisor++)
+        {
+            gl.bindVertexArray(VAOs[divisor]);
+            gl.bindBuffer(GL_ARRAY_BUFFER, m_buffers[i]);
+            glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, positionAge));
+            glEnableVertexAttribArray(0);
+            glVertexAttribDivisor(0, divisor);
+            glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, velocityLife));
+            glEnableVertexAttribArray(1);
+            glVertexAttribDivisor(1, divisor);
+        }
+    }
+    gl.bindVertexArray(0);
+
+    // spawn buffer: refilled by every update(), the buffer texture keeps pointing at it
+    gl.bindBuffer(GL_TEXTURE_BUFFER, m_emitBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, MAX_EMITS * sizeof(Emit), nullptr, GL_STREAM_DRAW);
+    gl.editTexture(GL_TEXTURE_BUFFER, m_emitTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_emitBuffer);
+
+    m_stats.capacity = m_capacity;
+    LOG_INFO(RENDER, "{} particle slots, {:.1f} MB", m_capacity, 2.0 * bytes / 1048576.0);
+    return true;
+}
+
+// count particles around position (up to radius away), with velocity plus up to spread,
+// living between minLife and maxLife seconds; spawned by the next update()
+// e.g.) particles.emit(nozzle, glm::vec3(0.0f, 4.0f, 0.0f), 0.5f, 0.02f, 1000, 2.0f, 3.0f);
+void ParticleSystem::emit(const glm::vec3& position, const glm::vec3& velocity, float spread, float radius, size_t count, float minLife, float maxLife)
+{
+    if(!count || m_numSpawns >= m_capacity) { return; }
+    if(m_emits.size() == MAX_EMITS) { LOG_WARN(RENDER, "ParticleSystem::emit(): more than {} emits in a frame", MAX_EMITS); return; }
+
+    Emit emit;
+    emit.positionFirst = glm::vec4(position, static_cast<float>(m_numSpawns));
+    emit.velocitySpread = glm::vec4(velocity, spread);
+    emit.radiusLife = glm::vec4(radius, minLife, maxLife, 0.0f);
+    m_emits.push_back(emit);
+    m_numSpawns = std::min(m_numSpawns + count, m_capacity);
+}
+
+// spawn this frame's emits and advance every particle by deltaTime seconds
+// GPU work only: one buffer upload of the emits and one draw of capacity points
+void ParticleSystem::update(float deltaTime)
+{
+    // local vars
+    GLState& gl = GLState::instance();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int source = m_current, target = 1 - m_current;
+    int query = static_cast<int>(m_stats.numFrames % NUM_QUERIES);
+
+    if(!m_buffers[0]) { return; }
+    readQueries();
+
+    if(m_emits.size())
+    {
+        // orphan and refill: the driver does not have to wait for the previous frame
+        gl.bindBuffer(GL_TEXTURE_BUFFER, m_emitBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, MAX_EMITS * sizeof(Emit), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, m_emits.size() * sizeof(Emit), &m_emits[0]);
+    }
+
+    m_simProgram.use();
+    gl.bindTexture(EMIT_UNIT, GL_TEXTURE_BUFFER, m_emitTexture);
+    m_simProgram.setSampler("emits", EMIT_UNIT);
+    m_simProgram.setInt("numEmits", static_cast<int>(m_emits.size()));
+    m_simProgram.setInt("numSpawned", static_cast<int>(m_numSpawns));
+    m_simProgram.setInt("head", static_cast<int>(m_head));
+    m_simProgram.setInt("capacity", static_cast<int>(m_capacity));
+    glUniform1ui(m_simProgram.getUniformLocation("seed"), m_seed);
+    m_simProgram.setBool("initialize", !m_initialized);
+    m_simProgram.setFloat("deltaTime", deltaTime);
+    m_simProgram.setVec3("gravity", m_gravity);
+    m_simProgram.setFloat("drag", m_drag);
+
+    // source -> target, nothing rasterized
+    gl.bindVertexArray(m_simVAOs[source]);
+    gl.bindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_buffers[target], 0, static_cast<GLsizeiptr>(m_capacity * sizeof(Particle)));
+    if(!m_queryPending[query]) { glBeginQuery(GL_TIME_ELAPSED, m_queries[query]); }
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBeginTransformFeedback(GL_POINTS);
+    gl.traceDraw(GL_POINTS, static_cast<GLuint>(m_capacity));
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_capacity));
+    glEndTransformFeedback();
+    glDisable(GL_RASTERIZER_DISCARD);
+    if(!m_queryPending[query])
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_queryPending[query] = true;
+    }
+
+    m_stats.numEmits = m_emits.size();
+    m_stats.numSpawned = m_numSpawns;
+    m_stats.numFrames++;
+    m_head = (m_head + m_numSpawns) % m_capacity;
+    m_current = target;
+    m_initialized = true;
+    m_seed = m_seed * 1664525u + 1013904223u;
+    m_numSpawns = 0;
+    m_emits.clear();
+    m_stats.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// additive, camera-facing quads; depth tested against the scene but not written
+// leaves blending disabled and depth writes enabled
+void ParticleSystem::draw(const glm::mat4& view, const glm::mat4& projection)
+{
+    // local vars
+    GLState& gl = GLState::instance();
+    glm::mat4 viewMatrix = view, projectionMatrix = projection;
+
+    if(!m_initialized) { return; }
+
+    m_drawProgram.use();
+    m_drawProgram.setMat4("view", viewMatrix);
+    m_drawProgram.setMat4("projection", projectionMatrix);
+    m_drawProgram.setVec2("size", m_size);
+    m_drawProgram.setVec4("startColor", m_startColor);
+    m_drawProgram.setVec4("endColor", m_endColor);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    glDepthMask(GL_FALSE);
+    gl.bindVertexArray(m_drawVAOs[m_current]);
+    gl.traceDraw(GL_TRIANGLE_STRIP, static_cast<GLuint>(m_capacity * 4));
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(m_capacity));
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+// results of earlier frames, without waiting for the GPU
+void ParticleSystem::readQueries()
+{
+    for(int i = 0; i < NUM_QUERIES; i++)
+    {
+        GLuint available = GL_FALSE;
+        GLuint64 elapsed = 0;
+
+        if(!m_queryPending[i]) { continue; }
+        glGetQueryObjectuiv(m_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available) { continue; }
+
+        glGetQueryObjectui64v(m_queries[i], GL_QUERY_RESULT, &elapsed);
+        m_queryPending[i] = false;
+        m_stats.gpuMs = static_cast<double>(elapsed) * 1e-6;
+        m_stats.particlesPerMs = m_stats.gpuMs > 0.0 ? m_capacity / m_stats.gpuMs : 0.0;
+    }
+}
+
+// also empties the ring: the next update() starts from dead particles
+void ParticleSystem::releaseBuffers()
+{
+    GLState& gl = GLState::instance();
+
+    if(m_simVAOs[0] || m_simVAOs[1]) { gl.deleteVertexArrays(2, m_simVAOs); }
+    if(m_drawVAOs[0] || m_drawVAOs[1]) { gl.deleteVertexArrays(2, m_drawVAOs); }
+    if(m_buffers[0] || m_buffers[1]) { gl.deleteBuffers(2, m_buffers); }
+    if(m_emitBuffer) { gl.deleteBuffers(1, &m_emitBuffer); }
+    if(m_emitTexture) { gl.deleteTextures(1, &m_emitTexture); }
+    if(m_queries[0]) { glDeleteQueries(NUM_QUERIES, m_queries); }
+    m_buffers[0] = m_buffers[1] = 0;
+    m_simVAOs[0] = m_simVAOs[1] = 0;
+    m_drawVAOs[0] = m_drawVAOs[1] = 0;
+    m_emitBuffer = m_emitTexture = 0;
+    for(int i = 0; i < NUM_QUERIES; i++) { m_queries[i] = 0; m_queryPending[i] = false; }
+    m_current = 0;
+    m_capacity = m_head = m_numSpawns = 0;
+    m_initialized = false;
+    m_emits.clear();
+    m_stats = Stats();
+}
+
+void ParticleSystem::release()
+{
+    releaseBuffers();
+    nullify();
+}
@@ -0,0 +1,189 @@
+// include
+#include <Residency.hpp>
+
+ResidencyManager::ResidencyManager() { nullify(); }
+
+ResidencyManager::~ResidencyManager()
+{
+    for(size_t i = 0; i < m_entries.size(); i++) { delete m_entries[i]; }
+    nullify();
+}
+
+ResidencyManager& ResidencyManager::instance()
+{
+    static ResidencyManager s_residencyManager;
+    return s_residencyManager;
+}
+
+ResidencyManager::Stats ResidencyManager::getStats()
+{
+    m_stats.budgetBytes = m_budgetBytes;
+    m_stats.numResources = m_entries.size();
+    return m_stats;
+}
+
+// bytes: SIZE_MAX (default) = unlimited
+void ResidencyManager::setBudget(size_t bytes)
+{
+    m_budgetBytes = bytes;
+    if(bytes == SIZE_MAX) { LOG_INFO(ASSET, "ResidencyManager::setBudget(unlimited)"); }
+    else { LOG_INFO(ASSET, "ResidencyManager::setBudget({} MB)", bytes >> 20); }
+}
+
+// register a resource that has just been created (GL thread)
+// return: handle for touch()/makeResident()/remove()
+ResidencyEntry* ResidencyManager::add(int kind, size_t bytes, std::function<size_t()> evict, std::function<size_t()> demote, std::function<size_t()> restore)
+{
+    ResidencyEntry* entry = new ResidencyEntry();
+    entry->kind = kind;
+    entry->bytes = bytes;
+    entry->lastUsedFrame = m_frame.load();
+    entry->state = ResidencyEntry::RESIDENT;
+    entry->requested = false;
+    entry->evict = evict;
+    entry->demote = demote;
+    entry->restore = restore;
+
+    m_entries.push_back(entry);
+    m_stats.residentBytes += bytes;
+    enforceBudget();
+    return entry;
+}
+
+// call before the resource is deleted (GL thread)
+void ResidencyManager::remove(ResidencyEntry* entry)
+{
+    if(!entry) { return; }
+
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        m_requests.erase(std::remove(m_requests.begin(), m_requests.end(), entry), m_requests.end());
+    }
+    m_entries.erase(std::remove(m_entries.begin(), m_entries.end(), entry), m_entries.end());
+    m_stats.residentBytes -= entry->bytes;
+    delete entry;
+}
+
+// the owner changed the size of a resident resource (GL thread)
+void ResidencyManager::resize(ResidencyEntry* entry, size_t bytes)
+{
+    if(!entry) { return; }
+
+    m_stats.residentBytes = m_stats.residentBytes - entry->bytes + bytes;
+    entry->bytes = bytes;
+}
+
+// mark as used this frame; a non-resident resource is restored in the next beginFrame()
+// no GL call: safe to call from worker threads
+void ResidencyManager::touch(ResidencyEntry* entry)
+{
+    if(!entry) { return; }
+
+    entry->lastUsedFrame.store(m_frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    if(entry->state.load(std::memory_order_acquire) != ResidencyEntry::RESIDENT && !entry->requested.exchange(true))
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        m_requests.push_back(entry);
+    }
+}
+
+// mark as used this frame and restore it now if needed (GL thread)
+// return: true if the resource had to be reloaded
+bool ResidencyManager::makeResident(ResidencyEntry* entry)
+{
+    if(!entry) { return false; }
+
+    entry->lastUsedFrame.store(m_frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    if(entry->state.load(std::memory_order_acquire) == ResidencyEntry::RESIDENT) { return false; }
+
+    restore(entry);
+    m_stats.numReloadStalls++;
+    return true;
+}
+
+// GL thread, once per frame (before drawing)
+void ResidencyManager::beginFrame()
+{
+    std::vector<ResidencyEntry*> requests;
+
+    m_frame++;
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        requests.swap(m_requests);
+    }
+    for(size_t i = 0; i < requests.size(); i++)
+    {
+        if(requests[i]->state != ResidencyEntry::RESIDENT)
+        {
+            restore(requests[i]);
+            m_stats.numReloads++;
+        }
+        requests[i]->requested = false;
+    }
+
+    enforceBudget();
+}
+
+void ResidencyManager::restore(ResidencyEntry* entry)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    size_t bytes = entry->restore();
+    m_stats.residentBytes = m_stats.residentBytes - entry->bytes + bytes;
+    entry->bytes = bytes;
+    entry->state.store(ResidencyEntry::RESIDENT, std::memory_order_release);
+
+    m_stats.reloadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// LRU first; textures are demoted (lower mips) before they are evicted
+void ResidencyManager::enforceBudget()
+{
+    if(m_stats.residentBytes <= m_budgetBytes) { return; }
+
+    std::vector<std::pair<uint64_t, ResidencyEntry*>> candidates;
+    uint64_t frame = m_frame.load();
+    for(size_t i = 0; i < m_entries.size(); i++)
+    {
+        ResidencyEntry* entry = m_entries[i];
+        uint64_t lastUsed = entry->lastUsedFrame.load(std::memory_order_relaxed);
+        if(entry->state != ResidencyEntry::EVICTED && lastUsed + 1 < frame) { candidates.push_back(std::make_pair(lastUsed, entry)); }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+        [](const std::pair<uint64_t, ResidencyEntry*>& a, const std::pair<uint64_t, ResidencyEntry*>& b) { return a.first < b.first; });
+
+    // pass 0: demote, pass 1: evict
+    for(int pass = 0; pass < 2 && m_stats.residentBytes > m_budgetBytes; pass++)
+    {
+        for(size_t i = 0; i < candidates.size() && m_stats.residentBytes > m_budgetBytes; i++)
+        {
+            ResidencyEntry* entry = candidates[i].second;
+            size_t bytes;
+
+            if(pass == 0)
+            {
+                if(entry->state != ResidencyEntry::RESIDENT || !entry->demote) { continue; }
+                // nothing dropped (no mips to spare): left resident, evicted by pass 1 if still needed
+                bytes = entry->demote();
+                if(bytes >= entry->bytes) { continue; }
+                entry->state = ResidencyEntry::DEMOTED;
+                m_stats.numDemotions++;
+            }
+            else
+            {
+                if(entry->state == ResidencyEntry::EVICTED) { continue; }
+                bytes = entry->evict();
+                entry->state = ResidencyEntry::EVICTED;
+                m_stats.numEvictions++;
+            }
+
+            m_stats.residentBytes = m_stats.residentBytes - entry->bytes + bytes;
+            entry->bytes = bytes;
+        }
+    }
+
+    if(m_stats.residentBytes > m_budgetBytes)
+    {
+        LOG_WARN(ASSET, "over GPU memory budget: {} / {} MB (everything else is in use)", m_stats.residentBytes >> 20, m_budgetBytes >> 20);
+    }
+}
@@ -0,0 +1,253 @@
+// include
+#include <SceneGraph.hpp>
+
+// parent: handle, -1 for a root
+// return: handle of the new node
+int SceneGraph::createNode(int parent, const glm::mat4& local)
+{
+    int index = insertNodes(parent, 1);
+    m_local[index] = local;
+    return m_indexToHandle[index];
+}
+
+// instantiate the node hierarchy of a model under parent, with its meshes as draw items
+// the model must outlive the graph (draw items point at its meshes)
+// return: handle of the instance root (its local matrix is transform)
+int SceneGraph::addModel(const Model& model, int parent, const glm::mat4& transform)
+{
+    const std::vector<Model::Node>& nodes = model.getNodes();
+    const std::vector<Mesh*>& meshes = model.getMeshes();
+
+    int root = createNode(parent, transform);
+    if(nodes.empty()) { return root; }
+
+    // model nodes are already in preorder, so they go in as one contiguous block
+    int first = insertNodes(root, nodes.size());
+    for(size_t i = 0; i < nodes.size(); i++)
+    {
+        int index = first + static_cast<int>(i);
+        m_local[index] = nodes[i].transformation;
+        if(nodes[i].parent >= 0)
+        {
+            m_parent[index] = first + nodes[i].parent;
+            m_subtreeEnd[index] = index + 1;
+            for(int p = m_parent[index]; p >= first; p = m_parent[p]) { m_subtreeEnd[p] = index + 1; } // block-local ancestors
+        }
+        for(size_t j = 0; j < nodes[i].meshes.size(); j++)
+        {
+            if(nodes[i].meshes[j] < meshes.size()) { addDrawItem(meshes[nodes[i].meshes[j]], m_indexToHandle[index]); }
+        }
+    }
+    return root;
+}
+
+// remove a node with its whole subtree and their draw items
+void SceneGraph::removeNode(int handle)
+{
+    int index = m_handleToIndex[handle];
+    if(index < 0) { return; }
+    int end = m_subtreeEnd[index];
+    int count = end - index;
+
+    // draw items and handles of the removed range
+    for(size_t i = 0; i < m_drawItems.size(); )
+    {
+        int node = m_handleToIndex[m_drawItems[i].node];
+        if(node >= index && node < end) { m_drawItems[i] = m_drawItems.back(); m_drawItems.pop_back(); }
+        else { i++; }
+    }
+    for(int i = index; i < end; i++) { m_handleToIndex[m_indexToHandle[i]] = -1; }
+
+    // ancestors shrink
+    for(int p = m_parent[index]; p >= 0; p = m_parent[p]) { m_subtreeEnd[p] -= count; }
+
+    m_local.erase(m_local.begin() + index, m_local.begin() + end);
+    m_world.erase(m_world.begin() + index, m_world.begin() + end);
+    m_parent.erase(m_parent.begin() + index, m_parent.begin() + end);
+    m_subtreeEnd.erase(m_subtreeEnd.begin() + index, m_subtreeEnd.begin() + end);
+    m_dirty.erase(m_dirty.begin() + index, m_dirty.begin() + end);
+    m_indexToHandle.erase(m_indexToHandle.begin() + index, m_indexToHandle.begin() + end);
+
+    // everything after the range moves down
+    for(size_t i = index; i < m_parent.size(); i++)
+    {
+        if(m_parent[i] >= end) { m_parent[i] -= count; }
+        m_subtreeEnd[i] -= count;
+        m_handleToIndex[m_indexToHandle[i]] = static_cast<int>(i);
+    }
+}
+
+// marks the subtree for the next update()
+void SceneGraph::setLocal(int handle, const glm::mat4& local)
+{
+    int index = m_handleToIndex[handle];
+    m_local[index] = local;
+    m_dirty[index] = 1;
+}
+
+void SceneGraph::addDrawItem(const Mesh* mesh, int handle)
+{
+    DrawItem item;
+    item.mesh = mesh;
+    item.node = handle;
+    m_drawItems.push_back(item);
+}
+
+void SceneGraph::update()
+{
+    // local vars
+    std::vector<int> roots;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int numNodes = static_cast<int>(m_parent.size());
+    size_t minTasks = 4 * (JobSystem::instance().getNumWorkers() + 1);
+    const int splitSize = 1024;
+
+    // 1. dirty roots: the topmost dirty node of every dirty subtree
+    for(int i = 0; i < numNodes; )
+    {
+        if(m_dirty[i]) { roots.push_back(i); i = m_subtreeEnd[i]; }
+        else { i++; }
+    }
+    m_stats.numNodes = m_parent.size();
+    m_stats.numDirtyRoots = roots.size();
+    m_stats.numUpdated = 0;
+    for(size_t i = 0; i < roots.size(); i++) { m_stats.numUpdated += m_subtreeEnd[roots[i]] - roots[i]; }
+
+    // 2. split big subtrees: update the node itself here, its children become independent tasks
+    for(size_t pass = 0; pass < 8 && roots.size() < minTasks; pass++)
+    {
+        std::vector<int> split;
+        bool changed = false;
+        for(size_t i = 0; i < roots.size(); i++)
+        {
+            int node = roots[i];
+            if(m_subtreeEnd[node] - node <= splitSize) { split.push_back(node); continue; }
+
+            updateRange(node, node + 1);
+            for(int child = node + 1; child < m_subtreeEnd[node]; child = m_subtreeEnd[child]) { split.push_back(child); }
+            changed = true;
+        }
+        roots.swap(split);
+        if(!changed) { break; }
+    }
+
+    // 3. independent subtrees in parallel
+    JobSystem::instance().parallelFor(roots.size(), 1, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++) { updateRange(roots[i], m_subtreeEnd[roots[i]]); }
+    });
+
+    m_stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// record the draw items [begin, end) whose bounds pass the culler, each with its world matrix as "model"
+// the variant of each item is its mesh's feature mask plus the scene-wide features (setFeatures())
+// the variants must be compiled beforehand; the program is rebound only when the variant changes
+// no GL call: safe to call from worker threads for disjoint ranges (after update())
+void SceneGraph::record(CommandBuffer& commandBuffer, const ShaderVariants& shaderVariants, const OcclusionCuller& culler, size_t begin, size_t end) const
+{
+    const ShaderProgram* bound = nullptr;
+
+    for(size_t i = begin; i < end && i < m_drawItems.size(); i++)
+    {
+        const DrawItem& item = m_drawItems[i];
+        const glm::mat4& world = m_world[m_handleToIndex[item.node]];
+        if(!culler.isVisible(item.mesh->getBoundsMin(), item.mesh->getBoundsMax(), world)) { continue; }
+
+        const ShaderProgram* shaderProgram = shaderVariants.find(item.mesh->getFeatures() | m_features);
+        if(!shaderProgram) { continue; }
+        if(shaderProgram != bound)
+        {
+            commandBuffer.bindProgram(shaderProgram->getShaderProgramID());
+            bound = shaderProgram;
+        }
+        commandBuffer.setMat4(shaderProgram->getUniformLocation("model"), world);
+        item.mesh->record(commandBuffer, *shaderProgram);
+    }
+}
+
+// incremental vs full update of numNodes random nodes with dirtyFraction of them moving every frame
+void SceneGraph::benchmark(size_t numNodes, float dirtyFraction)
+{
+    // local vars
+    SceneGraph graph;
+    std::mt19937 rng(1234);
+    std::vector<int> handles;
+    double fullMs = 0.0, incrementalMs = 0.0;
+    const int numFrames = 20;
+
+    // random scene built in preorder (so every insert appends): depth at most 8, new root every ~1000 nodes
+    std::vector<int> path; // handles from the current root down to the last node
+    glm::mat4 local(1.0f);
+    local[3][0] = 0.1f;
+    for(size_t i = 0; i < numNodes; i++)
+    {
+        if(rng() % 1000 == 0) { path.clear(); }
+        while(path.size() >= 8 || (path.size() > 1 && rng() % 2 == 0)) { path.pop_back(); }
+        handles.push_back(graph.createNode(path.empty() ? -1 : path.back(), local));
+        path.push_back(handles.back());
+    }
+
+    for(int f = 0; f < numFrames; f++)
+    {
+        // full: every node dirty
+        for(size_t i = 0; i < numNodes; i++) { graph.setLocal(handles[i], local); }
+        graph.update();
+        fullMs += graph.getStats().ms;
+
+        // incremental: a few random nodes moved
+        size_t numDirty = static_cast<size_t>(numNodes * dirtyFraction);
+        for(size_t i = 0; i < numDirty; i++) { graph.setLocal(handles[rng() % numNodes], local); }
+        graph.update();
+        incrementalMs += graph.getStats().ms;
+    }
+
+    LOG_INFO(RENDER, "scene graph benchmark: {} nodes, {:.1f}% dirty: full {:.3f} ms, incremental {:.3f} ms ({:.1f}% of full, {} world matrices)",
+        numNodes, dirtyFraction * 100.0f, fullMs / numFrames, incrementalMs / numFrames,
+        fullMs > 0.0 ? 100.0 * incrementalMs / fullMs : 0.0, graph.getStats().numUpdated);
+}
+
+// insert count nodes as the last children of parent (handle, -1: new roots)
+// the new nodes are roots of their own one-node subtrees under parent; callers may link them further
+// return: index of the first new node
+int SceneGraph::insertNodes(int parent, size_t count)
+{
+    int parentIndex = parent >= 0 ? m_handleToIndex[parent] : -1;
+    int pos = parentIndex >= 0 ? m_subtreeEnd[parentIndex] : static_cast<int>(m_parent.size());
+    int n = static_cast<int>(count);
+
+    m_local.insert(m_local.begin() + pos, count, glm::mat4(1.0f));
+    m_world.insert(m_world.begin() + pos, count, glm::mat4(1.0f));
+    m_parent.insert(m_parent.begin() + pos, count, parentIndex);
+    m_subtreeEnd.insert(m_subtreeEnd.begin() + pos, count, 0);
+    m_dirty.insert(m_dirty.begin() + pos, count, 1);
+    m_indexToHandle.insert(m_indexToHandle.begin() + pos, count, -1);
+
+    // nodes after the block move up, ancestors grow
+    for(size_t i = pos + count; i < m_parent.size(); i++)
+    {
+        if(m_parent[i] >= pos) { m_parent[i] += n; }
+        m_subtreeEnd[i] += n;
+        m_handleToIndex[m_indexToHandle[i]] = static_cast<int>(i);
+    }
+    for(int p = parentIndex; p >= 0; p = m_parent[p]) { m_subtreeEnd[p] += n; }
+
+    for(int i = pos; i < pos + n; i++)
+    {
+        m_subtreeEnd[i] = i + 1;
+        m_indexToHandle[i] = static_cast<int>(m_handleToIndex.size());
+        m_handleToIndex.push_back(i);
+    }
+    return pos;
+}
+
+// world matrices of [begin, end) in order; parents outside the range must be up to date
+void SceneGraph::updateRange(int begin, int end)
+{
+    for(int i = begin; i < end; i++)
+    {
+        if(m_parent[i] >= 0) { simdMulMat4(&m_world[m_parent[i]][0][0], &m_local[i][0][0], &m_world[i][0][0]); }
+        else { m_world[i] = m_local[i]; }
+        m_dirty[i] = 0;
+    }
+}
@@ -0,0 +1,426 @@
+// include
+#include <Shader.hpp>
+
+Shader::Shader() { nullify(); }
+
+// e.g.) Shader myShader("vertshader.vs", GL_VERTEX_SHADER);
+Shader::Shader(const char* shaderPath, GLenum type)
+{
+    nullify();
+    loadFromFile(shaderPath, type);
+}
+
+Shader::~Shader()
+{
+    if(m_shaderID)
+    {
+        glDeleteShader(m_shaderID);
+        nullify();
+    }
+}
+
+// e.g.) Shader myShader.loadFromFile("vertshader.vs", GL_VERTEX_SHADER);
+void Shader::loadFromFile(const char* shaderPath, GLenum type) { loadFromFile(shaderPath, type, ""); }
+
+// defines: inserted right after the #version line (see injectDefines())
+// e.g.) myShader.loadFromFile("mesh.fs", GL_FRAGMENT_SHADER, "#define DIFFUSE_MAP\n");
+void Shader::loadFromFile(const char* shaderPath, GLenum type, const std::string& defines)
+{
+    // local vars
+    std::string shaderCode;
+
+    // check filepath
+    if(!shaderPath) { LOG_ERROR(GL, "Shader::loadFromFile(nullptr, type={}): null filepath", type); return; }
+    LOG_DEBUG(GL, "Shader::loadFromFile(\"{}\", type={})", shaderPath, type);
+
+    // open shader source file
+    if(!readFile(shaderPath, shaderCode)) { LOG_ERROR(GL, "no such shader source file"); return; }
+
+    loadFromSource(defines.empty() ? shaderCode : injectDefines(shaderCode, defines), type);
+}
+
+// checkNow: false leaves the compile status to be checked later (e.g. by ShaderProgram::finishLink()),
+// so the driver can compile several shaders in parallel (KHR_parallel_shader_compile)
+void Shader::loadFromSource(const std::string& shaderCode, GLenum type, bool checkNow)
+{
+    // local vars
+    const GLchar* pShaderCode = shaderCode.c_str();
+
+    // delete existing shader
+    if(m_shaderID)
+    {
+        LOG_WARN(GL, "delete existing shader (ShaderID={})", m_shaderID);
+        glDeleteShader(m_shaderID);
+        nullify();
+    }
+
+    // create and compile shader
+    switch (type)
+    {
+    case GL_COMPUTE_SHADER:
+        if(!GLAD_GL_VERSION_4_3) { LOG_ERROR(GL, "compute shaders need OpenGL 4.3"); return; }
+        // fall through
+    case GL_VERTEX_SHADER:
+    case GL_FRAGMENT_SHADER:
+    case GL_GEOMETRY_SHADER:
+        m_shaderID = glCreateShader(type);
+        if(!m_shaderID) { LOG_ERROR(GL, "failed to create shader"); return; }
+        break;
+
+    default:
+        LOG_ERROR(GL, "wrong or unimplemented type");
+        return;
+    }
+
+    glShaderSource(m_shaderID, 1, &pShaderCode, nullptr);
+    glCompileShader(m_shaderID);
+    if(checkNow && checkCompileError())
+    {
+        glDeleteShader(m_shaderID);
+        nullify();
+        return;
+    }
+
+    LOG_DEBUG(GL, "ShaderID = {}", m_shaderID);
+}
+
+// FileSystem (asset pack or loose file) -> string
+bool Shader::readFile(const char* shaderPath, std::string& shaderCode)
+{
+    VirtualFile shaderFile;
+
+    if(!shaderFile.open(shaderPath)) { return false; }
+    shaderCode.assign(shaderFile.getData(), shaderFile.getSize());
+    return true;
+}
+
+// GLSL requires #version to come first, so defines go right after it
+// a #line directive keeps compile errors pointing at the lines of the original file
+std::string Shader::injectDefines(const std::string& shaderCode, const std::string& defines)
+{
+    size_t version = shaderCode.find("#version");
+    if(version == std::string::npos) { return defines + "#line 1\n" + shaderCode; }
+
+    size_t lineEnd = shaderCode.find('\n', version);
+    if(lineEnd == std::string::npos) { return shaderCode + '\n' + defines; }
+
+    size_t nextLine = 2 + std::count(shaderCode.begin(), shaderCode.begin() + lineEnd, '\n');
+    return shaderCode.substr(0, lineEnd + 1) + defines + "#line " + std::to_string(nextLine) + '\n' + shaderCode.substr(lineEnd + 1);
+}
+
+// check error from glCompileShader()
+// return: true (error occurred), false (no error)
+bool Shader::checkCompileError()
+{
+    GLint success;
+
+    glGetShaderiv(m_shaderID, GL_COMPILE_STATUS, &success);
+    if(success) { return false; }
+    else
+    {
+        GLchar infoLog[1024];
+        glGetShaderInfoLog(m_shaderID, 1024, nullptr, infoLog);
+        LOG_ERROR(GL, "compile error:\n{}", infoLog);
+        return true;
+    }
+}
+
+std::unordered_map<std::string, GLuint> ShaderProgram::s_uniformBlockBindings;
+
+ShaderProgram::ShaderProgram() { nullify(); }
+
+ShaderProgram::ShaderProgram(const char* vertShaderPath, const char* fragShaderPath, const char* geoShaderPath)
+{
+    nullify();
+    loadFromFile(vertShaderPath, fragShaderPath, geoShaderPath);
+}
+
+ShaderProgram::~ShaderProgram()
+{
+    if(m_shaderProgramID)
+    {
+        GLState::instance().deletePrograms(1, &m_shaderProgramID);
+        nullify();
+    }
+}
+
+void ShaderProgram::use() { GLState::instance().useProgram(m_shaderProgramID); }
+
+// no GL call: safe to use from threads recording command buffers
+// return: -1 if the uniform does not exist or is inactive (same as glGetUniformLocation())
+GLint ShaderProgram::getUniformLocation(const char* name) const
+{
+    std::unordered_map<std::string, GLint>::const_iterator it = m_uniformLocations.find(name);
+    return it == m_uniformLocations.end() ? -1 : it->second;
+}
+
+void ShaderProgram::setBool(const char* name, bool b) { glUniform1i(getUniformLocation(name), (int)b); };
+void ShaderProgram::setInt(const char* name, int i) { glUniform1i(getUniformLocation(name), i); };
+void ShaderProgram::setFloat(const char* name, float f) { glUniform1f(getUniformLocation(name), f); };
+
+void ShaderProgram::setVec2(const char* name, float x, float y) { glUniform2f(getUniformLocation(name), x, y); };
+void ShaderProgram::setVec2(const char* name, glm::vec2& v2) { glUniform2fv(getUniformLocation(name), 1, &v2[0]); };
+
+void ShaderProgram::setVec3(const char* name, float x, float y, float z) { glUniform3f(getUniformLocation(name), x, y, z); };
+void ShaderProgram::setVec3(const char* name, glm::vec3& v3) { glUniform3fv(getUniformLocation(name), 1, &v3[0]); };
+
+void ShaderProgram::setVec4(const char* name, float x, float y, float z, float w) { glUniform4f(getUniformLocation(name), x, y, z, w); };
+void ShaderProgram::setVec4(const char* name, glm::vec4& v4) { glUniform4fv(getUniformLocation(name), 1, &v4[0]); };
+
+void ShaderProgram::setMat2(const char* name, glm::mat2& m2) { glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &m2[0][0]); };
+void ShaderProgram::setMat3(const char* name, glm::mat3& m3) { glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &m3[0][0]); };
+void ShaderProgram::setMat4(const char* name, glm::mat4& m4) { glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &m4[0][0]); };
+
+void ShaderProgram::setSampler(const char* name, int i) { setInt(name, i); }
+
+// GLSL 3.30 has no layout(binding = n): uniform blocks named blockName are bound to binding point
+// in every program linked after this call
+// e.g.) ShaderProgram::setUniformBlockBinding("Bones", SkinningBuffer::BINDING);
+void ShaderProgram::setUniformBlockBinding(const char* blockName, GLuint binding) { s_uniformBlockBindings[blockName] = binding; }
+
+void ShaderProgram::loadFromFile(const char* vertShaderPath, const char* fragShaderPath, const char* geomShaderPath)
+{
+    LOG_DEBUG(GL, "ShaderProgram::loadFromFile(...)");
+
+    // local vars
+    Shader vertShader, fragShader, geomShader;
+
+    // delete existing shader
+    if(m_shaderProgramID)
+    {
+        LOG_WARN(GL, "delete existing shader program (ShaderProgramID={})", m_shaderProgramID);
+        GLState::instance().deletePrograms(1, &m_shaderProgramID);
+        nullify();
+    }
+
+    // prepare shaders
+    vertShader.loadFromFile(vertShaderPath, GL_VERTEX_SHADER);
+    fragShader.loadFromFile(fragShaderPath, GL_FRAGMENT_SHADER);
+    geomShader.loadFromFile(geomShaderPath, GL_GEOMETRY_SHADER);
+
+    Shader* shaders[] = { &vertShader, &fragShader, &geomShader };
+    link(shaders, 3, false);
+}
+
+// same as loadFromFile(), from source strings (geomShaderCode may be empty)
+// deferred: compile and link without waiting for the driver; call finishLink() before using the program
+void ShaderProgram::loadFromSource(const std::string& vertShaderCode, const std::string& fragShaderCode, const std::string& geomShaderCode, bool deferred)
+{
+    // local vars
+    Shader vertShader, fragShader, geomShader;
+
+    // delete existing shader
+    if(m_shaderProgramID)
+    {
+        LOG_WARN(GL, "delete existing shader program (ShaderProgramID={})", m_shaderProgramID);
+        GLState::instance().deletePrograms(1, &m_shaderProgramID);
+        nullify();
+    }
+
+    // prepare shaders
+    vertShader.loadFromSource(vertShaderCode, GL_VERTEX_SHADER, !deferred);
+    fragShader.loadFromSource(fragShaderCode, GL_FRAGMENT_SHADER, !deferred);
+    if(!geomShaderCode.empty()) { geomShader.loadFromSource(geomShaderCode, GL_GEOMETRY_SHADER, !deferred); }
+
+    Shader* shaders[] = { &vertShader, &fragShader, &geomShader };
+    link(shaders, 3, deferred);
+}
+
+// a program with a single compute stage (OpenGL 4.3)
+// defines: inserted right after the #version line (see Shader::injectDefines())
+// e.g.) cullProgram.loadComputeFromFile("cull.comp", "#define COMPACT\n");
+void ShaderProgram::loadComputeFromFile(const char* compShaderPath, const std::string& defines)
+{
+    LOG_DEBUG(GL, "ShaderProgram::loadComputeFromFile(...)");
+
+    // local vars
+    Shader compShader;
+
+    // delete existing shader
+    if(m_shaderProgramID)
+    {
+        LOG_WARN(GL, "delete existing shader program (ShaderProgramID={})", m_shaderProgramID);
+        GLState::instance().deletePrograms(1, &m_shaderProgramID);
+        nullify();
+    }
+
+    // prepare shader
+    compShader.loadFromFile(compShaderPath, GL_COMPUTE_SHADER, defines);
+    if(!compShader.getShaderID()) { return; }
+
+    Shader* shaders[] = { &compShader };
+    link(shaders, 1, false);
+}
+
+// a transform feedback program: vertex shader (and optional geometry shader), no fragment shader
+// varyings: outputs captured into the transform feedback buffers, in buffer order (set before linking)
+// bufferMode: GL_INTERLEAVED_ATTRIBS (one buffer) or GL_SEPARATE_ATTRIBS (one buffer per varying)
+// draw with GL_RASTERIZER_DISCARD enabled
+// e.g.) simProgram.loadFeedbackFromFile("particle_sim.vs", nullptr, { "outPositionAge", "outVelocityLife" });
+void ShaderProgram::loadFeedbackFromFile(const char* vertShaderPath, const char* geomShaderPath, const std::vector<std::string>& varyings, GLenum bufferMode)
+{
+    LOG_DEBUG(GL, "ShaderProgram::loadFeedbackFromFile(...)");
+
+    // local vars
+    Shader vertShader, geomShader;
+
+    // delete existing shader
+    if(m_shaderProgramID)
+    {
+        LOG_WARN(GL, "delete existing shader program (ShaderProgramID={})", m_shaderProgramID);
+        GLState::instance().deletePrograms(1, &m_shaderProgramID);
+        nullify();
+    }
+
+    // prepare shaders
+    vertShader.loadFromFile(vertShaderPath, GL_VERTEX_SHADER);
+    if(!vertShader.getShaderID()) { return; }
+    if(geomShaderPath) { geomShader.loadFromFile(geomShaderPath, GL_GEOMETRY_SHADER); }
+
+    Shader* shaders[] = { &vertShader, &geomShader };
+    link(shaders, 2, false, &varyings, bufferMode);
+}
+
+// use the program and launch numGroupsX * numGroupsY * numGroupsZ work groups
+// the caller places the glMemoryBarrier() its consumers need
+void ShaderProgram::dispatch(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ)
+{
+    use();
+    GLState::instance().traceDispatch(numGroupsX * numGroupsY * numGroupsZ);
+    glDispatchCompute(numGroupsX, numGroupsY, numGroupsZ);
+}
+
+// the shaders are flagged for deletion by their destructors, GL keeps them until the program is deleted
+// shaders without a shader object (e.g. no geometry shader) are skipped
+// varyings: transform feedback outputs, nullptr if the program has none
+void ShaderProgram::link(Shader** shaders, size_t numShaders, bool deferred, const std::vector<std::string>* varyings, GLenum bufferMode)
+{
+    // create shader program
+    m_shaderProgramID = glCreateProgram();
+    if(!m_shaderProgramID) { LOG_ERROR(GL, "failed to create shader program"); return; }
+
+    // attach shaders and link shader program
+    for(size_t i = 0; i < numShaders; i++)
+    {
+        if(shaders[i]->getShaderID()) { glAttachShader(m_shaderProgramID, shaders[i]->getShaderID()); }
+    }
+    if(varyings && varyings->size())
+    {
+        std::vector<const GLchar*> names(varyings->size());
+        for(size_t i = 0; i < names.size(); i++) { names[i] = (*varyings)[i].c_str(); }
+        glTransformFeedbackVaryings(m_shaderProgramID, static_cast<GLsizei>(names.size()), &names[0], bufferMode);
+    }
+    glLinkProgram(m_shaderProgramID);
+
+    m_linkPending = true;
+    if(!deferred) { finishLink(); }
+}
+
+// polls the driver without blocking if KHR/ARB_parallel_shader_compile is available
+// return: true if finishLink() will not stall
+bool ShaderProgram::isLinkComplete()
+{
+    GLint complete = GL_TRUE;
+
+    if(!m_linkPending) { return true; }
+    if(GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile)
+    {
+        glGetProgramiv(m_shaderProgramID, GL_COMPLETION_STATUS_KHR, &complete);
+    }
+    return complete == GL_TRUE;
+}
+
+// wait for the link, check errors, cache uniform locations
+// return: true (ready to use), false (error occurred)
+bool ShaderProgram::finishLink()
+{
+    if(!m_linkPending) { return m_shaderProgramID != 0; }
+    m_linkPending = false;
+
+    if(checkLinkError())
+    {
+        // deferred compile errors show up here
+        GLuint shaders[3];
+        GLsizei numShaders = 0;
+        glGetAttachedShaders(m_shaderProgramID, 3, &numShaders, shaders);
+        for(GLsizei i = 0; i < numShaders; i++)
+        {
+            GLint success;
+            glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &success);
+            if(!success)
+            {
+                GLchar infoLog[1024];
+                glGetShaderInfoLog(shaders[i], 1024, nullptr, infoLog);
+                LOG_ERROR(GL, "compile error:\n{}", infoLog);
+            }
+        }
+
+        LOG_ERROR(GL, "failed to link shader program");
+        GLState::instance().deletePrograms(1, &m_shaderProgramID);
+        nullify();
+        return false;
+    }
+    
+    cacheUniformLocations();
+    bindUniformBlocks();
+    LOG_DEBUG(GL, "ShaderProgramID = {}", m_shaderProgramID);
+    return true;
+}
+
+// check error from glLinkProgram()
+// return: true (error occurred), false (no error)
+bool ShaderProgram::checkLinkError()
+{
+    GLint success;
+
+    glGetProgramiv(m_shaderProgramID, GL_LINK_STATUS, &success);
+    if(success) { return false; }
+    else
+    {
+        GLchar infoLog[1024];
+        glGetProgramInfoLog(m_shaderProgramID, 1024, nullptr, infoLog);
+        LOG_ERROR(GL, "link error:\n{}", infoLog);
+        return true;
+    }
+}
+
+// query every active uniform once; array uniforms are stored as "name" and "name[i]"
+void ShaderProgram::cacheUniformLocations()
+{
+    GLint numUniforms = 0;
+
+    glGetProgramiv(m_shaderProgramID, GL_ACTIVE_UNIFORMS, &numUniforms);
+    for(GLint i = 0; i < numUniforms; i++)
+    {
+        GLchar name[256];
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(m_shaderProgramID, static_cast<GLuint>(i), sizeof(name), nullptr, &size, &type, name);
+
+        std::string uniformName = name;
+        GLint location = glGetUniformLocation(m_shaderProgramID, name);
+        if(location < 0) { continue; } // uniform block members
+        m_uniformLocations[uniformName] = location;
+
+        size_t bracket = uniformName.find('[');
+        if(bracket != std::string::npos)
+        {
+            std::string baseName = uniformName.substr(0, bracket);
+            m_uniformLocations[baseName] = location;
+            for(GLint j = 1; j < size; j++)
+            {
+                std::string elementName = baseName + '[' + std::to_string(j) + ']';
+                m_uniformLocations[elementName] = glGetUniformLocation(m_shaderProgramID, elementName.c_str());
+            }
+        }
+    }
+}
+
+void ShaderProgram::bindUniformBlocks()
+{
+    for(std::unordered_map<std::string, GLuint>::iterator it = s_uniformBlockBindings.begin(); it != s_uniformBlockBindings.end(); it++)
+    {
+        GLuint index = glGetUniformBlockIndex(m_shaderProgramID, it->first.c_str());
+        if(index != GL_INVALID_INDEX) { glUniformBlockBinding(m_shaderProgramID, index, it->second); }
+    }
+}
@@ -0,0 +1,204 @@
+// include
+#include <ShaderVariants.hpp>
+
+std::vector<std::string> ShaderVariants::s_featureNames = { "DIFFUSE_MAP", "SPECULAR_MAP", "NORMAL_MAP", "HEIGHT_MAP", "INSTANCED", "SKINNED", "CLUSTERED_LIGHTING" };
+
+ShaderVariants::ShaderVariants() { nullify(); }
+
+// e.g.) ShaderVariants myVariants("mesh.vs", "mesh.fs", nullptr);
+ShaderVariants::ShaderVariants(const char* vertShaderPath, const char* fragShaderPath, const char* geomShaderPath)
+{
+    nullify();
+    loadFromFile(vertShaderPath, fragShaderPath, geomShaderPath);
+}
+
+ShaderVariants::~ShaderVariants() { clear(); }
+
+// return: bit index of the keyword (registered on first use), -1 if all 32 bits are taken
+uint32_t ShaderVariants::getFeatureBit(const std::string& name)
+{
+    for(size_t i = 0; i < s_featureNames.size(); i++)
+    {
+        if(s_featureNames[i] == name) { return static_cast<uint32_t>(i); }
+    }
+    if(s_featureNames.size() >= 32) { LOG_ERROR(GL, "too many shader feature keywords, \"{}\" is ignored", name); return static_cast<uint32_t>(-1); }
+
+    s_featureNames.push_back(name);
+    return static_cast<uint32_t>(s_featureNames.size() - 1);
+}
+
+// keywords separated by spaces
+// e.g.) ShaderVariants::getFeatureMask("DIFFUSE_MAP NORMAL_MAP");
+uint32_t ShaderVariants::getFeatureMask(const std::string& names)
+{
+    std::istringstream namesSS(names);
+    std::string name;
+    uint32_t mask = 0;
+
+    while(namesSS >> name)
+    {
+        uint32_t bit = getFeatureBit(name);
+        if(bit < 32) { mask |= 1u << bit; }
+    }
+    return mask;
+}
+
+// read the sources and their keywords; variants are compiled later (get(), precompile())
+void ShaderVariants::loadFromFile(const char* vertShaderPath, const char* fragShaderPath, const char* geomShaderPath)
+{
+    LOG_INFO(GL, "ShaderVariants::loadFromFile(\"{}\", \"{}\", \"{}\")",
+        vertShaderPath ? vertShaderPath : "", fragShaderPath ? fragShaderPath : "", geomShaderPath ? geomShaderPath : "");
+
+    // delete existing variants
+    if(m_variants.size())
+    {
+        LOG_WARN(GL, "delete existing shader variants ({})", m_variants.size());
+        clear();
+    }
+
+    if(!vertShaderPath || !fragShaderPath) { LOG_ERROR(GL, "null filepath"); return; }
+    if(!Shader::readFile(vertShaderPath, m_vertShaderCode)) { LOG_ERROR(GL, "no such shader source file \"{}\"", vertShaderPath); return; }
+    if(!Shader::readFile(fragShaderPath, m_fragShaderCode)) { LOG_ERROR(GL, "no such shader source file \"{}\"", fragShaderPath); return; }
+    if(geomShaderPath && !Shader::readFile(geomShaderPath, m_geomShaderCode)) { LOG_ERROR(GL, "no such shader source file \"{}\"", geomShaderPath); return; }
+
+    parseFeatures(m_vertShaderCode);
+    parseFeatures(m_fragShaderCode);
+    parseFeatures(m_geomShaderCode);
+    LOG_INFO(GL, "feature keywords: {}", getDefines(m_declaredMask));
+}
+
+// the variant for a feature mask, compiled on first use (GL thread)
+// a variant that failed to compile is kept as an empty program, so it is not retried every frame
+ShaderProgram& ShaderVariants::get(uint32_t mask)
+{
+    uint32_t key = getVariantKey(mask);
+    std::unordered_map<uint32_t, ShaderProgram*>::iterator it = m_variants.find(key);
+    if(it != m_variants.end()) { return *it->second; }
+
+    LOG_WARN(GL, "shader variant {:#x} compiled on first use (add it to the manifest)", key);
+    return *compile(key, false);
+}
+
+// no GL call, no compilation: safe to use from threads recording command buffers
+// return: nullptr if the variant has not been compiled yet
+const ShaderProgram* ShaderVariants::find(uint32_t mask) const
+{
+    std::unordered_map<uint32_t, ShaderProgram*>::const_iterator it = m_variants.find(getVariantKey(mask));
+    return it == m_variants.end() ? nullptr : it->second;
+}
+
+// compile all variants at once (GL thread)
+// every compile and link is issued before any status is read, so drivers with
+// KHR_parallel_shader_compile (or ones that compile on their own threads) work on them concurrently
+void ShaderVariants::precompile(const std::vector<uint32_t>& masks)
+{
+    // local vars
+    std::vector<ShaderProgram*> pending;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    size_t numFailed = 0;
+
+    if(GLAD_GL_KHR_parallel_shader_compile) { glMaxShaderCompilerThreadsKHR(0xFFFFFFFF); }
+    else if(GLAD_GL_ARB_parallel_shader_compile) { glMaxShaderCompilerThreadsARB(0xFFFFFFFF); }
+
+    for(size_t i = 0; i < masks.size(); i++)
+    {
+        uint32_t key = getVariantKey(masks[i]);
+        if(m_variants.find(key) == m_variants.end()) { pending.push_back(compile(key, true)); }
+    }
+
+    // collect in completion order while the driver is still working on the rest
+    while(pending.size())
+    {
+        bool progress = false;
+        for(size_t i = 0; i < pending.size(); i++)
+        {
+            if(!pending[i]->isLinkComplete()) { continue; }
+            if(!pending[i]->finishLink()) { numFailed++; }
+            pending[i] = pending.back();
+            pending.pop_back();
+            progress = true;
+            i--;
+        }
+        if(!progress) { std::this_thread::yield(); }
+    }
+
+    LOG_INFO(GL, "precompiled {} shader variants in {:.3f} ms ({} failed)", m_variants.size(),
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), numFailed);
+}
+
+// one variant per line: feature keywords separated by spaces, empty line = no features, '#' starts a comment
+// e.g.)
+// # mesh.variants
+// DIFFUSE_MAP
+// DIFFUSE_MAP NORMAL_MAP
+void ShaderVariants::precompileFromManifest(const char* manifestPath)
+{
+    // local vars
+    std::string manifest, line;
+    std::vector<uint32_t> masks;
+
+    // check filepath
+    if(!manifestPath) { LOG_ERROR(GL, "ShaderVariants::precompileFromManifest(nullptr): null filepath"); return; }
+    LOG_INFO(GL, "ShaderVariants::precompileFromManifest(\"{}\")", manifestPath);
+
+    if(!Shader::readFile(manifestPath, manifest)) { LOG_ERROR(GL, "no such manifest file"); return; }
+
+    std::istringstream manifestSS(manifest);
+    masks.push_back(0);
+    while(std::getline(manifestSS, line))
+    {
+        size_t comment = line.find('#');
+        if(comment != std::string::npos) { line.erase(comment); }
+        masks.push_back(getFeatureMask(line));
+    }
+
+    precompile(masks);
+}
+
+// collect "#pragma feature <keyword>" lines
+void ShaderVariants::parseFeatures(const std::string& shaderCode)
+{
+    std::istringstream codeSS(shaderCode);
+    std::string line;
+
+    while(std::getline(codeSS, line))
+    {
+        std::istringstream lineSS(line);
+        std::string directive, pragma, name;
+
+        lineSS >> directive >> pragma >> name;
+        if(directive != "#pragma" || pragma != "feature" || name.empty()) { continue; }
+
+        uint32_t bit = getFeatureBit(name);
+        if(bit < 32) { m_declaredMask |= 1u << bit; }
+    }
+}
+
+std::string ShaderVariants::getDefines(uint32_t key) const
+{
+    std::string defines;
+    for(uint32_t bit = 0; bit < s_featureNames.size(); bit++)
+    {
+        if(key & (1u << bit)) { defines += "#define " + s_featureNames[bit] + '\n'; }
+    }
+    return defines;
+}
+
+ShaderProgram* ShaderVariants::compile(uint32_t key, bool deferred)
+{
+    std::string defines = getDefines(key);
+    ShaderProgram* shaderProgram = new ShaderProgram();
+
+    LOG_DEBUG(GL, "shader variant {:#x}:\n{}", key, defines);
+    shaderProgram->loadFromSource(Shader::injectDefines(m_vertShaderCode, defines), Shader::injectDefines(m_fragShaderCode, defines),
+        m_geomShaderCode.empty() ? m_geomShaderCode : Shader::injectDefines(m_geomShaderCode, defines), deferred);
+
+    m_variants[key] = shaderProgram;
+    return shaderProgram;
+}
+
+void ShaderVariants::clear()
+{
+    for(std::unordered_map<uint32_t, ShaderProgram*>::iterator it = m_variants.begin(); it != m_variants.end(); it++) { delete it->second; }
+    nullify();
+}
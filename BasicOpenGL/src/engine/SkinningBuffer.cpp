@@ -0,0 +1,47 @@
+// include
+#include <SkinningBuffer.hpp>
+
+SkinningBuffer::~SkinningBuffer()
+{
+    if(m_UBO)
+    {
+        GLState::instance().deleteBuffers(1, &m_UBO);
+        nullify();
+    }
+}
+
+// slot i = animators[i]; palettes longer than MAX_BONES are truncated
+// the buffer is orphaned every frame, so the driver does not wait for draws still reading the previous palettes
+void SkinningBuffer::upload(const std::vector<Animator*>& animators)
+{
+    if(!m_UBO)
+    {
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        m_slotSize = (static_cast<GLsizeiptr>(MAX_BONES * sizeof(glm::mat4)) + alignment - 1) / alignment * alignment;
+
+        glGenBuffers(1, &m_UBO);
+        if(!m_UBO) { LOG_ERROR(RENDER, "failed to generate skinning buffer"); return; }
+    }
+
+    m_numSlots = animators.size();
+    m_staging.resize(m_numSlots * m_slotSize);
+    for(size_t i = 0; i < m_numSlots; i++)
+    {
+        const std::vector<glm::mat4>& palette = animators[i]->getPalette();
+        size_t numBones = palette.size() < static_cast<size_t>(MAX_BONES) ? palette.size() : MAX_BONES;
+        if(numBones) { memcpy(&m_staging[i * m_slotSize], &palette[0], numBones * sizeof(glm::mat4)); }
+    }
+
+    GLsizeiptr size = static_cast<GLsizeiptr>(m_staging.size());
+    GLState::instance().bindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+    if(size > m_capacity) { m_capacity = size; }
+    glBufferData(GL_UNIFORM_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW); // orphan
+    if(size) { glBufferSubData(GL_UNIFORM_BUFFER, 0, size, &m_staging[0]); }
+}
+
+void SkinningBuffer::bind(size_t slot)
+{
+    if(slot >= m_numSlots) { LOG_ERROR(RENDER, "SkinningBuffer::bind({}): only {} slots", slot, m_numSlots); return; }
+    GLState::instance().bindBufferRange(GL_UNIFORM_BUFFER, BINDING, m_UBO, slot * m_slotSize, MAX_BONES * sizeof(glm::mat4));
+}
@@ -0,0 +1,347 @@
+// include
+#include <TangentSpace.hpp>
+
+// std
+#include <algorithm>
+#include <unordered_map>
+
+TangentSpace::TangentSpace() { nullify(); }
+
+TangentSpace::TangentSpace(float creaseAngle)
+{
+    nullify();
+    setCreaseAngle(creaseAngle);
+}
+
+// creaseAngle: degrees, triangles around a position whose normals differ by more are not smoothed together
+// 180 (default): smooth everything, 0: flat shading
+void TangentSpace::setCreaseAngle(float creaseAngle)
+{
+    creaseAngle = std::min(std::max(creaseAngle, 0.0f), 180.0f);
+    m_cosCrease = creaseAngle >= 180.0f ? -1.0f : std::cos(creaseAngle * 0.0174532925f);
+}
+
+// e.g.) TangentSpace::Stats stats = tangentSpace.generateNormals(vertices, indices);
+//
+// vertices: normal of every vertex used by a triangle is overwritten
+// generate: optional, per vertex; only the flagged vertices are written (e.g. ObjLoader::MeshData::missingNormals),
+// the others still contribute their triangles
+// a vertex shared by several triangles is smoothed around the first one (meshes with one vertex per corner,
+// as assimp delivers them without aiProcess_JoinIdenticalVertices, get exact crease edges)
+//
+// 1. face normals, length = 2 * area (parallel)
+// 2. group the vertices by position, list the corners of every position (serial, O(n))
+// 3. sum the face normals within the crease angle of the vertex's own triangle (parallel)
+TangentSpace::Stats TangentSpace::generateNormals(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<uint8_t>* generate)
+{
+    // local vars
+    Stats stats;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    JobSystem& jobs = JobSystem::instance();
+    size_t numVertices = vertices.size();
+    size_t numTriangles = indices.size() / 3;
+
+    memset(&stats, 0, sizeof(Stats)); // nullify
+    stats.numVertices = numVertices;
+    stats.numTriangles = numTriangles;
+    if(!numVertices || !numTriangles) { return stats; }
+    if(numVertices >= EMPTY || indices.size() >= EMPTY) { LOG_ERROR(ASSET, "TangentSpace::generateNormals(): too many vertices ({})", numVertices); return stats; }
+
+    // 1.
+    computeFaceNormals(vertices, indices);
+
+    // 2.
+    std::vector<uint32_t> ownFace(numVertices, EMPTY);
+    for(size_t c = 0; c < numTriangles * 3; c++)
+    {
+        if(ownFace[indices[c]] == EMPTY) { ownFace[indices[c]] = static_cast<uint32_t>(c / 3); }
+    }
+    size_t numPositions = groupBy(numVertices, 3, [&](size_t i, uint32_t* key)
+    {
+        glm::vec3 p = vertices[i].position + glm::vec3(0.0f); // -0.0f == 0.0f
+        memcpy(key, &p, sizeof(glm::vec3));
+    });
+    std::vector<uint32_t> positionOf;
+    positionOf.swap(m_groups);
+
+    std::vector<uint32_t> cornerPosition(numTriangles * 3);
+    for(size_t c = 0; c < cornerPosition.size(); c++) { cornerPosition[c] = positionOf[indices[c]]; }
+    buildMembers(numPositions, cornerPosition);
+
+    // 3.
+    jobs.parallelFor(numVertices, GRAIN, [&](size_t begin, size_t end)
+    {
+        for(size_t v = begin; v < end; v++)
+        {
+            if(ownFace[v] == EMPTY || (generate && !(*generate)[v])) { continue; }
+
+            const glm::vec3& own = m_faceNormals[ownFace[v]];
+            float ownLength = glm::length(own);
+            glm::vec3 sum(0.0f);
+            for(uint32_t m = m_offsets[positionOf[v]]; m < m_offsets[positionOf[v] + 1]; m++)
+            {
+                const glm::vec3& face = m_faceNormals[m_members[m] / 3];
+                if(glm::dot(face, own) >= m_cosCrease * glm::length(face) * ownLength) { sum += face; }
+            }
+
+            float length = glm::length(sum);
+            if(length > 0.0f) { vertices[v].normal = sum / length; }
+            else if(ownLength > 0.0f) { vertices[v].normal = own / ownLength; }
+        }
+    });
+
+    stats.normalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+// e.g.) TangentSpace::Stats stats = tangentSpace.generateTangents(vertices, indices);
+//
+// vertices: tangent and bitangent overwritten, split vertices appended (normals and texCoords must be final)
+// indices: corners of split vertices remapped
+// sources: optional, the original index of every appended vertex (e.g. to copy VertexBoneData)
+//
+// 1. face tangents and texCoord handedness (parallel)
+// 2. group the vertices by position, normal and texCoord; corner group = (vertex group, handedness) (serial, O(n))
+// 3. per corner group: sum of the face tangents projected onto the normal plane, weighted by the corner angle (parallel)
+// 4. write the tangent frames, splitting vertices used by more than one corner group (serial, O(n))
+TangentSpace::Stats TangentSpace::generateTangents(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<unsigned int>* sources)
+{
+    // local vars
+    Stats stats;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    JobSystem& jobs = JobSystem::instance();
+    size_t numVertices = vertices.size();
+    size_t numTriangles = indices.size() / 3;
+    size_t numCorners = numTriangles * 3;
+
+    memset(&stats, 0, sizeof(Stats)); // nullify
+    stats.numVertices = numVertices;
+    stats.numTriangles = numTriangles;
+    if(!numVertices || !numTriangles) { return stats; }
+    if(numVertices >= EMPTY / 2 || indices.size() >= EMPTY) { LOG_ERROR(ASSET, "TangentSpace::generateTangents(): too many vertices ({})", numVertices); return stats; }
+
+    // 1.
+    computeFaceTangents(vertices, indices);
+
+    // 2. corners of triangles with degenerate texCoords take the handedness the vertex has elsewhere
+    std::vector<int8_t> vertexSign(numVertices, 0);
+    for(size_t c = 0; c < numCorners; c++)
+    {
+        float w = m_faceTangents[c / 3].w;
+        if(w != 0.0f && !vertexSign[indices[c]]) { vertexSign[indices[c]] = w > 0.0f ? 1 : -1; }
+    }
+    size_t numVertexGroups = groupBy(numVertices, 8, [&](size_t i, uint32_t* key)
+    {
+        const Vertex& vert = vertices[i];
+        float words[8] = { vert.position.x, vert.position.y, vert.position.z, vert.normal.x, vert.normal.y, vert.normal.z, vert.texCoord.x, vert.texCoord.y };
+        for(int w = 0; w < 8; w++) { words[w] += 0.0f; } // -0.0f == 0.0f
+        memcpy(key, words, sizeof(words));
+    });
+    std::vector<uint32_t> vertexGroup;
+    vertexGroup.swap(m_groups);
+
+    std::vector<int8_t> cornerSign(numCorners);
+    for(size_t c = 0; c < numCorners; c++)
+    {
+        float w = m_faceTangents[c / 3].w;
+        cornerSign[c] = w != 0.0f ? (w > 0.0f ? 1 : -1) : (vertexSign[indices[c]] ? vertexSign[indices[c]] : 1);
+    }
+    size_t numGroups = numVertexGroups * 2; // (vertex group, handedness), some empty
+    std::vector<uint32_t> cornerGroup(numCorners);
+    for(size_t c = 0; c < numCorners; c++) { cornerGroup[c] = vertexGroup[indices[c]] * 2 + (cornerSign[c] > 0 ? 1 : 0); }
+    buildMembers(numGroups, cornerGroup);
+
+    // 3.
+    std::vector<glm::vec3> groupTangents(numGroups);
+    jobs.parallelFor(numGroups, GRAIN, [&](size_t begin, size_t end)
+    {
+        for(size_t g = begin; g < end; g++)
+        {
+            if(m_offsets[g] == m_offsets[g + 1]) { continue; }
+
+            glm::vec3 n = vertices[indices[m_members[m_offsets[g]]]].normal;
+            glm::vec3 sum(0.0f);
+            float length = glm::length(n);
+            n = length > 0.0f ? n / length : glm::vec3(0.0f, 0.0f, 1.0f);
+
+            for(uint32_t m = m_offsets[g]; m < m_offsets[g + 1]; m++)
+            {
+                uint32_t c = m_members[m];
+                const glm::vec4& face = m_faceTangents[c / 3];
+                if(face.w == 0.0f) { continue; }
+
+                glm::vec3 t = glm::vec3(face) - n * glm::dot(n, glm::vec3(face));
+                float tLength = glm::length(t);
+                if(tLength <= 0.0f) { continue; }
+
+                // angle at the corner, edges projected onto the normal plane
+                uint32_t first = c - c % 3;
+                const glm::vec3& p0 = vertices[indices[c]].position;
+                glm::vec3 e1 = vertices[indices[first + (c + 1) % 3]].position - p0;
+                glm::vec3 e2 = vertices[indices[first + (c + 2) % 3]].position - p0;
+                e1 -= n * glm::dot(n, e1);
+                e2 -= n * glm::dot(n, e2);
+                float l1 = glm::length(e1), l2 = glm::length(e2);
+                float angle = l1 > 0.0f && l2 > 0.0f ? std::acos(std::min(std::max(glm::dot(e1, e2) / (l1 * l2), -1.0f), 1.0f)) : 0.0f;
+
+                sum += t * (angle / tLength);
+            }
+
+            length = glm::length(sum);
+            if(length > 0.0f) { groupTangents[g] = sum / length; }
+            else
+            {
+                // no usable texCoords: any unit vector in the normal plane
+                glm::vec3 axis = std::fabs(n.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+                groupTangents[g] = glm::normalize(axis - n * glm::dot(n, axis));
+            }
+        }
+    });
+
+    // 4.
+    std::vector<uint32_t> owner(numVertices, EMPTY);
+    std::unordered_map<uint64_t, uint32_t> splits; // (vertex, corner group) -> appended vertex
+    auto setFrame = [&](Vertex& vert, uint32_t g, int8_t sign)
+    {
+        float length = glm::length(vert.normal);
+        glm::vec3 n = length > 0.0f ? vert.normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+        vert.tangent = groupTangents[g];
+        vert.bitangent = static_cast<float>(sign) * glm::cross(n, vert.tangent);
+    };
+    for(size_t c = 0; c < numCorners; c++)
+    {
+        uint32_t v = indices[c];
+        uint32_t g = cornerGroup[c];
+
+        if(owner[v] == EMPTY)
+        {
+            owner[v] = g;
+            setFrame(vertices[v], g, cornerSign[c]);
+        }
+        else if(owner[v] != g)
+        {
+            uint64_t key = (static_cast<uint64_t>(v) << 32) | g;
+            std::unordered_map<uint64_t, uint32_t>::iterator it = splits.find(key);
+            if(it == splits.end())
+            {
+                Vertex copy = vertices[v];
+                setFrame(copy, g, cornerSign[c]);
+                it = splits.insert(std::make_pair(key, static_cast<uint32_t>(vertices.size()))).first;
+                vertices.push_back(copy);
+                if(sources) { sources->push_back(v); }
+            }
+            indices[c] = it->second;
+        }
+    }
+
+    stats.numSplitVertices = splits.size();
+    stats.tangentSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+// normal and height maps are the only readers of aTangent and aBitangent
+bool TangentSpace::needsTangents(const std::vector<Texture>& textures)
+{
+    for(size_t i = 0; i < textures.size(); i++)
+    {
+        if(textures[i].type == Texture::TYPE::NORMAL || textures[i].type == Texture::TYPE::HEIGHT) { return true; }
+    }
+    return false;
+}
+
+void TangentSpace::computeFaceNormals(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    m_faceNormals.resize(indices.size() / 3);
+    JobSystem::instance().parallelFor(m_faceNormals.size(), GRAIN, [&](size_t begin, size_t end)
+    {
+        for(size_t t = begin; t < end; t++)
+        {
+            const glm::vec3& a = vertices[indices[t * 3]].position;
+            const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& c = vertices[indices[t * 3 + 2]].position;
+            m_faceNormals[t] = glm::cross(b - a, c - a);
+        }
+    });
+}
+
+// tangent = d(position)/du; w = sign of the texCoord area (MikkTSpace: orientation preserving or not)
+void TangentSpace::computeFaceTangents(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    m_faceTangents.resize(indices.size() / 3);
+    JobSystem::instance().parallelFor(m_faceTangents.size(), GRAIN, [&](size_t begin, size_t end)
+    {
+        for(size_t t = begin; t < end; t++)
+        {
+            const Vertex& a = vertices[indices[t * 3]];
+            const Vertex& b = vertices[indices[t * 3 + 1]];
+            const Vertex& c = vertices[indices[t * 3 + 2]];
+            glm::vec3 e1 = b.position - a.position, e2 = c.position - a.position;
+            glm::vec2 d1 = b.texCoord - a.texCoord, d2 = c.texCoord - a.texCoord;
+            float area = d1.x * d2.y - d2.x * d1.y;
+            glm::vec3 tangent = (e1 * d2.y - e2 * d1.y) * (area > 0.0f ? 1.0f : -1.0f);
+            float length = glm::length(tangent);
+
+            if(std::fabs(area) <= 1e-20f || length <= 0.0f) { m_faceTangents[t] = glm::vec4(0.0f); continue; }
+            m_faceTangents[t] = glm::vec4(tangent / length, area > 0.0f ? 1.0f : -1.0f);
+        }
+    });
+}
+
+// m_groups[i]: group of item i, numbered by first occurrence; items with bitwise equal keys of numWords words share a group
+// return: number of groups
+size_t TangentSpace::groupBy(size_t numItems, size_t numWords, const std::function<void(size_t, uint32_t*)>& makeKey)
+{
+    // local vars
+    std::vector<uint32_t> keys(numItems * numWords);
+    std::vector<uint32_t> hashes(numItems);
+    size_t capacity = 1;
+    uint32_t numGroups = 0;
+
+    // keys and FNV-1a hashes (parallel)
+    JobSystem::instance().parallelFor(numItems, GRAIN, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            uint32_t* key = &keys[i * numWords];
+            uint32_t hash = 2166136261u;
+            makeKey(i, key);
+            for(size_t w = 0; w < numWords; w++) { hash = (hash ^ key[w]) * 16777619u; }
+            hashes[i] = hash ^ (hash >> 15);
+        }
+    });
+
+    // open addressing: slot -> first item of the group
+    while(capacity < numItems * 2) { capacity <<= 1; }
+    std::vector<uint32_t> table(capacity, EMPTY);
+    m_groups.resize(numItems);
+    for(size_t i = 0; i < numItems; i++)
+    {
+        size_t slot = hashes[i] & (capacity - 1);
+        while(table[slot] != EMPTY)
+        {
+            uint32_t other = table[slot];
+            if(hashes[other] == hashes[i] && !memcmp(&keys[other * numWords], &keys[i * numWords], numWords * sizeof(uint32_t))) { break; }
+            slot = (slot + 1) & (capacity - 1);
+        }
+
+        if(table[slot] == EMPTY)
+        {
+            table[slot] = static_cast<uint32_t>(i);
+            m_groups[i] = numGroups++;
+        }
+        else { m_groups[i] = m_groups[table[slot]]; }
+    }
+    return numGroups;
+}
+
+// m_members[m_offsets[g] .. m_offsets[g + 1]): the items of group g in ascending order
+void TangentSpace::buildMembers(size_t numGroups, const std::vector<uint32_t>& groups)
+{
+    m_offsets.assign(numGroups + 1, 0);
+    for(size_t i = 0; i < groups.size(); i++) { m_offsets[groups[i] + 1]++; }
+    for(size_t g = 0; g < numGroups; g++) { m_offsets[g + 1] += m_offsets[g]; }
+
+    std::vector<uint32_t> cursor(m_offsets.begin(), m_offsets.end() - 1);
+    m_members.resize(groups.size());
+    for(size_t i = 0; i < groups.size(); i++) { m_members[cursor[groups[i]]++] = static_cast<uint32_t>(i); }
+}
@@ -0,0 +1,148 @@
+// include
+#include <VertexWelder.hpp>
+
+VertexWelder::VertexWelder() { nullify(); }
+
+VertexWelder::VertexWelder(float epsilon)
+{
+    nullify();
+    setEpsilon(epsilon);
+}
+
+// e.g.) VertexWelder::Stats stats = welder.weld(vertices, indices);
+//
+// vertices: replaced by the unique vertices (first occurrences, in their original order)
+// indices: remapped in place
+//
+// 1. build keys and hashes (parallel)
+// 2. insert every vertex into a lock-free open-addressing table; equal keys keep the smallest index (parallel)
+// 3. look up the representative of every vertex (parallel)
+// 4. compact the representatives (serial, O(n)) and remap the indices (parallel)
+VertexWelder::Stats VertexWelder::weld(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    // local vars
+    Stats stats;
+    size_t numVertices, capacity;
+    std::chrono::steady_clock::time_point start;
+    JobSystem& jobs = JobSystem::instance();
+
+    start = std::chrono::steady_clock::now();
+    numVertices = vertices.size();
+    stats.numVerticesIn = stats.numVerticesOut = numVertices;
+    stats.seconds = 0.0;
+    if(numVertices < 2) { return stats; }
+    if(numVertices >= EMPTY) { LOG_ERROR(ASSET, "VertexWelder::weld(): too many vertices ({})", numVertices); return stats; }
+
+    // 1. keys and hashes (FNV-1a over the key words)
+    m_keys.resize(numVertices * NUM_WORDS);
+    m_hashes.resize(numVertices);
+    m_rep.resize(numVertices);
+    jobs.parallelFor(numVertices, GRAIN, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            uint32_t* key = &m_keys[i * NUM_WORDS];
+            uint32_t hash = 2166136261u;
+            makeKey(vertices[i], key);
+            for(size_t w = 0; w < NUM_WORDS; w++) { hash = (hash ^ key[w]) * 16777619u; }
+            m_hashes[i] = hash ^ (hash >> 15);
+        }
+    });
+
+    // 2. concurrent insertion
+    capacity = 1;
+    while(capacity < numVertices * 2) { capacity <<= 1; }
+    std::unique_ptr<std::atomic<uint32_t>[]> table(new std::atomic<uint32_t>[capacity]);
+    jobs.parallelFor(capacity, GRAIN * 4, [&](size_t begin, size_t end)
+    {
+        for(size_t s = begin; s < end; s++) { table[s].store(EMPTY, std::memory_order_relaxed); }
+    });
+
+    jobs.parallelFor(numVertices, GRAIN, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            uint32_t self = static_cast<uint32_t>(i);
+            size_t slot = m_hashes[i] & (capacity - 1);
+            while(true)
+            {
+                uint32_t cur = table[slot].load(std::memory_order_acquire);
+                if(cur == EMPTY)
+                {
+                    if(table[slot].compare_exchange_strong(cur, self, std::memory_order_acq_rel)) { break; }
+                    // lost the race: cur now holds the winner, fall through and compare against it
+                }
+                if(m_hashes[cur] == m_hashes[i] && equalKeys(cur, self))
+                {
+                    // a slot only ever holds indices of one key, so keep the minimum
+                    while(self < cur && !table[slot].compare_exchange_weak(cur, self, std::memory_order_acq_rel)) {}
+                    break;
+                }
+                slot = (slot + 1) & (capacity - 1);
+            }
+        }
+    });
+
+    // 3. representatives
+    jobs.parallelFor(numVertices, GRAIN, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            size_t slot = m_hashes[i] & (capacity - 1);
+            while(true)
+            {
+                uint32_t cur = table[slot].load(std::memory_order_relaxed);
+                if(m_hashes[cur] == m_hashes[i] && equalKeys(cur, static_cast<uint32_t>(i))) { m_rep[i] = cur; break; }
+                slot = (slot + 1) & (capacity - 1);
+            }
+        }
+    });
+
+    // 4. compaction: rep[i] <= i, so remap[rep[i]] is already known when i is visited
+    std::vector<Vertex> welded;
+    std::vector<uint32_t>& remap = m_rep; // reused in place
+    welded.reserve(numVertices);
+    for(size_t i = 0; i < numVertices; i++)
+    {
+        if(m_rep[i] == i)
+        {
+            remap[i] = static_cast<uint32_t>(welded.size());
+            welded.push_back(vertices[i]);
+        }
+        else { remap[i] = remap[m_rep[i]]; }
+    }
+
+    jobs.parallelFor(indices.size(), GRAIN * 4, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++) { indices[i] = remap[indices[i]]; }
+    });
+
+    stats.numVerticesOut = welded.size();
+    vertices.swap(welded);
+
+    // release scratch memory
+    std::vector<uint32_t>().swap(m_keys);
+    std::vector<uint32_t>().swap(m_hashes);
+    std::vector<uint32_t>().swap(m_rep);
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+void VertexWelder::makeKey(const Vertex& vert, uint32_t* key)
+{
+    const float* src = reinterpret_cast<const float*>(&vert);
+
+    for(size_t w = 0; w < NUM_WORDS; w++)
+    {
+        float f = src[w];
+        if(m_epsilon > 0.0f) { f = std::floor(f / m_epsilon + 0.5f); }
+        if(f == 0.0f) { f = 0.0f; } // -0.0f == +0.0f
+        memcpy(&key[w], &f, sizeof(uint32_t));
+    }
+}
+
+bool VertexWelder::equalKeys(uint32_t a, uint32_t b)
+{
+    return !memcmp(&m_keys[a * NUM_WORDS], &m_keys[b * NUM_WORDS], NUM_WORDS * sizeof(uint32_t));
+}
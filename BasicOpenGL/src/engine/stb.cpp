@@ -0,0 +1,8 @@
+// the single translation unit with the stb implementations
+// (kept out of unity builds: stb defines static helpers that collide with other sources)
+
+// stb
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
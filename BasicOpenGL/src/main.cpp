@@ -2,6 +2,17 @@
 #include <Image.hpp>
 #include <Mesh.hpp>
 #include <Model.hpp>
+#include <FramePipeline.hpp>
+#include <SkinningBuffer.hpp>
+#include <SceneGraph.hpp>
+#include <GpuScene.hpp>
+#include <FrameGraph.hpp>
+#include <ParticleSystem.hpp>
+#include <ClusteredLighting.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <random>
 
 // #include <filesystem>
 
@@ -9,8 +20,15 @@ void framebuffersize_callback(GLFWwindow*, int, int);
 
 int main()
 {
+	//asynchronous logging, per subsystem levels, e.g.) LOG_LEVELS="asset=off,render=debug" ./basic_OpenGL
+	Log::setLevels(getenv("LOG_LEVELS"));
+	//GPU-driven path (OpenGL 4.3): culling and LOD in a compute shader, one multi-draw per batch, e.g.) GPU_DRIVEN=1 ./basic_OpenGL
+	const bool gpuDriven = getenv("GPU_DRIVEN") != nullptr;
+	//benchmarks before the first frame (assimp vs ObjLoader, scene graph, animation), e.g.) BENCHMARK=1 ./basic_OpenGL
+	const bool benchmark = getenv("BENCHMARK") != nullptr;
+
 	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, gpuDriven ? 4 : 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
@@ -34,29 +52,309 @@ int main()
     // current_path(): BasicOpenGL\\build\\Debug (or Release)
     // std::cout << std::filesystem::current_path() << std::endl;
 
-	ShaderProgram sp1("../../shader/mesh.vs", "../../shader/mesh.fs", nullptr);
+	//assets from one pack built by basic_OpenGL_pack (loose files for anything missing), e.g.) ASSET_PACK=assets.pak ./basic_OpenGL
+	if(getenv("ASSET_PACK")) { FileSystem::instance().mount(getenv("ASSET_PACK")); }
+
+	//skinned variants read their matrix palette from the Bones uniform block
+	ShaderProgram::setUniformBlockBinding("Bones", SkinningBuffer::BINDING);
+	//one program per feature combination (#pragma feature in mesh.fs), compiled up front in one batch
+	ShaderVariants meshShaders("../../shader/mesh.vs", "../../shader/mesh.fs", nullptr);
+	meshShaders.precompileFromManifest("../../shader/mesh.variants");
 	Image::setFlipVerticallyOnLoad(true);
+	//textures and buffers beyond the budget are demoted or evicted (least recently drawn first)
+	ResidencyManager::instance().setBudget(size_t(512) << 20);
+	if(benchmark) { Model::benchmarkObj("../../resource/model/model.obj", 10); }
+	std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
 	Model m1("../../resource/model/model.obj");
+	LOG_INFO(ASSET, "models loaded in {:.3f} ms (LOG_LEVELS=\"{}\")",
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count(), getenv("LOG_LEVELS") ? getenv("LOG_LEVELS") : "");
+	FileSystem::Stats fileStats = FileSystem::instance().getStats();
+	LOG_INFO(ASSET, "file system: {} packed reads ({:.2f} MB, {:.3f} ms LZ4), {} loose reads ({:.2f} MB)", fileStats.numPackedReads,
+		fileStats.packedBytes / 1048576.0, fileStats.decompressMs, fileStats.numLooseReads, fileStats.looseBytes / 1048576.0);
+	std::vector<Model*> models = { &m1 };
+	//variants the manifest missed; recording never compiles
+	for(size_t i = 0; i < models.size(); i++) { meshShaders.precompile(models[i]->getFeatureMasks()); }
+
+	//transform hierarchy: every model instance is a subtree, its meshes are the draw items
+	if(benchmark) { SceneGraph::benchmark(100000, 0.01f); }
+	SceneGraph graph;
+	for(size_t i = 0; i < models.size(); i++) { graph.addModel(*models[i], -1, glm::mat4(1.0f)); }
+
+	//skeletal animation: one animator per animated model, palettes uploaded once per frame
+	std::vector<Animator*> animators;
+	SkinningBuffer skinning;
+	Animator animator;
+	if(m1.getClips().size())
+	{
+		if(benchmark) { AnimationSystem::benchmark(m1.getSkeleton(), m1.getClips()[0], 1000, 60); }
+		animator.setSkeleton(m1.getSkeleton());
+		animator.play(0, &m1.getClips()[0]);
+		animators.push_back(&animator);
+	}
+
+	//occluders are rasterized on the CPU before recording
+	OcclusionCuller culler;
+	glm::mat4 identity(1.0f);
+
+	//GPU-driven path: every draw item of the scene graph becomes an instance
+	//skinned meshes are not supported by GpuScene: they are recorded on this thread and drawn after the multi-draws
+	GpuScene gpuScene;
+	ShaderVariants indirectShaders;
+	std::vector<size_t> skinnedItems;
+	CommandBuffer skinnedCommands;
+	if(gpuDriven && gpuScene.init("../../shader/cull.comp"))
+	{
+		std::unordered_map<const Mesh*, int> gpuMeshes;
+		graph.update();
+		for(size_t i = 0; i < graph.getNumDrawItems(); i++)
+		{
+			const SceneGraph::DrawItem& item = graph.getDrawItem(i);
+			if(item.mesh->isSkinned()) { skinnedItems.push_back(i); continue; }
+			if(!gpuMeshes.count(item.mesh)) { gpuMeshes[item.mesh] = gpuScene.addMesh(*item.mesh); }
+			if(gpuMeshes[item.mesh] >= 0) { gpuScene.addInstance(gpuMeshes[item.mesh], graph.getWorld(item.node)); }
+		}
+		gpuScene.build();
+		indirectShaders.loadFromFile("../../shader/indirect.vs", "../../shader/mesh.fs", nullptr);
+		for(size_t i = 0; i < models.size(); i++) { indirectShaders.precompile(models[i]->getFeatureMasks()); }
+		if(skinnedItems.size()) { LOG_INFO(RENDER, "GPU-driven: {} skinned draw items are drawn from command buffers", skinnedItems.size()); }
+	}
+
+	//clustered forward lighting (CPU path only: indirect.vs has no CLUSTERED_LIGHTING), e.g.) CLUSTERED_LIGHTS=1024 ./basic_OpenGL
+	//the lit variants need a perspective camera; without them there is no camera and the meshes are drawn in clip space
+	ClusteredLighting lighting(16, 16, 24);
+	std::vector<Light> lights;
+	std::vector<ShaderProgram*> litShaders;
+	const int lightUnit = 8; //texture units after the mesh textures
+	glm::mat4 view(1.0f), projection(1.0f);
+	if(getenv("CLUSTERED_LIGHTS") && !gpuScene.isBuilt())
+	{
+		//aspect 1: the image stretches with the window, as the clip-space scene does, so the clusters never change
+		const float fovY = glm::radians(45.0f), zNear = 0.1f, zFar = 100.0f;
+		view = glm::lookAt(glm::vec3(0.0f, 0.0f, 2.5f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		projection = glm::perspective(fovY, 1.0f, zNear, zFar);
+		lighting.setProjection(fovY, 1.0f, zNear, zFar);
+
+		//random point lights around the models
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		lights.resize(strtoul(getenv("CLUSTERED_LIGHTS"), nullptr, 10));
+		for(size_t i = 0; i < lights.size(); i++)
+		{
+			Light& light = lights[i];
+			light.type = Light::POINT;
+			light.position = glm::vec3(unit(rng), unit(rng), unit(rng)) * 2.0f - glm::vec3(1.0f);
+			light.radius = 0.2f + 0.3f * unit(rng);
+			light.color = glm::vec3(unit(rng), unit(rng), unit(rng));
+			light.intensity = 1.0f;
+			light.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+			light.spotCosOuter = light.spotCosInner = 0.0f;
+		}
+
+		//every draw item uses a lit variant; the programs get the light buffers once per frame
+		const uint32_t lit = 1u << ShaderVariants::CLUSTERED_LIGHTING;
+		graph.setFeatures(lit);
+		for(size_t i = 0; i < models.size(); i++)
+		{
+			std::vector<uint32_t> masks = models[i]->getFeatureMasks();
+			for(size_t j = 0; j < masks.size(); j++)
+			{
+				ShaderProgram* shader = &meshShaders.get(masks[j] | lit);
+				if(std::find(litShaders.begin(), litShaders.end(), shader) == litShaders.end()) { litShaders.push_back(shader); }
+			}
+		}
+	}
+	const glm::mat4 viewProj = projection * view;
+
+	//CPU path: record objects on worker threads, one command buffer per slice of objects
+	//frame N+1 is recorded while this thread submits frame N
+	//not started on the GPU-driven path: the record function would touch the graph and the culler from a worker
+	const size_t numSlices = JobSystem::instance().getNumWorkers() + 1;
+	FramePipeline pipeline;
+	FramePipeline::RecordFunction recordFrame = [&](RenderFrame& frame)
+	{
+		//per-object logic goes here (graph.setLocal() for moving objects)
+		graph.update();
+
+		culler.beginFrame(viewProj);
+		for(size_t i = 0; i < models.size(); i++) { models[i]->addOccluders(culler, identity); }
+		culler.rasterize();
+
+		size_t numItems = graph.getNumDrawItems();
+		size_t grain = std::max<size_t>(1, (numItems + numSlices - 1) / numSlices);
+		JobSystem::instance().parallelFor(numItems, grain, [&](size_t begin, size_t end)
+		{
+			graph.record(frame.buffers[begin / grain], meshShaders, culler, begin, end);
+		});
+
+		if(frame.frameIndex % 600 == 0)
+		{
+			OcclusionCuller::Stats stats = culler.getStats();
+			LOG_INFO(RENDER, "occlusion culling: {} occluder triangles, {}/{} meshes culled ({} offscreen), {:.3f} ms",
+				stats.numOccluderTriangles, stats.numCulled, stats.numTested, stats.numOffscreen, stats.rasterMs);
+		}
+	};
+	if(!gpuScene.isBuilt()) { pipeline.start(numSlices, recordFrame); }
+
+	//GPU particles (transform feedback), simulated and drawn without per-particle CPU work, e.g.) PARTICLES=1000000 ./basic_OpenGL
+	ParticleSystem particles;
+	if(getenv("PARTICLES"))
+	{
+		particles.init(strtoul(getenv("PARTICLES"), nullptr, 10), "../../shader/particle_sim.vs", "../../shader/particle.vs", "../../shader/particle.fs");
+		particles.setGravity(glm::vec3(0.0f, -1.0f, 0.0f));
+		particles.setSize(0.01f, 0.004f);
+	}
+
+	//GL call log per frame, e.g.) GL_TRACE=gl_trace.log ./BasicOpenGL
+	if(getenv("GL_TRACE")) { GLState::instance().setTracing(true, getenv("GL_TRACE")); }
+
+	//frame graph: the scene is rendered into transient targets, then copied to the window
+	//declared again when the window size changes (the old targets are released by the next compile())
+	FrameGraph frameGraph;
+	int frameWidth = 0, frameHeight = 0;
+	auto declareFrameGraph = [&](int width, int height)
+	{
+		frameGraph.reset();
+		int backbuffer = frameGraph.importTexture("backbuffer", 0, FrameGraph::TextureDesc(width, height, GL_RGBA8));
+		int sceneColor = frameGraph.createTexture("sceneColor", FrameGraph::TextureDesc(width, height, GL_RGBA8));
+		int sceneDepth = frameGraph.createTexture("sceneDepth", FrameGraph::TextureDesc(width, height, GL_DEPTH_COMPONENT24));
+
+		int scene = frameGraph.addPass("scene", [&](const FrameGraph&)
+		{
+			//transient targets are undefined until cleared
+			glClearColor(0.25f, 0.25f, 0.25, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			if(gpuScene.isBuilt())
+			{
+				//no pipeline on this path: the culler is rasterized here, the GPU tests against its depth pyramid
+				culler.beginFrame(identity);
+				for(size_t i = 0; i < models.size(); i++) { models[i]->addOccluders(culler, identity); }
+				culler.rasterize();
+				gpuScene.cull(identity, glm::vec3(0.0f), &culler);
+				gpuScene.draw(indirectShaders);
+
+				skinnedCommands.clear();
+				for(size_t i = 0; i < skinnedItems.size(); i++) { graph.record(skinnedCommands, meshShaders, culler, skinnedItems[i], skinnedItems[i] + 1); }
+				skinnedCommands.execute();
+			}
+			else { pipeline.submitFrame(); }
+
+			//the camera of the meshes (identity: clip space)
+			if(particles.getCapacity()) { particles.draw(view, projection); }
+		});
+		frameGraph.write(scene, sceneColor);
+		frameGraph.write(scene, sceneDepth);
+
+		int present = frameGraph.addPass("present", [scene, width, height](const FrameGraph& fg)
+		{
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, fg.getFramebuffer(scene));
+			glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		});
+		frameGraph.read(present, sceneColor, FrameGraph::TRANSFER);
+		frameGraph.write(present, backbuffer);
+
+		frameGraph.compile();
+		LOG_DEBUG(RENDER, "{}", frameGraph.dumpLifetimes());
+	};
 
 	//render loop
 	//glEnable(GL_DEPTH_TEST);
+	uint64_t frameCounter = 0;
 	while (!glfwWindowShouldClose(win))
 	{
 		//input
 
-		//render background
-		glClearColor(0.25f, 0.25f, 0.25, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
+		//window size
+		int width, height;
+		glfwGetFramebufferSize(win, &width, &height);
+		if(width != frameWidth || height != frameHeight)
+		{
+			frameWidth = width;
+			frameHeight = height;
+			if(width > 0 && height > 0) { declareFrameGraph(width, height); }
+		}
+
+		//animate (palettes of frame N are bound before frame N is submitted)
+		if(animators.size())
+		{
+			AnimationSystem::update(animators, 1.0f / 60.0f);
+			skinning.upload(animators);
+			skinning.bind(0);
+		}
+
+		//particles: a fountain whose spawns refill the ring every 2 seconds (lifetimes up to 2 seconds)
+		if(particles.getCapacity())
+		{
+			particles.emit(glm::vec3(0.0f, -0.8f, 0.0f), glm::vec3(0.0f, 1.6f, 0.0f), 0.4f, 0.02f, particles.getCapacity() / 120, 1.5f, 2.0f);
+			particles.update(1.0f / 60.0f);
+		}
+
+		//clustered lighting: the lights orbit the y axis, are assigned to clusters and uploaded before the frame is replayed
+		if(litShaders.size() && frameWidth > 0 && frameHeight > 0)
+		{
+			glm::mat4 orbit = glm::rotate(identity, 0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
+			for(size_t i = 0; i < lights.size(); i++) { lights[i].position = glm::vec3(orbit * glm::vec4(lights[i].position, 1.0f)); }
+			lighting.update(lights, view);
+			lighting.upload();
+			for(size_t i = 0; i < litShaders.size(); i++)
+			{
+				litShaders[i]->use();
+				litShaders[i]->setMat4("view", view);
+				litShaders[i]->setMat4("projection", projection);
+				lighting.bind(*litShaders[i], lightUnit, frameWidth, frameHeight);
+			}
+		}
 
-		//render objects
-		sp1.use();
-		m1.draw(sp1);
+		//render objects (the pipeline begins the residency frame itself, between recording and replay)
+		if(!pipeline.isStarted()) { ResidencyManager::instance().beginFrame(); }
+		if(frameWidth > 0 && frameHeight > 0) { frameGraph.execute(); }
+		if(gpuScene.isBuilt())
+		{
+			if(frameCounter % 600 == 0)
+			{
+				gpuScene.readNumVisible();
+				const GpuScene::Stats& stats = gpuScene.getStats();
+				LOG_INFO(RENDER, "GPU-driven: {}/{} instances visible, {} multi-draws, CPU {:.3f} ms cull + {:.3f} ms draw",
+					stats.numVisible, stats.numInstances, stats.numBatches, stats.cullMs, stats.drawMs);
+			}
+		}
+		if(litShaders.size() && frameCounter % 600 == 0)
+		{
+			ClusteredLighting::Stats stats = lighting.getStats();
+			LOG_INFO(RENDER, "clustered lighting: {} lights in {} clusters, {} light indices (at most {} per cluster), {:.3f} ms assigning",
+				stats.numLights, lighting.getNumClusters(), stats.numLightIndices, stats.maxLightsPerCluster, stats.assignMs);
+		}
+		if(particles.getCapacity() && particles.getStats().numFrames % 600 == 0)
+		{
+			const ParticleSystem::Stats& stats = particles.getStats();
+			LOG_INFO(RENDER, "particles: {} simulated in {:.3f} ms on the GPU ({:.0f} particles/ms), {} spawned, CPU {:.3f} ms",
+				stats.capacity, stats.gpuMs, stats.particlesPerMs, stats.numSpawned, stats.cpuMs);
+		}
+		if(frameCounter % 600 == 0)
+		{
+			ResidencyManager::Stats stats = ResidencyManager::instance().getStats();
+			LOG_INFO(ASSET, "residency: {}/{} MB in {} resources, {} evictions, {} demotions, {} reloads, {} reload stalls, {:.3f} ms reloading",
+				stats.residentBytes >> 20, stats.budgetBytes >> 20, stats.numResources, stats.numEvictions, stats.numDemotions,
+				stats.numReloads, stats.numReloadStalls, stats.reloadMs);
+		}
+		GLState::instance().endFrame();
+		if(frameCounter % 600 == 0)
+		{
+			const GLState::Stats& stats = GLState::instance().getFrameStats();
+			LOG_INFO(GL, "GL state: {} programs, {} VAOs, {} textures, {} buffers bound ({} redundant binds skipped)",
+				stats.numCalls[GLState::USE_PROGRAM], stats.numCalls[GLState::BIND_VERTEX_ARRAY], stats.numCalls[GLState::BIND_TEXTURE],
+				stats.numCalls[GLState::BIND_BUFFER] + stats.numCalls[GLState::BIND_BUFFER_RANGE],
+				stats.numSkipped[GLState::USE_PROGRAM] + stats.numSkipped[GLState::BIND_VERTEX_ARRAY] + stats.numSkipped[GLState::BIND_TEXTURE]
+				+ stats.numSkipped[GLState::BIND_BUFFER] + stats.numSkipped[GLState::BIND_BUFFER_RANGE]);
+		}
 
 		//double buffering
 		glfwSwapBuffers(win);
 		glfwPollEvents();
+		frameCounter++;
 	}
 
+	pipeline.stop();
 	glfwTerminate();
 	return 0;
 }
@@ -0,0 +1,196 @@
+#include <FileSystem.hpp>
+
+#ifdef ENGINE_LZ4
+#include <lz4hc.h>
+#endif
+
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+//asset packer: bundles models, textures and shader sources into one pack for FileSystem::mount()
+//e.g.) ./basic_OpenGL_pack -z assets.pak ../.. shader resource
+//
+//usage: basic_OpenGL_pack [-z] [-a alignment] <pack file> <root directory> [files or directories under the root ...]
+//-z: LZ4 (high compression) per entry, kept only where it saves at least 1/8 (ENGINE_LZ4 builds)
+//-a: alignment of every entry, a power of two (default 64, 4096 for page-aligned entries)
+//
+//entries are stored in the order given (directories sorted), so list them in load order:
+//a cold start then touches the pack front to back and the page faults stay sequential
+//paths in the pack are relative to the root directory, e.g.) ../../shader/mesh.vs -> shader/mesh.vs
+
+namespace fs = std::filesystem;
+
+struct PackInput
+{
+	std::string path; //normalized, relative to the root
+	fs::path filePath;
+};
+
+static void collect(const fs::path& root, const fs::path& filePath, const fs::path& packPath, std::vector<PackInput>& inputs)
+{
+	std::error_code error;
+	if(fs::is_directory(filePath))
+	{
+		std::vector<fs::path> children;
+		for(fs::recursive_directory_iterator it(filePath, error), end; !error && it != end; it.increment(error))
+		{
+			if(it->is_regular_file(error)) { children.push_back(it->path()); }
+		}
+		std::sort(children.begin(), children.end());
+		for(size_t i = 0; i < children.size(); i++) { collect(root, children[i], packPath, inputs); }
+		return;
+	}
+
+	//not the pack being written
+	if(fs::exists(packPath, error) && fs::equivalent(filePath, packPath, error)) { return; }
+
+	//checked before normalizePath(), which drops leading ".."
+	fs::path relative = fs::relative(filePath, root, error);
+	if(error || relative.empty() || *relative.begin() == "..")
+	{
+		LOG_WARN(ASSET, "skip \"{}\": not under the root directory", filePath.string());
+		return;
+	}
+
+	PackInput input;
+	input.path = FileSystem::normalizePath(relative.generic_string().c_str());
+	input.filePath = filePath;
+	if(input.path.empty()) { LOG_WARN(ASSET, "skip \"{}\": not under the root directory", filePath.string()); return; }
+	inputs.push_back(input);
+}
+
+static bool readFile(const fs::path& filePath, std::vector<char>& data)
+{
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	if(!file.is_open()) { return false; }
+	data.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	return file.read(data.data(), data.size()) || data.empty();
+}
+
+static void pad(std::ofstream& packFile, uint64_t& offset, uint64_t alignment)
+{
+	static const char zeros[4096] = {};
+	uint64_t padding = (alignment - offset % alignment) % alignment;
+	packFile.write(zeros, padding);
+	offset += padding;
+}
+
+int main(int argc, char** argv)
+{
+	Log::setLevels(getenv("LOG_LEVELS"));
+
+	//options
+	bool compress = false;
+	uint64_t alignment = FileSystem::DEFAULT_ALIGNMENT;
+	int arg = 1;
+	for(; arg < argc && argv[arg][0] == '-'; arg++)
+	{
+		if(!strcmp(argv[arg], "-z")) { compress = true; }
+		else if(!strcmp(argv[arg], "-a") && arg + 1 < argc) { alignment = strtoull(argv[++arg], nullptr, 10); }
+		else { arg = argc; }
+	}
+	if(argc - arg < 2 || !alignment || alignment > 4096 || (alignment & (alignment - 1)))
+	{
+		LOG_ERROR(CORE, "usage: {} [-z] [-a alignment] <pack file> <root directory> [files or directories under the root ...]", argv[0]);
+		return -1;
+	}
+#ifndef ENGINE_LZ4
+	if(compress) { LOG_WARN(CORE, "-z ignored: built without ENGINE_LZ4"); compress = false; }
+#endif
+	fs::path packPath = argv[arg];
+	fs::path root = argv[arg + 1];
+
+	//inputs, in pack order
+	std::vector<PackInput> inputs;
+	if(argc - arg == 2) { collect(root, root, packPath, inputs); }
+	for(int i = arg + 2; i < argc; i++)
+	{
+		fs::path filePath = root / argv[i];
+		if(!fs::exists(filePath)) { LOG_ERROR(ASSET, "no such file \"{}\"", filePath.string()); return -1; }
+		collect(root, filePath, packPath, inputs);
+	}
+	if(inputs.empty()) { LOG_ERROR(ASSET, "nothing to pack under \"{}\"", root.string()); return -1; }
+
+	std::ofstream packFile(packPath, std::ios::binary | std::ios::trunc);
+	if(!packFile.is_open()) { LOG_ERROR(ASSET, "failed to create \"{}\"", packPath.string()); return -1; }
+
+	//header last, once the offsets are known
+	FileSystem::PackHeader header;
+	memset(&header, 0, sizeof(FileSystem::PackHeader)); //nullify
+	packFile.write(reinterpret_cast<const char*>(&header), sizeof(FileSystem::PackHeader));
+	uint64_t offset = sizeof(FileSystem::PackHeader);
+
+	std::vector<FileSystem::PackEntry> entries;
+	std::unordered_map<std::string, size_t> paths;
+	std::string strings;
+	std::vector<char> data, compressed;
+	size_t totalBytes = 0, numCompressed = 0;
+	for(size_t i = 0; i < inputs.size(); i++)
+	{
+		if(paths.count(inputs[i].path)) { LOG_WARN(ASSET, "skip \"{}\": listed twice", inputs[i].path); continue; }
+		if(!readFile(inputs[i].filePath, data)) { LOG_ERROR(ASSET, "failed to read \"{}\"", inputs[i].filePath.string()); return -1; }
+		paths[inputs[i].path] = entries.size();
+
+		FileSystem::PackEntry entry;
+		memset(&entry, 0, sizeof(FileSystem::PackEntry)); //nullify
+		entry.hash = FileSystem::hashPath(inputs[i].path);
+		entry.size = data.size();
+		entry.storedSize = data.size();
+		entry.pathOffset = static_cast<uint32_t>(strings.size());
+		entry.pathLength = static_cast<uint32_t>(inputs[i].path.size());
+		entry.compression = FileSystem::NONE;
+		strings += inputs[i].path;
+
+		const char* stored = data.data();
+#ifdef ENGINE_LZ4
+		//already compressed formats (png, jpg) rarely shrink: stored as they are
+		if(compress && data.size() >= 64 && data.size() < 0x7E000000)
+		{
+			compressed.resize(LZ4_compressBound(static_cast<int>(data.size())));
+			int size = LZ4_compress_HC(data.data(), compressed.data(), static_cast<int>(data.size()), static_cast<int>(compressed.size()), LZ4HC_CLEVEL_MAX);
+			if(size > 0 && static_cast<size_t>(size) <= data.size() - data.size() / 8)
+			{
+				entry.storedSize = static_cast<uint64_t>(size);
+				entry.compression = FileSystem::LZ4;
+				stored = compressed.data();
+				numCompressed++;
+			}
+		}
+#endif
+
+		pad(packFile, offset, alignment);
+		entry.offset = offset;
+		packFile.write(stored, entry.storedSize);
+		offset += entry.storedSize;
+		totalBytes += data.size();
+		entries.push_back(entry);
+		LOG_DEBUG(ASSET, "{} {} -> {} bytes at {}", inputs[i].path, entry.size, entry.storedSize, entry.offset);
+	}
+
+	//table sorted by hash for the binary search in FileSystem::find(), then the paths
+	std::stable_sort(entries.begin(), entries.end(),
+		[](const FileSystem::PackEntry& a, const FileSystem::PackEntry& b) { return a.hash < b.hash; });
+	pad(packFile, offset, alignof(FileSystem::PackEntry));
+	header.tocOffset = offset;
+	packFile.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(FileSystem::PackEntry));
+	offset += entries.size() * sizeof(FileSystem::PackEntry);
+	header.stringsOffset = offset;
+	header.stringsSize = strings.size();
+	packFile.write(strings.data(), strings.size());
+	offset += strings.size();
+
+	memcpy(header.magic, "BOGLPAK1", 8);
+	header.version = FileSystem::VERSION;
+	header.alignment = static_cast<uint32_t>(alignment);
+	header.numEntries = static_cast<uint32_t>(entries.size());
+	packFile.seekp(0);
+	packFile.write(reinterpret_cast<const char*>(&header), sizeof(FileSystem::PackHeader));
+	packFile.close();
+	if(!packFile) { LOG_ERROR(ASSET, "failed to write \"{}\"", packPath.string()); return -1; }
+
+	LOG_INFO(ASSET, "packed {} files ({} LZ4) into \"{}\": {:.2f} MB -> {:.2f} MB", entries.size(), numCompressed, packPath.string(),
+		totalBytes / 1048576.0, offset / 1048576.0);
+	return 0;
+}
@@ -0,0 +1,51 @@
+#include <OcclusionCuller.hpp>
+#include <Log.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+//OcclusionCuller is CPU-only: no window or GL context needed
+//camera at the origin looking down -z, one 4x4 occluder quad at z = -5
+
+struct Box
+{
+	const char* name;
+	glm::vec3 boundsMin, boundsMax;
+	bool visible; //expected
+};
+
+int main()
+{
+	Log::setLevels(getenv("LOG_LEVELS"));
+
+	const glm::vec3 quad[4] = { glm::vec3(-2.0f, -2.0f, -5.0f), glm::vec3(2.0f, -2.0f, -5.0f), glm::vec3(2.0f, 2.0f, -5.0f), glm::vec3(-2.0f, 2.0f, -5.0f) };
+	const unsigned int indices[6] = { 0, 1, 2, 0, 2, 3 };
+	const Box boxes[] =
+	{
+		{ "behind", glm::vec3(-0.5f, -0.5f, -11.0f), glm::vec3(0.5f, 0.5f, -10.0f), false },
+		{ "beside", glm::vec3(6.0f, -0.5f, -11.0f), glm::vec3(7.0f, 0.5f, -10.0f), true },
+		{ "in front", glm::vec3(-0.5f, -0.5f, -3.0f), glm::vec3(0.5f, 0.5f, -2.0f), true },
+		{ "partly behind", glm::vec3(3.0f, -0.5f, -11.0f), glm::vec3(6.0f, 0.5f, -10.0f), true },
+	};
+	glm::mat4 identity(1.0f);
+	int numFailed = 0;
+
+	OcclusionCuller culler(256, 128);
+	culler.beginFrame(glm::perspective(glm::radians(45.0f), 2.0f, 0.1f, 100.0f));
+	culler.addOccluder(quad, 4, indices, 6, identity);
+	culler.rasterize();
+
+	for(const Box& box : boxes)
+	{
+		bool visible = culler.isVisible(box.boundsMin, box.boundsMax, identity);
+		if(visible != box.visible)
+		{
+			LOG_ERROR(RENDER, "box {}: isVisible() = {}, expected {}", box.name, visible, box.visible);
+			numFailed++;
+		}
+	}
+
+	OcclusionCuller::Stats stats = culler.getStats();
+	LOG_INFO(RENDER, "occlusion test: {} occluder triangles, {}/{} boxes culled, {} failed", stats.numOccluderTriangles,
+		stats.numCulled, stats.numTested, numFailed);
+	return numFailed ? 1 : 0;
+}
@@ -5,6 +5,11 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+//engine library (BasicOpenGL)
+#include <Log.hpp>
+
+#include <cstdlib>
+
 //target_compile_definitions()
 //VSCode: If "identifier "..." is undefined" error occurred, restart VSCode!
 //#define WINDOW_NAME "HelloOpenGL (with CMake)"
@@ -15,6 +20,7 @@ void framebuffersize_callback(GLFWwindow*, int, int);
 
 int main()
 {
+	Log::setLevels(getenv("LOG_LEVELS")); //SPDLOG_INFO() goes to the engine's asynchronous "core" logger
 	SPDLOG_INFO("main()");
 
 	SPDLOG_INFO("glfwInit()");